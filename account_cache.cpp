@@ -0,0 +1,97 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "account_cache.h"
+#include "account_store.h"
+#include <string.h>
+
+/**
+ * @brief Computes the memory needed for an account cache.
+ *
+ * @param capacity Number of entries (already a power of two).
+ * @return Size in bytes of the cache header and its entries.
+ */
+size_t accountCacheSize(uint64_t capacity) {
+    return sizeof(AccountCache) + capacity * sizeof(CacheEntry);
+}
+
+/**
+ * @brief Initializes an empty account cache.
+ *
+ * @param cache Pointer to the cache, followed by accountCacheSize(capacity) bytes of shared memory.
+ * @param capacity Number of entries (power of two).
+ * @param flushThreshold Dirty entries that trigger a write-back batch.
+ */
+void initializeAccountCache(AccountCache *cache, uint64_t capacity, long flushThreshold) {
+    memset(cache, 0, accountCacheSize(capacity));
+    cache->capacity = capacity;
+    cache->flush_threshold = flushThreshold;
+}
+
+/**
+ * @brief Looks up an account's cache entry.
+ *
+ * @param cache Pointer to the cache.
+ * @param accountId The account ID as a string.
+ * @return The entry, or NULL if the account is not cached.
+ */
+CacheEntry *cacheFindEntry(AccountCache *cache, const char *accountId) {
+    uint64_t hash = hashAccountId(accountId);
+    uint64_t mask = cache->capacity - 1;
+
+    for (uint64_t i = 0; i <= mask; i++) {
+        CacheEntry *entry = &(cache->entries[(hash + i) & mask]);
+        uint32_t state = __atomic_load_n(&(entry->state), __ATOMIC_ACQUIRE);
+        if (state == CACHE_EMPTY) {
+            return NULL;
+        }
+        if (state != CACHE_BUSY && entry->hash == (uint32_t)hash &&
+            strncmp(entry->id, accountId, ACCOUNT_ID_LENGTH) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Adds an account to the cache.
+ *
+ * The caller must hold the account's lock stripe, so the same account is
+ * never added twice concurrently. The table is only filled to three
+ * quarters so probes stay short; once it is that full, accounts are not
+ * cached and go straight to their files.
+ *
+ * @param cache Pointer to the cache.
+ * @param accountId The account ID as a string.
+ * @param state CACHE_CLEAN, CACHE_DIRTY or CACHE_ABSENT.
+ * @param balance The account's balance.
+ * @return The new entry, or NULL if the cache is full.
+ */
+CacheEntry *cacheAddEntry(AccountCache *cache, const char *accountId, uint32_t state, Money balance) {
+    if (__atomic_add_fetch(&(cache->used), 1, __ATOMIC_RELAXED) > cache->capacity / 4 * 3) {
+        __atomic_sub_fetch(&(cache->used), 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    uint64_t hash = hashAccountId(accountId);
+    uint64_t mask = cache->capacity - 1;
+
+    for (uint64_t i = 0; i <= mask; i++) {
+        CacheEntry *entry = &(cache->entries[(hash + i) & mask]);
+        uint32_t expected = CACHE_EMPTY;
+        if (!__atomic_compare_exchange_n(&(entry->state), &expected, (uint32_t)CACHE_BUSY, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            continue; // In use, or claimed by another process first
+        }
+
+        strncpy(entry->id, accountId, ACCOUNT_ID_LENGTH - 1);
+        entry->id[ACCOUNT_ID_LENGTH - 1] = '\0';
+        entry->hash = (uint32_t)hash;
+        entry->balance = balance;
+        __atomic_store_n(&(entry->state), state, __ATOMIC_RELEASE);
+        return entry;
+    }
+    return NULL;
+}
@@ -0,0 +1,53 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef ACCOUNT_CACHE_H
+#define ACCOUNT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sharedmemory.h"
+
+#define DEFAULT_CACHE_CAPACITY 65536  // Entries in the account cache (rounded up to a power of two)
+#define DEFAULT_CACHE_FLUSH 1024      // Dirty entries that trigger a write-back batch
+
+// Cache entry states
+enum CacheEntryState {
+    CACHE_EMPTY = 0,   // Never used
+    CACHE_BUSY = 1,    // Being filled in by the process that claimed it
+    CACHE_CLEAN = 2,   // Balance matches the account file
+    CACHE_DIRTY = 3,   // Balance is newer than the account file
+    CACHE_ABSENT = 4   // Known to have no account file
+};
+
+// Cached state of one account. Entries are never freed; an entry's balance
+// and state only change while the account's lock stripe is held.
+struct CacheEntry {
+    Money balance;
+    uint32_t state;    // CacheEntryState, updated atomically
+    uint32_t hash;     // Low bits of the id hash, checked before comparing ids
+    char id[ACCOUNT_ID_LENGTH];
+};
+
+// Account cache in memory shared by every process (entries follow the header)
+struct AccountCache {
+    uint64_t capacity;      // Number of entries (power of two)
+    uint64_t used;          // Entries claimed so far (atomic)
+    long flush_threshold;   // Dirty entries that trigger a write-back batch
+    long dirty;             // Entries currently dirty (atomic)
+    int flushing;           // Set while a process is writing dirty entries back (atomic)
+    long hits;              // Lookups answered from the cache (atomic)
+    long misses;            // Lookups that had to read the account file (atomic)
+    long writebacks;        // Account files written by write-back (atomic)
+    long batches;           // Write-back batches run (atomic)
+    CacheEntry entries[];
+};
+
+size_t accountCacheSize(uint64_t capacity);
+void initializeAccountCache(AccountCache *cache, uint64_t capacity, long flushThreshold);
+CacheEntry *cacheFindEntry(AccountCache *cache, const char *accountId);
+CacheEntry *cacheAddEntry(AccountCache *cache, const char *accountId, uint32_t state, Money balance);
+
+#endif // ACCOUNT_CACHE_H
@@ -0,0 +1,124 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "account_combiner.h"
+#include "account_store.h"
+#include <string.h>
+
+/**
+ * @brief Prepares a combiner with no hot accounts.
+ *
+ * @param combiner Pointer to the combiner, which must live in shared memory.
+ * @param detect Whether contended accounts are promoted automatically.
+ * @param promoteAfter Contended updates that promote an account.
+ */
+void initializeAccountCombiner(AccountCombiner *combiner, bool detect, long promoteAfter) {
+    memset(combiner, 0, sizeof(AccountCombiner));
+    combiner->detect = detect;
+    combiner->promote_after = promoteAfter;
+}
+
+/**
+ * @brief Looks up a hot account.
+ *
+ * @param combiner Pointer to the combiner.
+ * @param accountId The account ID as a string.
+ * @return The account's slot, or NULL if it is not hot.
+ */
+HotAccount *findHotAccount(AccountCombiner *combiner, const char *accountId) {
+    int hot = __atomic_load_n(&(combiner->hot), __ATOMIC_ACQUIRE);
+    if (hot == 0) {
+        return NULL;
+    }
+    uint32_t hash = (uint32_t)hashAccountId(accountId);
+    for (int i = 0; i < hot && i < HOT_ACCOUNT_SLOTS; i++) {
+        HotAccount *account = &(combiner->accounts[i]);
+        if (__atomic_load_n(&(account->state), __ATOMIC_ACQUIRE) == HOT_READY && account->hash == hash &&
+            strncmp(account->id, accountId, ACCOUNT_ID_LENGTH) == 0) {
+            return account;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Makes an account hot; it stays hot for the rest of the run.
+ *
+ * Slots are filled in order, so findHotAccount only looks at the first
+ * combiner->hot of them.
+ *
+ * @param combiner Pointer to the combiner.
+ * @param accountId The account ID as a string.
+ * @param stripe The account's lock stripe.
+ * @return The account's slot, or NULL if every slot is taken or another process is promoting.
+ */
+HotAccount *promoteHotAccount(AccountCombiner *combiner, const char *accountId, int stripe) {
+    int expected = 0;
+    if (!__atomic_compare_exchange_n(&(combiner->promoting), &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+    HotAccount *account = findHotAccount(combiner, accountId);
+    int hot = combiner->hot;
+    if (account == NULL && hot < HOT_ACCOUNT_SLOTS) {
+        account = &(combiner->accounts[hot]);
+        strncpy(account->id, accountId, ACCOUNT_ID_LENGTH - 1);
+        account->id[ACCOUNT_ID_LENGTH - 1] = '\0';
+        account->hash = (uint32_t)hashAccountId(accountId);
+        account->stripe = stripe;
+        __atomic_store_n(&(account->state), (uint32_t)HOT_READY, __ATOMIC_RELEASE);
+        __atomic_store_n(&(combiner->hot), hot + 1, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&(combiner->promoting), 0, __ATOMIC_RELEASE);
+    return account;
+}
+
+/**
+ * @brief Counts a contended update of an account for hot-account detection.
+ *
+ * Counts are approximate: accounts that share a candidate slot replace
+ * each other's count.
+ *
+ * @param combiner Pointer to the combiner.
+ * @param accountId The account ID as a string.
+ * @return true once the account has had enough contended updates to be promoted.
+ */
+bool noteContendedUpdate(AccountCombiner *combiner, const char *accountId) {
+    uint64_t hash = hashAccountId(accountId);
+    HotCandidate *candidate = &(combiner->candidates[hash % HOT_CANDIDATES]);
+    if (__atomic_load_n(&(candidate->hash), __ATOMIC_RELAXED) != hash) {
+        __atomic_store_n(&(candidate->hash), hash, __ATOMIC_RELAXED);
+        __atomic_store_n(&(candidate->contended), 1, __ATOMIC_RELAXED);
+        return combiner->promote_after <= 1;
+    }
+    return __atomic_add_fetch(&(candidate->contended), 1, __ATOMIC_RELAXED) >= combiner->promote_after;
+}
+
+/**
+ * @brief Reserves a request slot of a hot account for one delta.
+ *
+ * @param account The hot account.
+ * @return The slot (COMBINE_CLAIMED), or NULL if every slot is in use.
+ */
+CombineRequest *claimCombineRequest(HotAccount *account) {
+    for (int i = 0; i < COMBINE_REQUESTS; i++) {
+        CombineRequest *request = &(account->requests[i]);
+        uint32_t expected = COMBINE_FREE;
+        if (__atomic_load_n(&(request->state), __ATOMIC_RELAXED) == COMBINE_FREE &&
+            __atomic_compare_exchange_n(&(request->state), &expected, (uint32_t)COMBINE_CLAIMED, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return request;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Frees a request slot once its submitter has recorded the outcome.
+ *
+ * @param request A request returned by claimCombineRequest.
+ */
+void releaseCombineRequest(CombineRequest *request) {
+    __atomic_store_n(&(request->state), (uint32_t)COMBINE_FREE, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,77 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef ACCOUNT_COMBINER_H
+#define ACCOUNT_COMBINER_H
+
+#include <stdint.h>
+#include "sharedmemory.h"
+
+#define HOT_ACCOUNT_SLOTS 16      // Accounts whose deposits and incoming credits can be combined
+#define COMBINE_REQUESTS 64       // Deltas a hot account can have pending at once
+#define HOT_CANDIDATES 256        // Accounts hot-account detection keeps count of (direct-mapped)
+#define HOT_LANE_DEPTH 2          // Tickets queued on an account's lane that make an update count as contended
+#define DEFAULT_HOT_PROMOTE 8     // Contended updates after which an account is promoted
+#define COMBINE_WINDOW_YIELDS 16  // Yields a submitter gives the submitters queued behind it before combining
+
+// Delta request states
+enum CombineRequestState {
+    COMBINE_FREE = 0,
+    COMBINE_CLAIMED = 1,   // Reserved by a submitter that has not published it yet
+    COMBINE_PENDING = 2,   // Published, waiting for a combiner
+    COMBINE_DONE = 3       // Applied (or rejected); the submitter reads the result and frees it
+};
+
+// Hot account slot states
+enum HotAccountState {
+    HOT_EMPTY = 0,
+    HOT_READY = 1
+};
+
+// One submitter's update of a hot account
+struct CombineRequest {
+    uint32_t state;              // CombineRequestState (atomic)
+    TransactionReason reason;    // Outcome, set before COMBINE_DONE
+    Money amount;                // Delta to add
+    Money balance;               // The account's balance right after this delta, set before COMBINE_DONE
+    long ticket;                 // Submitter's ticket on the account's lane; deltas apply in ticket order
+    long epoch;                  // Submitter's snapshot epoch, or -1
+};
+
+// An account whose commutative updates are combined, with its pending deltas
+struct HotAccount {
+    uint32_t state;              // HotAccountState (atomic)
+    uint32_t hash;               // Low bits of the id hash, checked before comparing ids
+    int stripe;                  // The account's lock stripe (and lane)
+    char id[ACCOUNT_ID_LENGTH];
+    long combined;               // Deltas applied
+    long writes;                 // Storage writes that applied them
+    CombineRequest requests[COMBINE_REQUESTS];
+};
+
+// Count of contended updates of one account
+struct HotCandidate {
+    uint64_t hash;
+    long contended;
+};
+
+// Hot accounts and their detection, in memory shared by every process
+struct AccountCombiner {
+    bool detect;                 // Promote contended accounts automatically
+    long promote_after;          // Contended updates that promote an account
+    int hot;                     // Accounts promoted so far (atomic)
+    int promoting;               // Spinlock serializing promotions (atomic)
+    HotAccount accounts[HOT_ACCOUNT_SLOTS];
+    HotCandidate candidates[HOT_CANDIDATES];
+};
+
+void initializeAccountCombiner(AccountCombiner *combiner, bool detect, long promoteAfter);
+HotAccount *findHotAccount(AccountCombiner *combiner, const char *accountId);
+HotAccount *promoteHotAccount(AccountCombiner *combiner, const char *accountId, int stripe);
+bool noteContendedUpdate(AccountCombiner *combiner, const char *accountId);
+CombineRequest *claimCombineRequest(HotAccount *account);
+void releaseCombineRequest(CombineRequest *request);
+
+#endif // ACCOUNT_COMBINER_H
@@ -0,0 +1,255 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "account_directory.h"
+#include "account_store.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Computes the memory needed for an account directory.
+ *
+ * @param filterSize Number of filter counters (already a power of two, or 0).
+ * @return Size in bytes of the directory and its filter.
+ */
+size_t accountDirectorySize(uint64_t filterSize) {
+    return sizeof(AccountDirectory) + filterSize;
+}
+
+/**
+ * @brief Returns the counter index of one of an account's filter hashes.
+ *
+ * The hashes are derived from the account's 64-bit hash by double hashing.
+ */
+static uint64_t filterIndex(const AccountDirectory *directory, uint64_t hash, int i) {
+    uint64_t step = (hash >> 32) | 1;
+    return (hash + i * step) & (directory->filter_size - 1);
+}
+
+/**
+ * @brief Adds one to an account's counters (saturated counters stay at their maximum).
+ */
+static void filterAdd(AccountDirectory *directory, const char *accountId) {
+    uint64_t hash = hashAccountId(accountId);
+    for (int i = 0; i < ACCOUNT_FILTER_HASHES; i++) {
+        uint8_t *counter = &(directory->counters[filterIndex(directory, hash, i)]);
+        uint8_t value = __atomic_load_n(counter, __ATOMIC_RELAXED);
+        while (value != UINT8_MAX &&
+               !__atomic_compare_exchange_n(counter, &value, value + 1, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+/**
+ * @brief Extracts the account ID from an account file name ("<id>.txt").
+ *
+ * @return false if the name is not one of an account file.
+ */
+static bool accountIdFromFileName(const char *name, char *id) {
+    size_t length = strlen(name);
+    if (length <= 4 || length - 4 >= ACCOUNT_ID_LENGTH || strcmp(name + length - 4, ".txt") != 0) {
+        return false;
+    }
+    memcpy(id, name, length - 4);
+    id[length - 4] = '\0';
+    return true;
+}
+
+/**
+ * @brief Adds an account file name ("<id>.txt") found on disk to the filter.
+ */
+static void indexAccountFile(AccountDirectory *directory, const char *name) {
+    char id[ACCOUNT_ID_LENGTH];
+    if (!accountIdFromFileName(name, id)) {
+        return;
+    }
+    filterAdd(directory, id);
+    directory->indexed++;
+}
+
+/**
+ * @brief Adds every account file in a directory to the filter.
+ *
+ * @return 0 on success, or -1 if the directory could not be read.
+ */
+static int indexDirectory(AccountDirectory *directory, const char *path) {
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        printf("Error reading account directory: %s\n", path);
+        return -1;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        indexAccountFile(directory, entry->d_name);
+    }
+    closedir(dir);
+    return 0;
+}
+
+/**
+ * @brief Prepares the account directory: creates the shard directories and fills the filter from disk.
+ *
+ * The filter is built by listing the account files once, so every account
+ * created before this run (and any other "<id>.txt" file, which only costs
+ * a false positive) is marked as possibly present.
+ *
+ * @param directory Pointer to the directory, followed by accountDirectorySize(filterSize) bytes of shared memory.
+ * @param shards Number of shard directories (0 keeps account files in the working directory).
+ * @param filterSize Number of filter counters (power of two), or 0 to always look at the filesystem.
+ * @return 0 on success, or -1 if the directories could not be created or read.
+ */
+int openAccountDirectory(AccountDirectory *directory, int shards, uint64_t filterSize) {
+    memset(directory, 0, accountDirectorySize(filterSize));
+    directory->shards = shards;
+    directory->filter_size = filterSize;
+
+    if (shards > 0 && mkdir(ACCOUNT_ROOT, 0777) == -1 && errno != EEXIST) {
+        printf("Error creating account directory: %s\n", ACCOUNT_ROOT);
+        return -1;
+    }
+    for (int shard = 0; shard < shards; shard++) {
+        char path[ACCOUNT_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%s/%02x", ACCOUNT_ROOT, shard);
+        if (mkdir(path, 0777) == -1 && errno != EEXIST) {
+            printf("Error creating account directory: %s\n", path);
+            return -1;
+        }
+        if (filterSize > 0 && indexDirectory(directory, path) != 0) {
+            return -1;
+        }
+    }
+    if (shards == 0 && filterSize > 0) {
+        return indexDirectory(directory, ".");
+    }
+    return 0;
+}
+
+/**
+ * @brief Builds the path of an account's balance file.
+ *
+ * With shards, the shard is picked by the top bits of the account's hash
+ * (the lock stripes and the cache use the low bits), so accounts spread
+ * evenly and no directory grows past its share.
+ *
+ * @param directory Pointer to the directory, or NULL for "<id>.txt" in the working directory.
+ * @param accountId The account ID as a string.
+ * @param path Receives the path.
+ * @param size Size of the path buffer; ACCOUNT_PATH_LENGTH always suffices.
+ */
+void accountFilePath(const AccountDirectory *directory, const char *accountId, char *path, size_t size) {
+    if (directory == NULL || directory->shards == 0) {
+        snprintf(path, size, "%s.txt", accountId);
+        return;
+    }
+    unsigned shard = (unsigned)(hashAccountId(accountId) >> 56) & (directory->shards - 1);
+    snprintf(path, size, "%s/%02x/%s.txt", ACCOUNT_ROOT, shard, accountId);
+}
+
+/**
+ * @brief Checks whether an account may have a file.
+ *
+ * @param directory Pointer to the directory, or NULL.
+ * @param accountId The account ID as a string.
+ * @return false only if the account certainly has no file.
+ */
+bool directoryMayContain(AccountDirectory *directory, const char *accountId) {
+    if (directory == NULL || directory->filter_size == 0) {
+        return true;
+    }
+    uint64_t hash = hashAccountId(accountId);
+    for (int i = 0; i < ACCOUNT_FILTER_HASHES; i++) {
+        if (__atomic_load_n(&(directory->counters[filterIndex(directory, hash, i)]), __ATOMIC_ACQUIRE) == 0) {
+            __atomic_add_fetch(&(directory->filter_negatives), 1, __ATOMIC_RELAXED);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Records that an account's file is about to be created.
+ *
+ * Called before the file exists, so a lookup can never miss a file that
+ * does; a creation that then fails only leaves a false positive.
+ *
+ * @param directory Pointer to the directory, or NULL.
+ * @param accountId The account ID as a string.
+ */
+void directoryAddAccount(AccountDirectory *directory, const char *accountId) {
+    if (directory != NULL && directory->filter_size > 0) {
+        filterAdd(directory, accountId);
+    }
+}
+
+/**
+ * @brief Records that an account's file was removed.
+ *
+ * @param directory Pointer to the directory, or NULL.
+ * @param accountId The account ID as a string.
+ */
+void directoryRemoveAccount(AccountDirectory *directory, const char *accountId) {
+    if (directory == NULL || directory->filter_size == 0) {
+        return;
+    }
+    uint64_t hash = hashAccountId(accountId);
+    for (int i = 0; i < ACCOUNT_FILTER_HASHES; i++) {
+        uint8_t *counter = &(directory->counters[filterIndex(directory, hash, i)]);
+        uint8_t value = __atomic_load_n(counter, __ATOMIC_RELAXED);
+        // A saturated counter no longer knows how many accounts share it, so it never goes down
+        while (value != 0 && value != UINT8_MAX &&
+               !__atomic_compare_exchange_n(counter, &value, value - 1, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+}
+
+/**
+ * @brief Calls a function with the ID of every "<id>.txt" file in one directory.
+ *
+ * @return 0 on success, or -1 if the directory could not be read.
+ */
+static int listDirectory(const char *path, AccountVisitor visit, void *context) {
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        printf("Error reading account directory: %s\n", path);
+        return -1;
+    }
+    struct dirent *entry;
+    char id[ACCOUNT_ID_LENGTH];
+    while ((entry = readdir(dir)) != NULL) {
+        if (accountIdFromFileName(entry->d_name, id)) {
+            visit(id, context);
+        }
+    }
+    closedir(dir);
+    return 0;
+}
+
+/**
+ * @brief Calls a function with the ID of every account file on disk.
+ *
+ * Every "<id>.txt" file is listed, so in the working directory other text
+ * files are listed too; callers check that the file holds a balance.
+ *
+ * @param directory Pointer to the directory, or NULL for "<id>.txt" in the working directory.
+ * @param visit Called with each account ID.
+ * @param context Passed to visit.
+ * @return 0 on success, or -1 if a directory could not be read.
+ */
+int forEachAccountFile(const AccountDirectory *directory, AccountVisitor visit, void *context) {
+    if (directory == NULL || directory->shards == 0) {
+        return listDirectory(".", visit, context);
+    }
+    for (int shard = 0; shard < directory->shards; shard++) {
+        char path[ACCOUNT_PATH_LENGTH];
+        snprintf(path, sizeof(path), "%s/%02x", ACCOUNT_ROOT, shard);
+        if (listDirectory(path, visit, context) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
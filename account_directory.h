@@ -0,0 +1,40 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef ACCOUNT_DIRECTORY_H
+#define ACCOUNT_DIRECTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sharedmemory.h"
+
+#define ACCOUNT_ROOT "accounts"              // Parent of the shard directories
+#define MAX_ACCOUNT_SHARDS 256
+#define DEFAULT_ACCOUNT_FILTER (1 << 24)     // Counters in the membership filter (rounded up to a power of two)
+#define ACCOUNT_FILTER_HASHES 4              // Counters each account sets
+#define ACCOUNT_PATH_LENGTH 48               // Enough for "accounts/ff/<id>.txt"
+
+// Where account files live and which accounts may exist, in memory shared by
+// every process. The membership filter is a counting Bloom filter: an
+// account none of whose counters is set certainly has no file, so most
+// lookups of missing accounts are answered without touching the filesystem.
+struct AccountDirectory {
+    int shards;               // 0: "<id>.txt" in the working directory; otherwise "accounts/xx/<id>.txt"
+    uint64_t filter_size;     // Number of counters (power of two), 0 if the filter is off
+    long filter_negatives;    // Lookups answered "not found" by the filter (atomic)
+    long filter_false_positives; // Lookups the filter passed that found no file (atomic)
+    long indexed;             // Account files found when the directory was opened
+    uint8_t counters[];       // filter_size saturating counters
+};
+
+size_t accountDirectorySize(uint64_t filterSize);
+int openAccountDirectory(AccountDirectory *directory, int shards, uint64_t filterSize);
+void accountFilePath(const AccountDirectory *directory, const char *accountId, char *path, size_t size);
+bool directoryMayContain(AccountDirectory *directory, const char *accountId);
+void directoryAddAccount(AccountDirectory *directory, const char *accountId);
+void directoryRemoveAccount(AccountDirectory *directory, const char *accountId);
+int forEachAccountFile(const AccountDirectory *directory, AccountVisitor visit, void *context);
+
+#endif // ACCOUNT_DIRECTORY_H
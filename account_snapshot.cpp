@@ -0,0 +1,186 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "account_snapshot.h"
+#include "account_store.h"
+#include <string.h>
+#include <sched.h>
+
+/**
+ * @brief Computes the memory needed for an account snapshot table.
+ *
+ * @param capacity Number of entries (already a power of two).
+ * @return Size in bytes of the header and its entries.
+ */
+size_t accountSnapshotSize(uint64_t capacity) {
+    return sizeof(AccountSnapshot) + capacity * sizeof(SnapshotEntry);
+}
+
+/**
+ * @brief Initializes an idle snapshot table.
+ *
+ * @param snapshot Pointer to the table, followed by accountSnapshotSize(capacity) bytes of shared memory.
+ * @param capacity Number of entries (power of two).
+ */
+void initializeAccountSnapshot(AccountSnapshot *snapshot, uint64_t capacity) {
+    memset(snapshot, 0, accountSnapshotSize(capacity));
+    initializeSharedMutex(&(snapshot->report_mutex));
+    snapshot->capacity = capacity;
+    snapshot->cut = -1;
+}
+
+/**
+ * @brief Admits a writer into the current epoch.
+ *
+ * The epoch is read again after the writer is counted, so a report that
+ * moves to a new epoch in between either sees the count or makes the writer
+ * count itself in the new epoch instead.
+ *
+ * @param snapshot Pointer to the snapshot table.
+ * @return The writer's epoch, to pass to snapshotExitWriter.
+ */
+long snapshotEnterWriter(AccountSnapshot *snapshot) {
+    while (true) {
+        long epoch = __atomic_load_n(&(snapshot->epoch), __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&(snapshot->writers[epoch & 1]), 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&(snapshot->epoch), __ATOMIC_SEQ_CST) == epoch) {
+            return epoch;
+        }
+        __atomic_sub_fetch(&(snapshot->writers[epoch & 1]), 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+/**
+ * @brief Marks a writer admitted by snapshotEnterWriter as finished.
+ */
+void snapshotExitWriter(AccountSnapshot *snapshot, long epoch) {
+    __atomic_sub_fetch(&(snapshot->writers[epoch & 1]), 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Checks whether a writer must save the before-image of an account it is about to change.
+ *
+ * @param snapshot Pointer to the snapshot table.
+ * @param epoch The writer's epoch.
+ * @return true while a report runs whose cut precedes the writer.
+ */
+bool snapshotWantsBeforeImage(AccountSnapshot *snapshot, long epoch) {
+    return __atomic_load_n(&(snapshot->active), __ATOMIC_SEQ_CST) &&
+           epoch > __atomic_load_n(&(snapshot->cut), __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Looks up an account's before-image in the current report.
+ *
+ * @param snapshot Pointer to the snapshot table.
+ * @param accountId The account ID as a string.
+ * @return The entry, or NULL if the account has not changed since the cut.
+ */
+SnapshotEntry *snapshotFindEntry(AccountSnapshot *snapshot, const char *accountId) {
+    uint64_t hash = hashAccountId(accountId);
+    uint64_t mask = snapshot->capacity - 1;
+
+    for (uint64_t i = 0; i <= mask; i++) {
+        SnapshotEntry *entry = &(snapshot->entries[(hash + i) & mask]);
+        uint32_t state = __atomic_load_n(&(entry->state), __ATOMIC_ACQUIRE);
+        if (state == SNAPSHOT_EMPTY) {
+            return NULL;
+        }
+        if (state == SNAPSHOT_READY && entry->hash == (uint32_t)hash &&
+            strncmp(entry->id, accountId, ACCOUNT_ID_LENGTH) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Saves an account's before-image for the current report.
+ *
+ * The caller holds the account's lane exclusively, so the same account is
+ * never added twice concurrently. Like the cache, the table is only filled
+ * to three quarters.
+ *
+ * @param snapshot Pointer to the snapshot table.
+ * @param accountId The account ID as a string.
+ * @param balance The balance at the cut, or -1 if the account did not exist.
+ * @return false if the table is full.
+ */
+bool snapshotAddEntry(AccountSnapshot *snapshot, const char *accountId, Money balance) {
+    if (__atomic_add_fetch(&(snapshot->used), 1, __ATOMIC_RELAXED) > snapshot->capacity / 4 * 3) {
+        __atomic_sub_fetch(&(snapshot->used), 1, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    uint64_t hash = hashAccountId(accountId);
+    uint64_t mask = snapshot->capacity - 1;
+
+    for (uint64_t i = 0; i <= mask; i++) {
+        SnapshotEntry *entry = &(snapshot->entries[(hash + i) & mask]);
+        uint32_t expected = SNAPSHOT_EMPTY;
+        if (!__atomic_compare_exchange_n(&(entry->state), &expected, (uint32_t)SNAPSHOT_BUSY, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            continue; // In use, or claimed by another process first
+        }
+
+        strncpy(entry->id, accountId, ACCOUNT_ID_LENGTH - 1);
+        entry->id[ACCOUNT_ID_LENGTH - 1] = '\0';
+        entry->hash = (uint32_t)hash;
+        entry->balance = balance;
+        __atomic_store_n(&(entry->state), (uint32_t)SNAPSHOT_READY, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&(snapshot->preserved), 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Moves writers to a new epoch and waits until every writer of the old one has exited.
+ *
+ * @return The old epoch.
+ */
+static long advanceEpoch(AccountSnapshot *snapshot) {
+    long old = __atomic_fetch_add(&(snapshot->epoch), 1, __ATOMIC_SEQ_CST);
+    for (int spin = 1; __atomic_load_n(&(snapshot->writers[old & 1]), __ATOMIC_SEQ_CST) != 0; spin++) {
+        if (spin % 64 == 0) {
+            sched_yield();
+        }
+    }
+    return old;
+}
+
+/**
+ * @brief Takes the cut for a report; writers keep running.
+ *
+ * First waits out every writer that could still be saving before-images
+ * for the previous report and clears the table, then cuts: writers already
+ * admitted are part of the report and are waited for, and every writer
+ * admitted after the cut saves the before-image of each account it changes.
+ * Only one report runs at a time; end it with endSnapshot.
+ *
+ * @param snapshot Pointer to the snapshot table.
+ */
+void beginSnapshot(AccountSnapshot *snapshot) {
+    lockSharedMutex(&(snapshot->report_mutex));
+
+    advanceEpoch(snapshot);
+    for (uint64_t i = 0; i < snapshot->capacity; i++) {
+        snapshot->entries[i].state = SNAPSHOT_EMPTY;
+    }
+    __atomic_store_n(&(snapshot->used), 0, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&(snapshot->cut), __atomic_load_n(&(snapshot->epoch), __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    __atomic_store_n(&(snapshot->active), 1, __ATOMIC_SEQ_CST);
+    advanceEpoch(snapshot);
+    snapshot->reports++;
+}
+
+/**
+ * @brief Ends the report started by beginSnapshot.
+ */
+void endSnapshot(AccountSnapshot *snapshot) {
+    __atomic_store_n(&(snapshot->active), 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&(snapshot->report_mutex));
+}
@@ -0,0 +1,61 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef ACCOUNT_SNAPSHOT_H
+#define ACCOUNT_SNAPSHOT_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "sharedmemory.h"
+
+#define DEFAULT_SNAPSHOT_CAPACITY 65536  // Accounts that can change while one report runs (rounded up to a power of two)
+
+// Before-image entry states
+enum SnapshotEntryState {
+    SNAPSHOT_EMPTY = 0,
+    SNAPSHOT_BUSY = 1,    // Being filled in by the writer that claimed it
+    SNAPSHOT_READY = 2
+};
+
+// An account's balance as of the report's cut, saved by the first writer
+// to change it after the cut
+struct SnapshotEntry {
+    Money balance;     // -1 if the account did not exist at the cut
+    uint32_t state;    // SnapshotEntryState, updated atomically
+    uint32_t hash;     // Low bits of the id hash, checked before comparing ids
+    char id[ACCOUNT_ID_LENGTH];
+};
+
+// Point-in-time reports without stopping writers, in memory shared by every
+// process (entries follow the header). Writers are admitted into epochs; a
+// report cuts between two epochs, waits for the writers of the older one to
+// exit, and reads every account, taking the before-image of those that
+// writers of the newer epoch have changed since.
+struct AccountSnapshot {
+    alignas(64) long epoch;          // Epoch writers are admitted into now (atomic)
+    long cut;                        // Newest epoch included in the report being taken
+    int active;                      // Set while a report reads (atomic)
+    alignas(64) long writers[2];     // Writers in an even / odd epoch that have not exited yet (atomic)
+    alignas(64) pthread_mutex_t report_mutex; // One report at a time
+    uint64_t capacity;               // Number of entries (power of two)
+    uint64_t used;                   // Entries claimed during the current report (atomic)
+    long reports;                    // Reports taken
+    long preserved;                  // Before-images saved by writers (atomic)
+    long full_waits;                 // Writers that waited for a report because the entries ran out (atomic)
+    SnapshotEntry entries[];
+};
+
+size_t accountSnapshotSize(uint64_t capacity);
+void initializeAccountSnapshot(AccountSnapshot *snapshot, uint64_t capacity);
+long snapshotEnterWriter(AccountSnapshot *snapshot);
+void snapshotExitWriter(AccountSnapshot *snapshot, long epoch);
+bool snapshotWantsBeforeImage(AccountSnapshot *snapshot, long epoch);
+SnapshotEntry *snapshotFindEntry(AccountSnapshot *snapshot, const char *accountId);
+bool snapshotAddEntry(AccountSnapshot *snapshot, const char *accountId, Money balance);
+void beginSnapshot(AccountSnapshot *snapshot);
+void endSnapshot(AccountSnapshot *snapshot);
+
+#endif // ACCOUNT_SNAPSHOT_H
@@ -0,0 +1,226 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "account_store.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Hashes an account ID (64-bit FNV-1a followed by the MurmurHash3 finalizer).
+ *
+ * The finalizer spreads every input bit over the low bits, which is what the
+ * store's probe start and the monitor's lock stripe index are taken from.
+ *
+ * @param accountId The account ID as a string.
+ * @return The hash value.
+ */
+uint64_t hashAccountId(const char *accountId) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; accountId[i] != '\0'; i++) {
+        hash ^= (unsigned char)accountId[i];
+        hash *= 1099511628211ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * @brief Opens (or creates) a mapped account store file.
+ *
+ * An existing store keeps the capacity it was created with.
+ *
+ * @param store Receives the mapped store.
+ * @param path Path of the store file.
+ * @param capacity Number of slots to create a new store with.
+ * @return 0 on success, or -1 on failure.
+ */
+int openAccountStore(AccountStore *store, const char *path, uint64_t capacity) {
+    int fd = open(path, O_RDWR | O_CREAT, 0666);
+    if (fd == -1) {
+        printf("Error opening account store: %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        printf("Error reading account store: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    bool created = (st.st_size == 0);
+    if (created) {
+        uint64_t slots = 1;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        capacity = slots;
+        if (ftruncate(fd, sizeof(AccountStoreHeader) + capacity * sizeof(AccountSlot)) == -1) {
+            printf("Error sizing account store: %s\n", path);
+            close(fd);
+            return -1;
+        }
+    } else {
+        AccountStoreHeader header;
+        if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+            header.magic != ACCOUNT_STORE_MAGIC || header.version != ACCOUNT_STORE_VERSION) {
+            printf("Error: %s is not an account store.\n", path);
+            close(fd);
+            return -1;
+        }
+        capacity = header.capacity;
+    }
+
+    size_t size = sizeof(AccountStoreHeader) + capacity * sizeof(AccountSlot);
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        printf("Error mapping account store: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    store->header = (AccountStoreHeader *)base;
+    store->slots = (AccountSlot *)((char *)base + sizeof(AccountStoreHeader));
+    store->mapped_size = size;
+    store->fd = fd;
+
+    if (created) {
+        store->header->capacity = capacity;
+        store->header->live_count = 0;
+        store->header->version = ACCOUNT_STORE_VERSION;
+        store->header->magic = ACCOUNT_STORE_MAGIC;
+    }
+    return 0;
+}
+
+/**
+ * @brief Unmaps and closes an account store.
+ *
+ * @param store Pointer to the store.
+ */
+void closeAccountStore(AccountStore *store) {
+    if (store->header != NULL) {
+        munmap(store->header, store->mapped_size);
+        close(store->fd);
+        store->header = NULL;
+        store->slots = NULL;
+    }
+}
+
+/**
+ * @brief Looks up an open account.
+ *
+ * @param store Pointer to the store.
+ * @param accountId The account ID as a string.
+ * @return The account's slot, or NULL if the account does not exist.
+ */
+AccountSlot *storeFindAccount(AccountStore *store, const char *accountId) {
+    uint64_t hash = hashAccountId(accountId);
+    uint64_t mask = store->header->capacity - 1;
+
+    for (uint64_t i = 0; i <= mask; i++) {
+        AccountSlot *slot = &(store->slots[(hash + i) & mask]);
+        uint32_t state = __atomic_load_n(&(slot->state), __ATOMIC_ACQUIRE);
+        if (state == SLOT_EMPTY) {
+            return NULL;
+        }
+        if (state == SLOT_LIVE && slot->hash == (uint32_t)hash &&
+            strncmp(slot->id, accountId, ACCOUNT_ID_LENGTH) == 0) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Adds a new account to the store.
+ *
+ * The caller must hold the account's mutex so that the same ID is never
+ * created twice concurrently.
+ *
+ * @param store Pointer to the store.
+ * @param accountId The account ID as a string.
+ * @param name The name of the account holder.
+ * @param balanceCents The initial balance in cents.
+ * @return 0 on success, -1 if the account exists, or -2 if the store is full.
+ */
+int storeCreateAccount(AccountStore *store, const char *accountId, const char *name, Money balanceCents) {
+    if (storeFindAccount(store, accountId) != NULL) {
+        return -1;
+    }
+
+    uint64_t hash = hashAccountId(accountId);
+    uint64_t mask = store->header->capacity - 1;
+
+    for (uint64_t i = 0; i <= mask; i++) {
+        AccountSlot *slot = &(store->slots[(hash + i) & mask]);
+        uint32_t state = __atomic_load_n(&(slot->state), __ATOMIC_ACQUIRE);
+        if (state != SLOT_EMPTY && state != SLOT_DELETED) {
+            continue;
+        }
+        if (!__atomic_compare_exchange_n(&(slot->state), &state, (uint32_t)SLOT_BUSY, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            continue; // Another process claimed this slot first
+        }
+
+        strncpy(slot->id, accountId, ACCOUNT_ID_LENGTH - 1);
+        slot->id[ACCOUNT_ID_LENGTH - 1] = '\0';
+        strncpy(slot->name, name, ACCOUNT_NAME_LENGTH - 1);
+        slot->name[ACCOUNT_NAME_LENGTH - 1] = '\0';
+        slot->hash = (uint32_t)hash;
+        slot->balance_cents = balanceCents;
+        __atomic_store_n(&(slot->state), (uint32_t)SLOT_LIVE, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&(store->header->live_count), 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return -2;
+}
+
+/**
+ * @brief Removes an account from the store.
+ *
+ * @param store Pointer to the store.
+ * @param accountId The account ID as a string.
+ * @return 0 on success, or -1 if the account does not exist.
+ */
+int storeDeleteAccount(AccountStore *store, const char *accountId) {
+    AccountSlot *slot = storeFindAccount(store, accountId);
+    if (slot == NULL) {
+        return -1;
+    }
+    __atomic_store_n(&(slot->state), (uint32_t)SLOT_DELETED, __ATOMIC_RELEASE);
+    __atomic_sub_fetch(&(store->header->live_count), 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @brief Calls a function with the ID of every open account in the store.
+ *
+ * Accounts may be created and deleted meanwhile; each slot is looked at once.
+ *
+ * @param store Pointer to the store.
+ * @param visit Called with each account ID.
+ * @param context Passed to visit.
+ */
+void storeForEachAccount(AccountStore *store, AccountVisitor visit, void *context) {
+    for (uint64_t i = 0; i < store->header->capacity; i++) {
+        AccountSlot *slot = &(store->slots[i]);
+        if (__atomic_load_n(&(slot->state), __ATOMIC_ACQUIRE) != SLOT_LIVE) {
+            continue;
+        }
+        char id[ACCOUNT_ID_LENGTH];
+        memcpy(id, slot->id, ACCOUNT_ID_LENGTH);
+        id[ACCOUNT_ID_LENGTH - 1] = '\0';
+        visit(id, context);
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef ACCOUNT_STORE_H
+#define ACCOUNT_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sharedmemory.h"
+
+#define ACCOUNT_STORE_MAGIC 0x4f534143u  // "CASO", marks a valid store file
+#define ACCOUNT_STORE_VERSION 2
+#define ACCOUNT_NAME_LENGTH 32
+#define DEFAULT_STORE_CAPACITY 65536     // Slots in a newly created store (rounded up to a power of two)
+
+// Slot states (also the in-file index: a probe stops at the first EMPTY slot)
+enum AccountSlotState {
+    SLOT_EMPTY = 0,    // Never used
+    SLOT_BUSY = 1,     // Being filled in by a create
+    SLOT_LIVE = 2,     // Holds an open account
+    SLOT_DELETED = 3   // Closed account (tombstone, reusable)
+};
+
+// Fixed-size account record stored in the mapped file
+struct AccountSlot {
+    Money balance_cents;               // Balance as integer cents
+    uint32_t state;                    // AccountSlotState, updated atomically
+    uint32_t hash;                     // Low bits of the id hash, checked before comparing ids
+    char id[ACCOUNT_ID_LENGTH];
+    char name[ACCOUNT_NAME_LENGTH];
+};
+
+// Header at the start of the mapped file
+struct AccountStoreHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;     // Number of slots (power of two)
+    uint64_t live_count;   // Number of LIVE slots
+};
+
+// Process-local handle to a mapped account store
+struct AccountStore {
+    AccountStoreHeader *header;
+    AccountSlot *slots;
+    size_t mapped_size;
+    int fd;
+};
+
+uint64_t hashAccountId(const char *accountId);
+int openAccountStore(AccountStore *store, const char *path, uint64_t capacity);
+void closeAccountStore(AccountStore *store);
+AccountSlot *storeFindAccount(AccountStore *store, const char *accountId);
+int storeCreateAccount(AccountStore *store, const char *accountId, const char *name, Money balanceCents);
+int storeDeleteAccount(AccountStore *store, const char *accountId);
+void storeForEachAccount(AccountStore *store, AccountVisitor visit, void *context);
+
+#endif // ACCOUNT_STORE_H
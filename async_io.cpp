@@ -0,0 +1,398 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "async_io.h"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+// This process's io_uring instance (rings are not shared across fork, so each process sets up its own)
+struct AsyncRing {
+    int fd;                 // Ring file descriptor, or -1 if not set up
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    io_uring_sqe *sqes;
+    io_uring_cqe *cqes;
+    void *sq_map, *cq_map;
+    size_t sq_map_size, cq_map_size, sqes_size;
+    unsigned queued;        // SQEs filled in since the last submission
+};
+
+/**
+ * @brief The ring used by this process, and whether setting it up failed.
+ */
+static AsyncRing ring = {-1, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, 0, 0};
+static bool ring_failed = false;
+
+/**
+ * @brief Set in a forked child, whose copy of the ring belongs to the parent.
+ *
+ * Checked instead of comparing getpid() on every call, which would cost a
+ * system call per submission.
+ */
+static bool ring_inherited = false;
+static bool ring_atfork_registered = false;
+
+/**
+ * @brief io_uring_enter calls made by this process.
+ */
+static long submissions = 0;
+
+/**
+ * @brief Unmaps and closes the ring (also used to drop a ring inherited from the parent process).
+ */
+static void releaseRing() {
+    if (ring.sqes != NULL) {
+        munmap(ring.sqes, ring.sqes_size);
+    }
+    if (ring.cq_map != NULL && ring.cq_map != ring.sq_map) {
+        munmap(ring.cq_map, ring.cq_map_size);
+    }
+    if (ring.sq_map != NULL) {
+        munmap(ring.sq_map, ring.sq_map_size);
+    }
+    if (ring.fd != -1) {
+        close(ring.fd);
+    }
+    memset(&ring, 0, sizeof(ring));
+    ring.fd = -1;
+}
+
+/**
+ * @brief pthread_atfork child handler: the next call sets up a ring of the child's own.
+ */
+static void markRingInherited() {
+    ring_inherited = true;
+}
+
+/**
+ * @brief Returns a free submission queue entry, cleared.
+ */
+static io_uring_sqe *nextSqe() {
+    unsigned tail = *ring.sq_tail + ring.queued;
+    unsigned index = tail & *ring.sq_mask;
+    io_uring_sqe *sqe = &(ring.sqes[index]);
+    memset(sqe, 0, sizeof(*sqe));
+    ring.sq_array[index] = index;
+    ring.queued++;
+    return sqe;
+}
+
+/**
+ * @brief Submits every queued entry and waits until waitFor completions are available.
+ *
+ * @return 0 on success, or -1 if io_uring_enter failed.
+ */
+static int submitAndWait(unsigned waitFor) {
+    __atomic_store_n(ring.sq_tail, *ring.sq_tail + ring.queued, __ATOMIC_RELEASE);
+    unsigned toSubmit = ring.queued;
+    ring.queued = 0;
+
+    while (toSubmit > 0 || waitFor > 0) {
+        submissions++;
+        int submitted = (int)syscall(__NR_io_uring_enter, ring.fd, toSubmit, waitFor, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (submitted < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        toSubmit -= submitted;
+        unsigned ready = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE) - *ring.cq_head;
+        if (ready >= waitFor) {
+            break;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Takes the next completion, which must already be available.
+ */
+static io_uring_cqe takeCqe() {
+    unsigned head = *ring.cq_head;
+    io_uring_cqe cqe = ring.cqes[head & *ring.cq_mask];
+    __atomic_store_n(ring.cq_head, head + 1, __ATOMIC_RELEASE);
+    return cqe;
+}
+
+/**
+ * @brief Queues an open of a path into a direct descriptor slot.
+ */
+static void queueOpen(const char *path, int flags, unsigned slot, uint64_t userData, bool link) {
+    io_uring_sqe *sqe = nextSqe();
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = (uint64_t)(uintptr_t)path;
+    sqe->open_flags = flags;
+    sqe->file_index = slot + 1;
+    sqe->user_data = userData;
+    if (link) {
+        sqe->flags |= IOSQE_IO_LINK;
+    }
+}
+
+/**
+ * @brief Queues a close of a direct descriptor slot.
+ */
+static void queueClose(unsigned slot, uint64_t userData) {
+    io_uring_sqe *sqe = nextSqe();
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->file_index = slot + 1;
+    sqe->user_data = userData;
+}
+
+/**
+ * @brief Sets up this process's ring if it has none yet.
+ *
+ * The ring gets a table of ASYNC_IO_FILES direct descriptors, so a file can
+ * be opened, read or written and closed by one linked chain without its
+ * descriptor ever reaching user space. A chain on /dev/null checks that the
+ * kernel supports this before the ring is used.
+ *
+ * @return true if the ring is ready, false if io_uring is unavailable.
+ */
+static bool ensureRing() {
+    if (ring.fd != -1 && !ring_inherited) {
+        return true;
+    }
+    if (ring_inherited) {
+        ring_inherited = false;
+        if (ring.fd != -1) {
+            releaseRing();
+            ring_failed = false;
+        }
+    }
+    if (ring_failed) {
+        return false;
+    }
+    ring_failed = true;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring.fd = (int)syscall(__NR_io_uring_setup, ASYNC_IO_ENTRIES, &params);
+    if (ring.fd < 0) {
+        ring.fd = -1;
+        return false;
+    }
+    if (!ring_atfork_registered) {
+        pthread_atfork(NULL, NULL, markRingInherited);
+        ring_atfork_registered = true;
+    }
+
+    ring.sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring.cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    ring.sq_map = mmap(NULL, ring.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+    ring.cq_map = mmap(NULL, ring.cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    ring.sqes = (io_uring_sqe *)mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    if (ring.sq_map == MAP_FAILED || ring.cq_map == MAP_FAILED || ring.sqes == MAP_FAILED) {
+        ring.sq_map = (ring.sq_map == MAP_FAILED) ? NULL : ring.sq_map;
+        ring.cq_map = (ring.cq_map == MAP_FAILED) ? NULL : ring.cq_map;
+        ring.sqes = (ring.sqes == MAP_FAILED) ? NULL : ring.sqes;
+        releaseRing();
+        return false;
+    }
+
+    char *sq = (char *)ring.sq_map;
+    char *cq = (char *)ring.cq_map;
+    ring.sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring.sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring.sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring.sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring.cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring.cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring.cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring.cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    int slots[ASYNC_IO_FILES];
+    for (int i = 0; i < ASYNC_IO_FILES; i++) {
+        slots[i] = -1;
+    }
+    if (syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_FILES, slots, ASYNC_IO_FILES) < 0) {
+        releaseRing();
+        return false;
+    }
+
+    queueOpen("/dev/null", O_RDONLY, 0, 0, true);
+    queueClose(0, 1);
+    if (submitAndWait(2) != 0) {
+        releaseRing();
+        return false;
+    }
+    io_uring_cqe open = takeCqe();
+    io_uring_cqe closed = takeCqe();
+    if (open.res < 0 || closed.res < 0) {
+        releaseRing();
+        return false;
+    }
+
+    ring_failed = false;
+    return true;
+}
+
+/**
+ * @brief Checks whether io_uring can be used, setting up this process's ring.
+ *
+ * @return true if io_uring (with direct descriptors) is available.
+ */
+bool asyncIoAvailable() {
+    return ensureRing();
+}
+
+/**
+ * @brief Runs open -> read/write -> close chains for up to ASYNC_IO_FILES files in one submission.
+ *
+ * The read or write is hard-linked to the close, so a short or failed
+ * transfer still releases its descriptor slot; a failed open cancels the
+ * rest of its chain.
+ */
+static int runFileChains(AsyncFileOp *ops, int count, bool write) {
+    for (int i = 0; i < count; i++) {
+        AsyncFileOp *op = &(ops[i]);
+        op->result = 0;
+        queueOpen(op->path, write ? (O_WRONLY | O_TRUNC) : O_RDONLY, i, (uint64_t)i << 2, true);
+
+        io_uring_sqe *sqe = nextSqe();
+        sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd = i;
+        sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+        sqe->addr = (uint64_t)(uintptr_t)op->buffer;
+        sqe->len = write ? op->length : ASYNC_IO_BUFFER - 1;
+        sqe->off = 0;
+        sqe->user_data = ((uint64_t)i << 2) | 1;
+
+        queueClose(i, ((uint64_t)i << 2) | 2);
+    }
+    if (submitAndWait(3 * count) != 0) {
+        return -1;
+    }
+
+    for (int c = 0; c < 3 * count; c++) {
+        io_uring_cqe cqe = takeCqe();
+        AsyncFileOp *op = &(ops[cqe.user_data >> 2]);
+        int step = (int)(cqe.user_data & 3);
+        if (cqe.res < 0) {
+            if (op->result == 0) {
+                op->result = cqe.res;
+            }
+        } else if (step == 1) {
+            if (write && cqe.res != op->length && op->result == 0) {
+                op->result = -EIO;
+            }
+            if (!write) {
+                op->length = cqe.res;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads account files with batched submissions.
+ *
+ * @param ops The files to read; each gets its contents in buffer and length, or a negative result.
+ * @param count Number of files.
+ * @return 0 once every read has completed, or -1 if io_uring is unavailable (nothing was read).
+ */
+int asyncReadFiles(AsyncFileOp *ops, int count) {
+    if (!ensureRing()) {
+        return -1;
+    }
+    for (int start = 0; start < count; start += ASYNC_IO_FILES) {
+        int size = (count - start < ASYNC_IO_FILES) ? count - start : ASYNC_IO_FILES;
+        if (runFileChains(ops + start, size, false) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Rewrites existing account files with batched submissions.
+ *
+ * @param ops The files to write, with their new contents in buffer and length.
+ * @param count Number of files.
+ * @return 0 once every write has completed (check each result), or -1 if io_uring is unavailable.
+ */
+int asyncWriteFiles(AsyncFileOp *ops, int count) {
+    if (!ensureRing()) {
+        return -1;
+    }
+    for (int start = 0; start < count; start += ASYNC_IO_FILES) {
+        int size = (count - start < ASYNC_IO_FILES) ? count - start : ASYNC_IO_FILES;
+        if (runFileChains(ops + start, size, true) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Appends data to a file and syncs its data with one linked write -> fdatasync submission.
+ *
+ * @param fd File opened for appending.
+ * @param data The data.
+ * @param length Number of bytes.
+ * @return 0 on success, -1 on an I/O error, or -2 if io_uring is unavailable (nothing was written).
+ */
+int asyncWriteAndSync(int fd, const char *data, size_t length) {
+    if (!ensureRing()) {
+        return -2;
+    }
+    if (length == 0) {
+        return fdatasync(fd);
+    }
+    while (length > 0) {
+        io_uring_sqe *sqe = nextSqe();
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd;
+        sqe->flags = IOSQE_IO_LINK;
+        sqe->addr = (uint64_t)(uintptr_t)data;
+        sqe->len = (length > (1u << 30)) ? (1u << 30) : (unsigned)length;
+        sqe->off = (uint64_t)-1; // Current file position (the end, for O_APPEND)
+        sqe->user_data = 0;
+
+        sqe = nextSqe();
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = fd;
+        sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        sqe->user_data = 1;
+
+        if (submitAndWait(2) != 0) {
+            return -1;
+        }
+        io_uring_cqe written = takeCqe();
+        io_uring_cqe synced = takeCqe();
+        if (written.user_data != 0) {
+            io_uring_cqe swap = written;
+            written = synced;
+            synced = swap;
+        }
+        if (written.res <= 0) {
+            return -1;
+        }
+        data += written.res;
+        length -= written.res;
+        if (length == 0 && synced.res < 0) {
+            return -1;
+        }
+        // After a short write the sync was cancelled; the loop writes the rest and syncs again
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns how many io_uring_enter calls this process has made.
+ */
+long asyncIoSubmissions() {
+    return submissions;
+}
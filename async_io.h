@@ -0,0 +1,30 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <stddef.h>
+
+#define ASYNC_IO_ENTRIES 256   // Submission queue entries of each process's ring
+#define ASYNC_IO_FILES 64      // Direct descriptor slots: account files open at once in one submission
+#define ASYNC_IO_BUFFER 48     // Bytes read from or written to an account file
+#define ASYNC_IO_PATH 48      // Enough for a sharded account file path
+
+// One account file read or rewrite, run as a linked open -> read/write -> close chain
+struct AsyncFileOp {
+    char path[ASYNC_IO_PATH];
+    char buffer[ASYNC_IO_BUFFER];
+    int length;   // Bytes to write; for reads, set to the bytes read
+    int result;   // 0 on success, or -errno of the first step that failed
+};
+
+bool asyncIoAvailable();
+int asyncReadFiles(AsyncFileOp *ops, int count);
+int asyncWriteFiles(AsyncFileOp *ops, int count);
+int asyncWriteAndSync(int fd, const char *data, size_t length);
+long asyncIoSubmissions();
+
+#endif // ASYNC_IO_H
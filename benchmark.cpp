@@ -0,0 +1,2494 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/ptrace.h>
+#include <signal.h>
+#include <dirent.h>
+#include <limits.h>
+#include "sharedmemory.h"
+#include "monitor.h"
+#include "shared_segment.h"
+#include "money.cpp"
+#include "transaction_log.cpp"
+#include "async_io.cpp"
+#include "event_output.cpp"
+#include "write_ahead_log.cpp"
+#include "account_store.cpp"
+#include "account_cache.cpp"
+#include "account_snapshot.cpp"
+#include "account_combiner.cpp"
+#include "account_directory.cpp"
+#include "metrics.cpp"
+#include "monitor_init_and_queue.cpp"
+#include "shared_segment.cpp"
+#include "monitor_helpers.cpp"
+#include "monitor_transactions.cpp"
+#include "input_parser.cpp"
+#include "worker_pool.cpp"
+#include "workload_generator.cpp"
+using namespace std;
+
+/**
+ * @brief Returns the seconds elapsed between two monotonic timestamps.
+ */
+static double elapsedSeconds(const timespec &start, const timespec &end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ */
+static long nowNanoseconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+/**
+ * @brief Returns the given percentile of a sorted sample.
+ */
+static long percentile(const vector<long> &sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/**
+ * @brief Reads "--name value" from the benchmark arguments.
+ *
+ * @return The value, or defaultValue if the option is absent.
+ */
+static long longOption(int argc, char *argv[], const char *name, long defaultValue) {
+    for (int i = 2; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return atol(argv[i + 1]);
+        }
+    }
+    return defaultValue;
+}
+
+/**
+ * @brief Reads "--name value" from the benchmark arguments as a string.
+ *
+ * @return The value, or defaultValue if the option is absent.
+ */
+static const char *stringOption(int argc, char *argv[], const char *name, const char *defaultValue) {
+    for (int i = 2; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return defaultValue;
+}
+
+/**
+ * @brief Measures transaction log append throughput with many concurrent writer processes.
+ *
+ * Runs the same workload once per append mode and prints one line per mode.
+ * Options: --writers N, --records N (per writer), --capacity N (ring size).
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchLogAppend(int argc, char *argv[]) {
+    int writers = (int)longOption(argc, argv, "--writers", 8);
+    long records = longOption(argc, argv, "--records", 200000);
+    long capacity = longOption(argc, argv, "--capacity", DEFAULT_LOG_CAPACITY);
+    const char *spillPath = "benchmark_transactions.log";
+
+    LogAppendMode modes[] = {LOG_APPEND_MUTEX, LOG_APPEND_LOCKFREE};
+    const char *modeNames[] = {"mutex", "lockfree"};
+
+    for (int m = 0; m < 2; m++) {
+        size_t size = transactionLogSize(capacity);
+        SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                                                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (shm_ptr == MAP_FAILED) {
+            perror("Benchmark mmap");
+            return 1;
+        }
+        initializeTransactionLog(shm_ptr, capacity, spillPath);
+        shm_ptr->append_mode = modes[m];
+
+        TransactionRecord record;
+        memset(&record, 0, sizeof(record));
+        record.transaction_type = TXN_DEPOSIT;
+        record.status = TXN_SUCCESS;
+        record.reason = REASON_NONE;
+        strcpy(record.account_id, "Bench");
+        record.amount = 100;
+
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int w = 0; w < writers; w++) {
+            if (fork() == 0) {
+                for (long i = 0; i < records; i++) {
+                    appendTransaction(shm_ptr, &record);
+                }
+                exit(0);
+            }
+        }
+        for (int w = 0; w < writers; w++) {
+            wait(NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double seconds = elapsedSeconds(start, end);
+        long total = (long)writers * records;
+        cout << "log-append mode=" << modeNames[m] << " writers=" << writers << " records=" << total
+             << " capacity=" << capacity << " seconds=" << seconds
+             << " records_per_sec=" << (long)(total / seconds) << endl;
+
+        destroyTransactionLog(shm_ptr);
+        munmap(shm_ptr, size);
+        unlink(spillPath);
+    }
+    return 0;
+}
+
+/**
+ * @brief Measures fairness and wait time of the monitor queue under contention.
+ *
+ * Every process repeatedly enters the monitor, holds it briefly and exits.
+ * Each admission is logged with the time the process started waiting, so
+ * the report shows the wait-time distribution, how evenly the waits are
+ * spread across processes (Jain's index, 1.0 is perfectly even) and how
+ * often a later arrival was admitted before an earlier one (inversions).
+ * Options: --processes N, --entries N (per process), --hold-ns N.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchMonitorFairness(int argc, char *argv[]) {
+    int processes = (int)longOption(argc, argv, "--processes", 8);
+    long entries = longOption(argc, argv, "--entries", 2000);
+    long holdNanoseconds = longOption(argc, argv, "--hold-ns", 1000);
+    if (processes < 1 || processes > MAX_QUEUED_PROCESSES) {
+        cerr << "Error: --processes must be between 1 and " << MAX_QUEUED_PROCESSES << endl;
+        return 1;
+    }
+
+    long total = processes * entries;
+    size_t size = monitorSize(DEFAULT_LOCK_STRIPES) + sizeof(long) + 2 * total * sizeof(long);
+    char *base = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    Monitor *monitor = (Monitor *)base;
+    long *admitted = (long *)(base + monitorSize(DEFAULT_LOCK_STRIPES));
+    long *arrivals = admitted + 1;           // Arrival time of each admission, in admission order
+    long *waits = arrivals + total;          // Wait time of each admission, grouped by process
+    initializeMonitor(monitor, NULL, DEFAULT_LOCK_STRIPES);
+
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int p = 0; p < processes; p++) {
+        if (fork() == 0) {
+            freopen("/dev/null", "w", stdout); // Silence the per-entry queue messages
+            for (long i = 0; i < entries; i++) {
+                long arrival = nowNanoseconds();
+                enterMonitor(monitor, "Bench");
+                long admittedAt = nowNanoseconds();
+                arrivals[(*admitted)++] = arrival;
+                while (nowNanoseconds() - admittedAt < holdNanoseconds) {
+                }
+                exitMonitor(monitor);
+                waits[p * entries + i] = admittedAt - arrival;
+            }
+            exit(0);
+        }
+    }
+    for (int p = 0; p < processes; p++) {
+        wait(NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    long inversions = 0;
+    for (long i = 1; i < total; i++) {
+        if (arrivals[i] < arrivals[i - 1]) {
+            inversions++;
+        }
+    }
+
+    double sum = 0.0, sumSquares = 0.0;
+    for (int p = 0; p < processes; p++) {
+        double mean = 0.0;
+        for (long i = 0; i < entries; i++) {
+            mean += waits[p * entries + i];
+        }
+        mean /= entries;
+        sum += mean;
+        sumSquares += mean * mean;
+    }
+    double jain = sumSquares > 0 ? (sum * sum) / (processes * sumSquares) : 1.0;
+
+    vector<long> sorted(waits, waits + total);
+    sort(sorted.begin(), sorted.end());
+    double seconds = elapsedSeconds(start, end);
+
+    cout << "monitor-fairness processes=" << processes << " entries=" << total
+         << " seconds=" << seconds << " entries_per_sec=" << (long)(total / seconds)
+         << " wait_p50_ns=" << percentile(sorted, 50) << " wait_p90_ns=" << percentile(sorted, 90)
+         << " wait_p99_ns=" << percentile(sorted, 99) << " wait_max_ns=" << sorted.back()
+         << " jain_index=" << jain << " inversions=" << inversions << endl;
+
+    destroyMonitor(monitor);
+    munmap(base, size);
+    return 0;
+}
+
+/**
+ * @brief Measures concurrent inquiries on the same accounts under each account locking mode.
+ *
+ * --processes N processes each run --inquiries N inquiries spread over
+ * --accounts N account files (1 by default, so every reader shares one
+ * account), with the cache off so each inquiry reads its file:
+ *   exclusive-flock  admitted one at a time, flock on every read (the old path)
+ *   shared-flock     readers share the lane, still flocking
+ *   shared           readers share the lane, no flock
+ * Runs in a scratch directory that is removed afterwards.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchInquiryShare(int argc, char *argv[]) {
+    int processes = (int)longOption(argc, argv, "--processes", 8);
+    long inquiries = longOption(argc, argv, "--inquiries", 20000);
+    long accounts = longOption(argc, argv, "--accounts", 1);
+    const char *directory = "benchmark_inquiry";
+    if (processes < 1 || processes > MAX_QUEUED_PROCESSES || accounts < 1) {
+        cerr << "Error: --processes must be between 1 and " << MAX_QUEUED_PROCESSES
+             << " and --accounts positive" << endl;
+        return 1;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    const char *modeNames[] = {"exclusive-flock", "shared-flock", "shared"};
+    for (int m = 0; m < 3; m++) {
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        monitor->flock_compat = (m < 2);
+        fflush(stdout);
+        int savedStdout = dup(STDOUT_FILENO);
+        freopen("/dev/null", "w", stdout);
+        char id[ACCOUNT_ID_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            createAccount(monitor, id, id, 1000 * MONEY_SCALE);
+        }
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int p = 0; p < processes; p++) {
+            if (fork() == 0) {
+                freopen("/dev/null", "w", stdout); // Silence the per-inquiry messages
+                for (long i = 0; i < inquiries; i++) {
+                    snprintf(id, sizeof(id), "Acct%d", (int)((p + i) % accounts));
+                    if (m == 0) {
+                        enterMonitor(monitor, id);
+                        int index = getAccountMutexIndex(monitor, id);
+                        lockAccountMutex(monitor, index, id);
+                        inquiryLocked(monitor, id);
+                        unlockAccountMutex(monitor, index);
+                        exitMonitor(monitor);
+                    } else {
+                        inquiry(monitor, id);
+                    }
+                }
+                exit(0);
+            }
+        }
+        for (int p = 0; p < processes; p++) {
+            wait(NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        LockTableStats stats;
+        getLockTableStats(monitor, &stats);
+        long total = processes * inquiries;
+        double seconds = elapsedSeconds(start, end);
+        cout << "inquiry-share mode=" << modeNames[m] << " processes=" << processes << " accounts=" << accounts
+             << " inquiries=" << total << " seconds=" << seconds
+             << " inquiries_per_sec=" << (long)(total / seconds) << " contended=" << stats.contended
+             << " wait_ms=" << stats.wait_ns / 1000000 << endl;
+
+        for (long a = 0; a < accounts; a++) {
+            char filename[30];
+            snprintf(filename, sizeof(filename), "Acct%ld.txt", a);
+            unlink(filename);
+        }
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+    }
+
+    unlink("transactions.log");
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return 0;
+}
+
+/**
+ * @brief Compares durable balance updates: per-file rewrite + fsync versus write-ahead log group commit.
+ *
+ * Every writer process updates its own account, so the only shared cost is
+ * making each change durable. Options: --writers N, --records N (per writer),
+ * --batch N and --max-latency-us N (group commit tuning).
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchWalCommit(int argc, char *argv[]) {
+    int writers = (int)longOption(argc, argv, "--writers", 8);
+    long records = longOption(argc, argv, "--records", 2000);
+    int batchSize = (int)longOption(argc, argv, "--batch", DEFAULT_WAL_BATCH_SIZE);
+    long maxLatencyUs = longOption(argc, argv, "--max-latency-us", DEFAULT_WAL_MAX_LATENCY_US);
+    const char *walPath = "benchmark_wal.log";
+
+    WriteAheadLog *wal = (WriteAheadLog *)mmap(NULL, sizeof(WriteAheadLog), PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (wal == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (openWriteAheadLog(wal, walPath, batchSize, maxLatencyUs, records * writers + 1) != 0) {
+        return 1;
+    }
+
+    const char *modeNames[] = {"file-fsync", "wal"};
+    for (int m = 0; m < 2; m++) {
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int w = 0; w < writers; w++) {
+            if (fork() == 0) {
+                char accountId[ACCOUNT_ID_LENGTH];
+                snprintf(accountId, sizeof(accountId), "Bench%d", w);
+                char filename[30];
+                snprintf(filename, sizeof(filename), "%s.txt", accountId);
+                int fd = open(filename, O_WRONLY | O_CREAT, 0666);
+
+                for (long i = 0; i < records; i++) {
+                    if (m == 0) {
+                        char buffer[50];
+                        snprintf(buffer, sizeof(buffer), "%.2lf", (double)i);
+                        ftruncate(fd, 0);
+                        pwrite(fd, buffer, strlen(buffer), 0);
+                        fdatasync(fd);
+                    } else {
+                        WalRecord record;
+                        memset(&record, 0, sizeof(record));
+                        record.count = 1;
+                        strcpy(record.entries[0].account_id, accountId);
+                        record.entries[0].operation = WAL_SET_BALANCE;
+                        record.entries[0].balance_cents = i * 100;
+                        uint64_t lsn = walAppend(wal, &record);
+                        walCommit(wal, lsn);
+                        walApplied(wal, lsn);
+                    }
+                }
+                close(fd);
+                unlink(filename);
+                exit(0);
+            }
+        }
+        for (int w = 0; w < writers; w++) {
+            wait(NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double seconds = elapsedSeconds(start, end);
+        long total = (long)writers * records;
+        cout << "wal-commit mode=" << modeNames[m] << " writers=" << writers << " records=" << total
+             << " seconds=" << seconds << " durable_updates_per_sec=" << (long)(total / seconds);
+        if (m == 1) {
+            cout << " group_flushes=" << wal->flushes << " records_per_flush=" << (double)wal->records / wal->flushes;
+        }
+        cout << endl;
+    }
+
+    closeWriteAheadLog(wal);
+    munmap(wal, sizeof(WriteAheadLog));
+    unlink(walPath);
+    return 0;
+}
+
+/**
+ * @brief Checks that recovery from the write-ahead log restores account files a crash left torn.
+ *
+ * A child process creates --accounts N accounts, checkpoints, runs
+ * --operations deposits, withdrawals and transfers with the log enabled
+ * and exits without another checkpoint, as if it had crashed. Every second account file is then cut
+ * short (half of those to nothing) before the log is replayed; every
+ * balance must come back. Runs in a scratch directory that is removed
+ * afterwards.
+ *
+ * @return 0 on success, or 1 if a balance was not restored.
+ */
+static int benchWalRecovery(int argc, char *argv[]) {
+    long accounts = longOption(argc, argv, "--accounts", 100);
+    long operations = longOption(argc, argv, "--operations", 2000);
+    const char *directory = "benchmark_recovery";
+    const char *walPath = "wal.log";
+    if (accounts < 2 || operations < 1) {
+        cerr << "Error: --accounts must be at least 2 and --operations positive" << endl;
+        return 1;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    WriteAheadLog *wal = (WriteAheadLog *)mmap(NULL, sizeof(WriteAheadLog), PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || wal == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+    initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+    if (openWriteAheadLog(wal, walPath, DEFAULT_WAL_BATCH_SIZE, DEFAULT_WAL_MAX_LATENCY_US, accounts + operations + 1) != 0) {
+        return 1;
+    }
+    monitor->wal = wal;
+
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (fork() == 0) {
+        freopen("/dev/null", "w", stdout); // Silence the per-transaction messages
+        unsigned int seed = 77;
+        char id[ACCOUNT_ID_LENGTH], other[ACCOUNT_ID_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            createAccount(monitor, id, id, (Money)WORKLOAD_OPENING_BALANCE * MONEY_SCALE);
+        }
+        monitorCheckpoint(monitor, true); // Only balance updates are left to replay
+        for (long i = 0; i < operations; i++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)(rand_r(&seed) % accounts));
+            snprintf(other, sizeof(other), "Acct%d", (int)(rand_r(&seed) % accounts));
+            Money amount = (1 + rand_r(&seed) % 100) * MONEY_SCALE;
+            if (i % 3 == 0) {
+                deposit(monitor, id, amount);
+            } else if (i % 3 == 1 || strcmp(id, other) == 0) {
+                withdraw(monitor, id, amount);
+            } else {
+                transfer(monitor, id, amount, other);
+            }
+        }
+        _exit(0); // Crash: no checkpoint, the log keeps every change
+    }
+    wait(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    monitor->wal = NULL;
+    destroyMonitor(monitor);
+    destroyTransactionLog(shm_ptr);
+
+    // The balances the crashed run left, before any file is torn
+    initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+    initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+    vector<Money> expected;
+    long torn = 0;
+    for (long a = 0; a < accounts; a++) {
+        char id[ACCOUNT_ID_LENGTH];
+        snprintf(id, sizeof(id), "Acct%d", (int)a);
+        expected.push_back(monitorGetBalance(monitor, id));
+        if (a % 2 == 0) {
+            char filename[30];
+            snprintf(filename, sizeof(filename), "Acct%ld.txt", a);
+            torn += (truncate(filename, (a % 4 == 0) ? 0 : 1) == 0);
+        }
+    }
+
+    long replayed = monitorRecoverAccounts(monitor, walPath);
+    long lost = 0;
+    for (long a = 0; a < accounts; a++) {
+        char id[ACCOUNT_ID_LENGTH];
+        snprintf(id, sizeof(id), "Acct%d", (int)a);
+        lost += (monitorGetBalance(monitor, id) != expected[a]);
+        char filename[30];
+        snprintf(filename, sizeof(filename), "Acct%ld.txt", a);
+        unlink(filename);
+    }
+    double seconds = elapsedSeconds(start, end);
+    cout << "wal-recovery accounts=" << accounts << " operations=" << operations << " seconds=" << seconds
+         << " torn_files=" << torn << " replayed=" << replayed << " lost_balances=" << lost << endl;
+
+    closeWriteAheadLog(wal);
+    destroyMonitor(monitor);
+    destroyTransactionLog(shm_ptr);
+    unlink(walPath);
+    unlink("transactions.log");
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    munmap(wal, sizeof(WriteAheadLog));
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return (replayed > 0 && lost == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Parses a line the way the driver did before the in-place parser (getline + stringstream).
+ *
+ * Kept only as the baseline of the parse benchmark.
+ *
+ * @return true if the line holds a known command.
+ */
+static bool parseLineWithStreams(const string &line, Transaction *transaction) {
+    stringstream ss(line);
+    string accountId, command, recipientId;
+    double amount = 0.0;
+
+    ss >> accountId >> command;
+    transform(command.begin(), command.end(), command.begin(), [](unsigned char c) { return toupper(c); });
+
+    if (command == "WITHDRAW" || command == "CREATE" || command == "DEPOSIT") {
+        ss >> amount;
+    } else if (command == "TRANSFER") {
+        ss >> amount >> recipientId;
+    } else if (command != "INQUIRY" && command != "CLOSE") {
+        return false;
+    }
+    snprintf(transaction->account_id, sizeof(transaction->account_id), "%s", accountId.c_str());
+    snprintf(transaction->recipient_account_id, sizeof(transaction->recipient_account_id), "%s", recipientId.c_str());
+    transaction->amount = llround(amount * MONEY_SCALE);
+    return true;
+}
+
+/**
+ * @brief Measures input parsing throughput in MB/s, without running any transactions.
+ *
+ * Parses --input FILE (or a generated file of --lines N mixed transactions)
+ * --repeat N times with the stream-based baseline and with the in-place parser.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchParse(int argc, char *argv[]) {
+    long lines = longOption(argc, argv, "--lines", 2000000);
+    int repeat = (int)longOption(argc, argv, "--repeat", 3);
+    const char *inputPath = stringOption(argc, argv, "--input", NULL);
+
+    const char *generatedPath = "benchmark_input.txt";
+    if (inputPath == NULL) {
+        FILE *file = fopen(generatedPath, "w");
+        if (file == NULL) {
+            perror("Benchmark input");
+            return 1;
+        }
+        const char *commands[] = {"Deposit", "withdraw", "Inquiry", "TRANSFER", "Create", "Close"};
+        for (long i = 0; i < lines; i++) {
+            int c = (int)(i % 6);
+            if (c == 3) {
+                fprintf(file, "Account%ld %s %ld.%02ld Account%ld\n", i % 1000, commands[c], i % 500, i % 100, (i + 7) % 1000);
+            } else if (c == 2 || c == 5) {
+                fprintf(file, "Account%ld %s\n", i % 1000, commands[c]);
+            } else {
+                fprintf(file, "Account%ld %s %ld.%02ld\n", i % 1000, commands[c], i % 500, i % 100);
+            }
+        }
+        fclose(file);
+        inputPath = generatedPath;
+    }
+
+    const char *modeNames[] = {"getline-stringstream", "in-place"};
+    for (int m = 0; m < 2; m++) {
+        long parsed = 0;
+        size_t bytes = 0;
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int r = 0; r < repeat; r++) {
+            Transaction transaction;
+            if (m == 0) {
+                ifstream input(inputPath);
+                string line;
+                while (getline(input, line)) {
+                    bytes += line.size() + 1;
+                    parsed += parseLineWithStreams(line, &transaction);
+                }
+            } else {
+                InputReader reader;
+                if (openInputReader(&reader, inputPath) != 0) {
+                    perror("Benchmark input");
+                    return 1;
+                }
+                string_view line, command;
+                while (nextInputLine(&reader, &line)) {
+                    parsed += (parseTransaction(line, &transaction, &command) == PARSE_OK);
+                }
+                bytes += reader.size;
+                closeInputReader(&reader);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double seconds = elapsedSeconds(start, end);
+        cout << "parse mode=" << modeNames[m] << " lines=" << parsed << " bytes=" << bytes
+             << " seconds=" << seconds << " mb_per_sec=" << bytes / seconds / 1e6 << endl;
+    }
+
+    if (inputPath == generatedPath) {
+        unlink(generatedPath);
+    }
+    return 0;
+}
+
+/**
+ * @brief Measures the account cache on a skewed workload against the files backend.
+ *
+ * Creates --accounts N account files, then runs --transactions N deposits,
+ * withdrawals, inquiries and transfers where --hot-percent P of them go to
+ * the hottest 1% of accounts, once without and once with the cache.
+ * Runs in a scratch directory that is removed afterwards.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchCacheSkew(int argc, char *argv[]) {
+    long accounts = longOption(argc, argv, "--accounts", 2000);
+    long transactions = longOption(argc, argv, "--transactions", 200000);
+    long hotPercent = longOption(argc, argv, "--hot-percent", 90);
+    long hotAccounts = (accounts / 100 > 0) ? accounts / 100 : 1;
+    const char *directory = "benchmark_accounts";
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t cache_size = accountCacheSize(DEFAULT_CACHE_CAPACITY);
+    AccountCache *cache = (AccountCache *)mmap(NULL, cache_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || cache == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    // Keep the per-transaction messages out of the report
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+
+    const char *modeNames[] = {"files", "cached"};
+    for (int m = 0; m < 2; m++) {
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        if (m == 1) {
+            initializeAccountCache(cache, DEFAULT_CACHE_CAPACITY, DEFAULT_CACHE_FLUSH);
+            monitor->cache = cache;
+        }
+        freopen("/dev/null", "w", stdout);
+
+        char id[ACCOUNT_ID_LENGTH], other[ACCOUNT_ID_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            createAccount(monitor, id, id, 1000 * MONEY_SCALE);
+        }
+
+        unsigned int seed = 12345;
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long t = 0; t < transactions; t++) {
+            long a = (rand_r(&seed) % 100 < hotPercent) ? rand_r(&seed) % hotAccounts : rand_r(&seed) % accounts;
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            switch (t % 4) {
+                case 0: deposit(monitor, id, 5 * MONEY_SCALE); break;
+                case 1: withdraw(monitor, id, 3 * MONEY_SCALE); break;
+                case 2: inquiry(monitor, id); break;
+                default:
+                    snprintf(other, sizeof(other), "Acct%d", (int)(rand_r(&seed) % hotAccounts));
+                    transfer(monitor, id, 1 * MONEY_SCALE, other);
+                    break;
+            }
+        }
+        monitorFlushCache(monitor);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        double seconds = elapsedSeconds(start, end);
+        cout << "cache-skew mode=" << modeNames[m] << " accounts=" << accounts << " transactions=" << transactions
+             << " hot_percent=" << hotPercent << " seconds=" << seconds
+             << " transactions_per_sec=" << (long)(transactions / seconds);
+        if (m == 1) {
+            cout << " hit_rate=" << 100.0 * cache->hits / (cache->hits + cache->misses)
+                 << " writebacks=" << cache->writebacks << " batches=" << cache->batches;
+        }
+        cout << endl;
+
+        for (long a = 0; a < accounts; a++) {
+            char filename[30];
+            snprintf(filename, sizeof(filename), "Acct%ld.txt", a);
+            unlink(filename);
+        }
+        monitor->cache = NULL;
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+    }
+
+    close(savedStdout);
+    unlink("transactions.log");
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    munmap(cache, cache_size);
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return 0;
+}
+
+/**
+ * @brief Measures balance formatting and parsing: printf/atof on doubles versus integer Money.
+ *
+ * Each round trip formats a balance the way it is written to an account
+ * file and parses it back. Options: --values N.
+ *
+ * @return 0 on success, or 1 if the two paths disagree.
+ */
+static int benchMoneyFormat(int argc, char *argv[]) {
+    long values = longOption(argc, argv, "--values", 5000000);
+    char buffer[MONEY_TEXT_LENGTH];
+    long checksum[2] = {0, 0};
+
+    const char *modeNames[] = {"double-printf-atof", "money-integer"};
+    for (int m = 0; m < 2; m++) {
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < values; i++) {
+            Money cents = (i * 7919) % 100000000;
+            if (m == 0) {
+                int length = snprintf(buffer, sizeof(buffer), "%.2lf", cents / 100.0);
+                checksum[m] += length + llround(atof(buffer) * 100.0);
+            } else {
+                int length = formatMoney(cents, buffer);
+                Money parsed = 0;
+                parseMoney(buffer, length, &parsed);
+                checksum[m] += length + parsed;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double seconds = elapsedSeconds(start, end);
+        cout << "money-format mode=" << modeNames[m] << " values=" << values << " seconds=" << seconds
+             << " round_trips_per_sec=" << (long)(values / seconds) << endl;
+    }
+    return (checksum[0] == checksum[1]) ? 0 : 1;
+}
+
+/**
+ * @brief Measures bursts of deposits applied one call at a time versus with applyBatch.
+ *
+ * Creates --accounts N accounts (1 by default: a burst to a single
+ * account) and deposits --transactions N times into them, once through
+ * deposit() and once through applyBatch in batches of --batch N. Uses the
+ * files backend with the account cache, in a scratch directory that is
+ * removed afterwards.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchBatchApply(int argc, char *argv[]) {
+    long accounts = longOption(argc, argv, "--accounts", 1);
+    long transactions = longOption(argc, argv, "--transactions", 200000);
+    int batchSize = (int)longOption(argc, argv, "--batch", MAX_BATCH_SIZE);
+    const char *directory = "benchmark_batch";
+    if (accounts < 1 || batchSize < 1) {
+        cerr << "Error: --accounts and --batch must be positive" << endl;
+        return 1;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t cache_size = accountCacheSize(DEFAULT_CACHE_CAPACITY);
+    AccountCache *cache = (AccountCache *)mmap(NULL, cache_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || cache == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    vector<Transaction> burst(transactions);
+    for (long t = 0; t < transactions; t++) {
+        burst[t].command = CMD_DEPOSIT;
+        snprintf(burst[t].account_id, sizeof(burst[t].account_id), "Acct%d", (int)(t % accounts));
+        burst[t].recipient_account_id[0] = '\0';
+        burst[t].amount = 1 * MONEY_SCALE;
+    }
+
+    // Keep the per-transaction messages out of the report
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+
+    const char *modeNames[] = {"per-call", "batch"};
+    Money finalBalance[2] = {0, 0};
+    for (int m = 0; m < 2; m++) {
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        initializeAccountCache(cache, DEFAULT_CACHE_CAPACITY, DEFAULT_CACHE_FLUSH);
+        monitor->cache = cache;
+        freopen("/dev/null", "w", stdout);
+
+        char id[ACCOUNT_ID_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            createAccount(monitor, id, id, 0);
+        }
+
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (m == 0) {
+            for (long t = 0; t < transactions; t++) {
+                deposit(monitor, burst[t].account_id, burst[t].amount);
+            }
+        } else {
+            for (long t = 0; t < transactions; t += batchSize) {
+                int count = (transactions - t < batchSize) ? (int)(transactions - t) : batchSize;
+                applyBatch(monitor, &(burst[t]), count);
+            }
+        }
+        monitorFlushCache(monitor);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        finalBalance[m] = monitorGetBalance(monitor, "Acct0");
+
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        double seconds = elapsedSeconds(start, end);
+        cout << "batch-apply mode=" << modeNames[m] << " accounts=" << accounts << " transactions=" << transactions
+             << " batch=" << ((m == 0) ? 1 : batchSize) << " seconds=" << seconds
+             << " transactions_per_sec=" << (long)(transactions / seconds)
+             << " log_records=" << shm_ptr->transaction_count - accounts << endl;
+
+        for (long a = 0; a < accounts; a++) {
+            char filename[30];
+            snprintf(filename, sizeof(filename), "Acct%ld.txt", a);
+            unlink(filename);
+        }
+        monitor->cache = NULL;
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+    }
+
+    close(savedStdout);
+    unlink("transactions.log");
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    munmap(cache, cache_size);
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return (finalBalance[0] == finalBalance[1]) ? 0 : 1;
+}
+
+/**
+ * @brief Compares printing transaction messages from every process with buffered event output.
+ *
+ * --processes N processes each make --transactions N deposits into their
+ * own account while standard output is a pipe drained by another process,
+ * as when the driver's output is piped on. Modes:
+ *   printf    each process prints its messages, line-buffered (as before)
+ *   buffered  messages go to per-process buffers written in bulk by a writer thread
+ *   silent    messages are dropped (--verbosity silent), for the floor
+ * Runs in a scratch directory that is removed afterwards.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchEventOutput(int argc, char *argv[]) {
+    int processes = (int)longOption(argc, argv, "--processes", 4);
+    long transactions = longOption(argc, argv, "--transactions", 50000);
+    const char *directory = "benchmark_events";
+    if (processes < 1 || processes >= EVENT_PRODUCERS || transactions < 1) {
+        cerr << "Error: --processes must be between 1 and " << EVENT_PRODUCERS - 1
+             << " and --transactions positive" << endl;
+        return 1;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t cache_size = accountCacheSize(DEFAULT_CACHE_CAPACITY);
+    AccountCache *cache = (AccountCache *)mmap(NULL, cache_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    EventOutput *output = (EventOutput *)mmap(NULL, sizeof(EventOutput), PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || cache == MAP_FAILED || output == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    const char *modeNames[] = {"printf", "buffered", "silent"};
+    for (int m = 0; m < 3; m++) {
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        initializeAccountCache(cache, DEFAULT_CACHE_CAPACITY, DEFAULT_CACHE_FLUSH);
+        monitor->cache = cache;
+        freopen("/dev/null", "w", stdout);
+        char id[ACCOUNT_ID_LENGTH];
+        for (int p = 0; p < processes; p++) {
+            snprintf(id, sizeof(id), "Acct%d", p);
+            createAccount(monitor, id, id, 0);
+        }
+        fflush(stdout);
+
+        // Standard output becomes a pipe that another process reads to the end
+        int fds[2];
+        if (pipe(fds) == -1) {
+            perror("Benchmark pipe");
+            return 1;
+        }
+        pid_t reader = fork();
+        if (reader == 0) {
+            close(fds[1]);
+            char buffer[65536];
+            while (read(fds[0], buffer, sizeof(buffer)) > 0) {
+            }
+            _exit(0);
+        }
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (m > 0) {
+            initializeEventOutput(output, (m == 1) ? OUTPUT_FULL : OUTPUT_SILENT, STDOUT_FILENO);
+            if (m == 1 && startEventWriter(output) != 0) {
+                return 1;
+            }
+            monitor->output = output;
+        }
+        for (int p = 0; p < processes; p++) {
+            if (fork() == 0) {
+                setvbuf(stdout, NULL, _IOLBF, 0);
+                selectEventProducer(p + 1);
+                snprintf(id, sizeof(id), "Acct%d", p);
+                for (long t = 0; t < transactions; t++) {
+                    deposit(monitor, id, 1 * MONEY_SCALE);
+                }
+                fflush(stdout);
+                _exit(0);
+            }
+        }
+        for (int p = 0; p < processes; p++) {
+            wait(NULL);
+        }
+        long writes = 0;
+        if (m == 1) {
+            stopEventWriter(output);
+            writes = output->writes;
+        }
+        monitor->output = NULL;
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        waitpid(reader, NULL, 0);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        long total = processes * transactions;
+        double seconds = elapsedSeconds(start, end);
+        cout << "event-output mode=" << modeNames[m] << " processes=" << processes << " transactions=" << total
+             << " seconds=" << seconds << " transactions_per_sec=" << (long)(total / seconds);
+        if (m == 1) {
+            cout << " messages=" << eventCount(output) << " writes=" << writes;
+        }
+        cout << endl;
+
+        for (int p = 0; p < processes; p++) {
+            char path[ACCOUNT_PATH_LENGTH];
+            snprintf(id, sizeof(id), "Acct%d", p);
+            accountFilePath(NULL, id, path, sizeof(path));
+            unlink(path);
+        }
+        monitor->cache = NULL;
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+        unlink("transactions.log");
+    }
+    close(savedStdout);
+
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    munmap(output, sizeof(EventOutput));
+    munmap(cache, cache_size);
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return 0;
+}
+
+// One configuration of the file-io benchmark
+struct FileIoMode {
+    const char *name;
+    bool asyncIo;
+    bool cached;
+};
+
+/**
+ * @brief Resets the monitor for one file-io run and creates its accounts.
+ */
+static void fileIoSetup(Monitor *monitor, SharedMemorySegment *shm_ptr, AccountCache *cache,
+                        const FileIoMode &mode, long accounts) {
+    initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+    initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+    monitor->async_io = mode.asyncIo;
+    if (mode.cached) {
+        initializeAccountCache(cache, DEFAULT_CACHE_CAPACITY, DEFAULT_CACHE_FLUSH);
+        monitor->cache = cache;
+    }
+    char id[ACCOUNT_ID_LENGTH];
+    for (long a = 0; a < accounts; a++) {
+        snprintf(id, sizeof(id), "Acct%d", (int)a);
+        createAccount(monitor, id, id, 1000 * MONEY_SCALE);
+    }
+}
+
+/**
+ * @brief Applies the file-io workload in batches and writes the cache back.
+ */
+static void fileIoRun(Monitor *monitor, const vector<Transaction> &workload, int batchSize) {
+    for (size_t t = 0; t < workload.size(); t += batchSize) {
+        int count = (workload.size() - t < (size_t)batchSize) ? (int)(workload.size() - t) : batchSize;
+        applyBatch(monitor, &(workload[t]), count);
+    }
+    monitorFlushCache(monitor);
+}
+
+/**
+ * @brief Removes the account files and log of one file-io run.
+ */
+static void fileIoCleanup(Monitor *monitor, SharedMemorySegment *shm_ptr, long accounts) {
+    for (long a = 0; a < accounts; a++) {
+        char filename[30];
+        snprintf(filename, sizeof(filename), "Acct%ld.txt", a);
+        unlink(filename);
+    }
+    unlink("transactions.log");
+    monitor->cache = NULL;
+    destroyMonitor(monitor);
+    destroyTransactionLog(shm_ptr);
+}
+
+/**
+ * @brief Counts the system calls a forked child makes while running the file-io workload.
+ *
+ * The child stops itself with SIGSTOP before and after the workload; only
+ * the calls between those two stops are counted, so account setup and
+ * io_uring setup are left out.
+ *
+ * @return Number of system calls, or -1 if the child could not be traced.
+ */
+static long countFileIoSyscalls(Monitor *monitor, SharedMemorySegment *shm_ptr, AccountCache *cache,
+                                const FileIoMode &mode, long accounts,
+                                const vector<Transaction> &workload, int batchSize) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        freopen("/dev/null", "w", stdout);
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) == -1) {
+            _exit(1);
+        }
+        raise(SIGSTOP);
+        fileIoSetup(monitor, shm_ptr, cache, mode, accounts);
+        fflush(stdout);
+        raise(SIGSTOP);
+        fileIoRun(monitor, workload, batchSize);
+        fflush(stdout);
+        raise(SIGSTOP);
+        fileIoCleanup(monitor, shm_ptr, accounts);
+        _exit(0);
+    }
+    if (pid < 0) {
+        return -1;
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status)) {
+        return -1; // Exited without being traced
+    }
+    ptrace(PTRACE_SETOPTIONS, pid, NULL, (void *)PTRACE_O_TRACESYSGOOD);
+
+    int marks = 0;
+    long stops = 0;
+    int signal = 0;
+    while (ptrace(PTRACE_SYSCALL, pid, NULL, (void *)(long)signal) == 0 && waitpid(pid, &status, 0) == pid) {
+        signal = 0;
+        if (!WIFSTOPPED(status)) {
+            break;
+        }
+        if (WSTOPSIG(status) == (SIGTRAP | 0x80)) {
+            stops += (marks == 1);
+        } else if (WSTOPSIG(status) == SIGSTOP) {
+            marks++;
+        } else {
+            signal = WSTOPSIG(status);
+        }
+    }
+    waitpid(pid, &status, 0);
+    return (marks >= 2) ? stops / 2 : -1; // An entry and an exit stop per call
+}
+
+/**
+ * @brief Compares synchronous account file I/O with io_uring submissions.
+ *
+ * Creates --accounts N account files and applies --transactions N random
+ * deposits, withdrawals, inquiries and transfers through applyBatch in
+ * batches of --batch N, with --io sync and uring, each without and with the
+ * account cache. Reports throughput and, from a second run traced with
+ * ptrace, the system calls per transaction. Runs in a scratch directory
+ * that is removed afterwards.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchFileIo(int argc, char *argv[]) {
+    long accounts = longOption(argc, argv, "--accounts", 1000);
+    long transactions = longOption(argc, argv, "--transactions", 50000);
+    int batchSize = (int)longOption(argc, argv, "--batch", 32);
+    const char *directory = "benchmark_file_io";
+    if (accounts < 1 || transactions < 1 || batchSize < 1 || batchSize > MAX_BATCH_SIZE) {
+        cerr << "Error: --accounts and --transactions must be positive and --batch between 1 and "
+             << MAX_BATCH_SIZE << endl;
+        return 1;
+    }
+    bool uring = asyncIoAvailable();
+    if (!uring) {
+        cerr << "io_uring is not available; only the sync modes will run" << endl;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t cache_size = accountCacheSize(DEFAULT_CACHE_CAPACITY);
+    AccountCache *cache = (AccountCache *)mmap(NULL, cache_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || cache == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    vector<Transaction> workload(transactions);
+    unsigned int seed = 12345;
+    for (long t = 0; t < transactions; t++) {
+        Transaction *transaction = &(workload[t]);
+        static const CommandType commands[] = {CMD_DEPOSIT, CMD_WITHDRAW, CMD_INQUIRY, CMD_TRANSFER};
+        transaction->command = commands[t % 4];
+        snprintf(transaction->account_id, sizeof(transaction->account_id), "Acct%d", (int)(rand_r(&seed) % accounts));
+        snprintf(transaction->recipient_account_id, sizeof(transaction->recipient_account_id), "Acct%d",
+                 (int)(rand_r(&seed) % accounts));
+        transaction->amount = (1 + rand_r(&seed) % 5) * MONEY_SCALE;
+    }
+
+    // Keep the per-transaction messages out of the report
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+
+    const FileIoMode modes[] = {{"sync", false, false}, {"uring", true, false},
+                                {"sync-cached", false, true}, {"uring-cached", true, true}};
+    for (const FileIoMode &mode : modes) {
+        if (mode.asyncIo && !uring) {
+            continue;
+        }
+        freopen("/dev/null", "w", stdout);
+        fileIoSetup(monitor, shm_ptr, cache, mode, accounts);
+        long submissionsBefore = asyncIoSubmissions();
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        fileIoRun(monitor, workload, batchSize);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long submissions = asyncIoSubmissions() - submissionsBefore;
+        fileIoCleanup(monitor, shm_ptr, accounts);
+
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        long syscalls = countFileIoSyscalls(monitor, shm_ptr, cache, mode, accounts, workload, batchSize);
+        double seconds = elapsedSeconds(start, end);
+        cout << "file-io mode=" << mode.name << " accounts=" << accounts << " transactions=" << transactions
+             << " batch=" << batchSize << " seconds=" << seconds
+             << " transactions_per_sec=" << (long)(transactions / seconds)
+             << " uring_submissions=" << submissions << " syscalls_per_transaction=";
+        if (syscalls >= 0) {
+            cout << (double)syscalls / transactions << endl;
+        } else {
+            cout << "n/a" << endl;
+        }
+    }
+
+    close(savedStdout);
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    munmap(cache, cache_size);
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return 0;
+}
+
+/**
+ * @brief Reads the workload options (--accounts, --transactions, --mix, --zipf, --fail-percent, --seed).
+ *
+ * @return false if an option is out of range.
+ */
+static bool workloadOptions(int argc, char *argv[], WorkloadConfig *config) {
+    defaultWorkloadConfig(config);
+    config->accounts = longOption(argc, argv, "--accounts", config->accounts);
+    config->transactions = longOption(argc, argv, "--transactions", config->transactions);
+    const char *zipf = stringOption(argc, argv, "--zipf", NULL);
+    if (zipf != NULL) {
+        config->zipf = atof(zipf);
+    }
+    config->fail_percent = (int)longOption(argc, argv, "--fail-percent", 0);
+    config->seed = (unsigned int)longOption(argc, argv, "--seed", DEFAULT_WORKLOAD_SEED);
+
+    const char *mix = stringOption(argc, argv, "--mix", NULL);
+    if (mix != NULL && !parseWorkloadMix(mix, config)) {
+        cerr << "Error: --mix takes six weights: create,deposit,withdraw,inquiry,transfer,close" << endl;
+        return false;
+    }
+    if (config->accounts < 1 || config->transactions < 0 || config->zipf < 0 ||
+        config->fail_percent < 0 || config->fail_percent > 100) {
+        cerr << "Error: invalid workload options" << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a generated transaction file for the driver.
+ *
+ * Options: --output FILE plus the workload options.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchGenerate(int argc, char *argv[]) {
+    WorkloadConfig config;
+    if (!workloadOptions(argc, argv, &config)) {
+        return 1;
+    }
+    const char *outputPath = stringOption(argc, argv, "--output", "workload.txt");
+    long lines = generateWorkload(&config, outputPath);
+    if (lines < 0) {
+        perror("Workload file");
+        return 1;
+    }
+    cout << "generate output=" << outputPath << " lines=" << lines << " accounts=" << config.accounts
+         << " zipf=" << config.zipf << " fail_percent=" << config.fail_percent << " seed=" << config.seed << endl;
+    return 0;
+}
+
+/**
+ * @brief Returns the full path of a program found on PATH, or an empty string.
+ */
+static string findOnPath(const char *program) {
+    const char *path = getenv("PATH");
+    if (path == NULL) {
+        return "";
+    }
+    stringstream directories(path);
+    string directory;
+    while (getline(directories, directory, ':')) {
+        string candidate = directory + "/" + program;
+        if (access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Removes everything the driver left in the scratch directory except the workload.
+ */
+static void removeDriverFiles(const char *workloadPath) {
+    DIR *directory = opendir(".");
+    if (directory == NULL) {
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] != '.' && strcmp(entry->d_name, workloadPath) != 0) {
+            unlink(entry->d_name);
+        }
+    }
+    closedir(directory);
+}
+
+/**
+ * @brief Runs a program with stdout discarded and waits for it.
+ *
+ * @return true if it exited with status 0.
+ */
+static bool runSilently(const vector<const char *> &args) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+        execv(args[0], (char *const *)args.data());
+        perror(args[0]);
+        _exit(127);
+    }
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid) {
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * @brief Counts the system calls in an "strace -f -o" trace.
+ *
+ * Every call is one line; continuation lines ("<... resumed>"), signals
+ * ("---") and exits ("+++") are not counted.
+ */
+static long countTracedSyscalls(const char *tracePath) {
+    ifstream trace(tracePath);
+    string line;
+    long calls = 0;
+    while (getline(trace, line)) {
+        size_t start = line.find_first_not_of("0123456789 ");
+        if (start == string::npos) {
+            continue;
+        }
+        if (line.compare(start, 3, "<..") != 0 && line.compare(start, 3, "---") != 0 &&
+            line.compare(start, 3, "+++") != 0) {
+            calls++;
+        }
+    }
+    return calls;
+}
+
+/**
+ * @brief Returns the CPU seconds in a timeval.
+ */
+static double timevalSeconds(const timeval &tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * @brief Generates a workload, runs the driver on it end to end and reports the results.
+ *
+ * Each of --repeat N runs starts from an empty scratch directory and runs
+ * --driver PATH with --workers N, --store files|mapped and --metrics-json,
+ * so the report carries the driver's own per-phase latency percentiles.
+ * When strace is installed, one more run counts the system calls per
+ * transaction. Prints one line per run and, with --json FILE, writes the
+ * workload, every run and the metrics as JSON for tracking across changes.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchEndToEnd(int argc, char *argv[]) {
+    WorkloadConfig config;
+    if (!workloadOptions(argc, argv, &config)) {
+        return 1;
+    }
+    long workers = longOption(argc, argv, "--workers", 8);
+    int repeat = (int)longOption(argc, argv, "--repeat", 3);
+    const char *store = stringOption(argc, argv, "--store", "files");
+    const char *jsonPath = stringOption(argc, argv, "--json", NULL);
+    const char *directory = "benchmark_end_to_end";
+    const char *workloadPath = "workload.in";
+
+    char driverPath[PATH_MAX];
+    if (realpath(stringOption(argc, argv, "--driver", "./driver"), driverPath) == NULL) {
+        perror("Driver");
+        return 1;
+    }
+    char workersText[16];
+    snprintf(workersText, sizeof(workersText), "%ld", workers);
+
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    removeDriverFiles("");
+    long lines = generateWorkload(&config, workloadPath);
+    if (lines < 0) {
+        perror("Workload file");
+        return 1;
+    }
+
+    vector<const char *> args = {driverPath, "--workers", workersText, "--store", store,
+                                 "--metrics-json", "metrics.json", workloadPath, NULL};
+    stringstream runsJson;
+    bool ok = true;
+    for (int r = 0; r < repeat && ok; r++) {
+        removeDriverFiles(workloadPath);
+        rusage before, after;
+        getrusage(RUSAGE_CHILDREN, &before);
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ok = runSilently(args);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        getrusage(RUSAGE_CHILDREN, &after);
+        if (!ok) {
+            cerr << "Error: driver failed" << endl;
+            break;
+        }
+
+        double seconds = elapsedSeconds(start, end);
+        double userSeconds = timevalSeconds(after.ru_utime) - timevalSeconds(before.ru_utime);
+        double systemSeconds = timevalSeconds(after.ru_stime) - timevalSeconds(before.ru_stime);
+        long switches = after.ru_nvcsw - before.ru_nvcsw;
+        cout << "end-to-end run=" << r + 1 << " workers=" << workers << " store=" << store << " lines=" << lines
+             << " seconds=" << seconds << " transactions_per_sec=" << (long)(lines / seconds)
+             << " user_sec=" << userSeconds << " sys_sec=" << systemSeconds
+             << " voluntary_switches=" << switches << endl;
+
+        // Per-type totals from the driver's metrics, e.g. {"type": "DEPOSIT", "phase": "total", ...}
+        ifstream metricsFile("metrics.json");
+        stringstream metrics;
+        string line;
+        while (getline(metricsFile, line)) {
+            metrics << line << "\n    ";
+            char type[16], phase[16];
+            long count, mean, p50, p90, p99;
+            if (sscanf(line.c_str(), " {\"type\": \"%15[^\"]\", \"phase\": \"%15[^\"]\", \"count\": %ld, \"mean_ns\": %ld, "
+                       "\"p50_ns\": %ld, \"p90_ns\": %ld, \"p99_ns\": %ld", type, phase, &count, &mean, &p50, &p90, &p99) == 7 &&
+                strcmp(phase, "total") == 0) {
+                cout << "end-to-end run=" << r + 1 << " type=" << type << " count=" << count
+                     << " p50_us=" << p50 / 1e3 << " p90_us=" << p90 / 1e3 << " p99_us=" << p99 / 1e3 << endl;
+            }
+        }
+
+        runsJson << (r > 0 ? "," : "") << "\n    {\"seconds\": " << seconds
+                 << ", \"transactions_per_sec\": " << (long)(lines / seconds)
+                 << ", \"user_seconds\": " << userSeconds << ", \"system_seconds\": " << systemSeconds
+                 << ", \"voluntary_switches\": " << switches
+                 << ", \"metrics\": " << metrics.str().substr(0, metrics.str().find_last_not_of(" \n") + 1) << "}";
+    }
+
+    long syscalls = -1;
+    string stracePath = findOnPath("strace");
+    if (ok && !stracePath.empty()) {
+        removeDriverFiles(workloadPath);
+        vector<const char *> traced = {stracePath.c_str(), "-f", "-q", "-o", "strace.out"};
+        traced.insert(traced.end(), args.begin(), args.end());
+        if (runSilently(traced)) {
+            syscalls = countTracedSyscalls("strace.out");
+        }
+    }
+    if (syscalls >= 0) {
+        cout << "end-to-end syscalls=" << syscalls << " syscalls_per_transaction=" << (double)syscalls / lines << endl;
+    } else if (ok) {
+        cout << "end-to-end syscalls=unavailable (strace not found)" << endl;
+    }
+
+    removeDriverFiles("");
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    if (!ok) {
+        return 1;
+    }
+
+    if (jsonPath != NULL) {
+        ofstream json(jsonPath);
+        json << "{\n  \"benchmark\": \"end-to-end\",\n  \"timestamp\": " << (long)time(NULL)
+             << ",\n  \"workload\": {\"accounts\": " << config.accounts << ", \"transactions\": " << config.transactions
+             << ", \"lines\": " << lines << ", \"mix\": [";
+        for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+            json << (type > 0 ? ", " : "") << config.mix[type];
+        }
+        json << "], \"zipf\": " << config.zipf << ", \"fail_percent\": " << config.fail_percent
+             << ", \"seed\": " << config.seed << "},\n  \"workers\": " << workers
+             << ",\n  \"store\": \"" << store << "\",\n  \"runs\": [" << runsJson.str() << "\n  ],\n  \"syscalls\": ";
+        if (syscalls >= 0) {
+            json << syscalls << ",\n  \"syscalls_per_transaction\": " << (double)syscalls / lines;
+        } else {
+            json << "null,\n  \"syscalls_per_transaction\": null";
+        }
+        json << "\n}\n";
+        if (!json) {
+            cerr << "Error writing results file: " << jsonPath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Measures how the driver's throughput scales with the number of shards.
+ *
+ * Generates one workload, then runs --driver PATH on it from an empty
+ * scratch directory with --shards N and, for comparison, --workers N, for
+ * N = 1, 2, 4, ... up to --max-shards (default: the online CPUs), with
+ * --verbosity silent so the output does not dominate. Each line reports
+ * the online CPUs too: counts beyond them share cores, so they show the
+ * cost of oversubscription rather than scaling.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchShardScaling(int argc, char *argv[]) {
+    WorkloadConfig config;
+    if (!workloadOptions(argc, argv, &config)) {
+        return 1;
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long maxShards = longOption(argc, argv, "--max-shards", cpus);
+    if (maxShards < 1 || maxShards > 64) {
+        cerr << "Error: --max-shards must be between 1 and 64" << endl;
+        return 1;
+    }
+    const char *directory = "benchmark_shards";
+    const char *workloadPath = "workload.in";
+
+    char driverPath[PATH_MAX];
+    if (realpath(stringOption(argc, argv, "--driver", "./driver"), driverPath) == NULL) {
+        perror("Driver");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    removeDriverFiles("");
+    long lines = generateWorkload(&config, workloadPath);
+    if (lines < 0) {
+        perror("Workload file");
+        return 1;
+    }
+
+    const char *modes[] = {"--shards", "--workers"};
+    bool ok = true;
+    // 1, 2, 4, ... and then maxShards itself
+    for (long n = 1; n <= maxShards && ok; n = (n < maxShards && n * 2 > maxShards) ? maxShards : n * 2) {
+        char countText[16];
+        snprintf(countText, sizeof(countText), "%ld", n);
+        for (int m = 0; m < 2 && ok; m++) {
+            removeDriverFiles(workloadPath);
+            vector<const char *> args = {driverPath, modes[m], countText, "--verbosity", "silent", workloadPath, NULL};
+            timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            ok = runSilently(args);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            if (!ok) {
+                cerr << "Error: driver failed" << endl;
+                break;
+            }
+            double seconds = elapsedSeconds(start, end);
+            cout << "shard-scaling mode=" << (modes[m] + 2) << " count=" << n << " cpus=" << cpus << " lines=" << lines
+                 << " seconds=" << seconds << " transactions_per_sec=" << (long)(lines / seconds) << endl;
+        }
+    }
+
+    removeDriverFiles("");
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Compares account lookups with the plain file layout, the membership filter and sharded directories.
+ *
+ * Creates --accounts N account files, then times --lookups N balance reads
+ * of which --missing-percent P are of accounts that do not exist, with the
+ * cache off so every lookup goes to the account directory:
+ *   flat            "<id>.txt" files, every lookup opens its file
+ *   flat-filter     the filter answers most missing accounts
+ *   sharded-filter  --shards N subdirectories plus the filter
+ * Runs in a scratch directory that is removed afterwards.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchAccountLookup(int argc, char *argv[]) {
+    long accounts = longOption(argc, argv, "--accounts", 20000);
+    long lookups = longOption(argc, argv, "--lookups", 200000);
+    long missingPercent = longOption(argc, argv, "--missing-percent", 50);
+    int shards = (int)longOption(argc, argv, "--shards", 64);
+    const char *scratch = "benchmark_directory";
+    if (accounts < 1 || lookups < 1 || shards < 1 || shards > MAX_ACCOUNT_SHARDS || (shards & (shards - 1)) != 0) {
+        cerr << "Error: --accounts and --lookups must be positive and --shards a power of two up to "
+             << MAX_ACCOUNT_SHARDS << endl;
+        return 1;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t directory_size = accountDirectorySize(DEFAULT_ACCOUNT_FILTER);
+    AccountDirectory *directory = (AccountDirectory *)mmap(NULL, directory_size, PROT_READ | PROT_WRITE,
+                                                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || directory == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(scratch, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(scratch) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    const char *modeNames[] = {"flat", "flat-filter", "sharded-filter"};
+    for (int m = 0; m < 3; m++) {
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        if (openAccountDirectory(directory, (m == 2) ? shards : 0, (m > 0) ? DEFAULT_ACCOUNT_FILTER : 0) != 0) {
+            return 1;
+        }
+        monitor->directory = directory;
+        freopen("/dev/null", "w", stdout);
+
+        char id[ACCOUNT_ID_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            createAccount(monitor, id, id, 1000 * MONEY_SCALE);
+        }
+
+        unsigned int seed = 777;
+        long found = 0;
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < lookups; i++) {
+            long a = rand_r(&seed) % accounts;
+            snprintf(id, sizeof(id), (rand_r(&seed) % 100 < missingPercent) ? "Gone%d" : "Acct%d", (int)a);
+            found += (monitorGetBalance(monitor, id) >= 0);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        double seconds = elapsedSeconds(start, end);
+        cout << "account-lookup mode=" << modeNames[m] << " accounts=" << accounts << " lookups=" << lookups
+             << " found=" << found << " seconds=" << seconds << " lookups_per_sec=" << (long)(lookups / seconds)
+             << " filter_negatives=" << directory->filter_negatives
+             << " false_positives=" << directory->filter_false_positives << endl;
+
+        char path[ACCOUNT_PATH_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            accountFilePath(directory, id, path, sizeof(path));
+            unlink(path);
+        }
+        for (int shard = 0; m == 2 && shard < shards; shard++) {
+            snprintf(path, sizeof(path), "%s/%02x", ACCOUNT_ROOT, shard);
+            rmdir(path);
+        }
+        rmdir(ACCOUNT_ROOT);
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+    }
+    close(savedStdout);
+
+    unlink("transactions.log");
+    if (chdir("..") == 0) {
+        rmdir(scratch);
+    }
+    munmap(directory, directory_size);
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return 0;
+}
+
+/**
+ * @brief Measures startup against the shared segment: initializing it versus reattaching a kept one.
+ *
+ * Each of --rounds N rounds creates the segment with a --lock-stripes N
+ * lock table, detaches keeping it, and attaches again. Then a child process
+ * dies inside the monitor holding an account's lane and lock stripe, and
+ * the time the parent's next transaction on that account needs to get in
+ * is reported.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchSegmentAttach(int argc, char *argv[]) {
+    long requested = longOption(argc, argv, "--lock-stripes", 1 << 20);
+    int rounds = (int)longOption(argc, argv, "--rounds", 5);
+    if (requested < 1 || requested > (1 << 24) || rounds < 1) {
+        cerr << "Error: --lock-stripes must be between 1 and " << (1 << 24) << " and --rounds positive" << endl;
+        return 1;
+    }
+    int lockStripes = 1;
+    while (lockStripes < requested) {
+        lockStripes <<= 1;
+    }
+    key_t key = ftok(".", 'b');
+
+    double initSeconds = 0, attachSeconds = 0;
+    SharedSegment segment;
+    for (int r = 0; r < rounds; r++) {
+        timespec start, middle, reattach, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (openSharedSegment(&segment, key, lockStripes, DEFAULT_LOG_CAPACITY, "benchmark_segment.log") != 0) {
+            return 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &middle);
+        closeSharedSegment(&segment, true);
+        clock_gettime(CLOCK_MONOTONIC, &reattach);
+        if (openSharedSegment(&segment, key, lockStripes, DEFAULT_LOG_CAPACITY, "benchmark_segment.log") != 0) {
+            return 1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        if (segment.reused) {
+            initSeconds += elapsedSeconds(start, middle);
+            attachSeconds += elapsedSeconds(reattach, end);
+        }
+        closeSharedSegment(&segment, r == rounds - 1);
+    }
+    cout << "segment-attach lock_stripes=" << lockStripes << " bytes=" << sharedSegmentSize(lockStripes, DEFAULT_LOG_CAPACITY)
+         << " init_ms=" << initSeconds / rounds * 1000 << " attach_ms=" << attachSeconds / rounds * 1000 << endl;
+
+    // A process that dies inside the monitor must not wedge the account
+    if (openSharedSegment(&segment, key, lockStripes, DEFAULT_LOG_CAPACITY, "benchmark_segment.log") != 0) {
+        return 1;
+    }
+    Monitor *monitor = segment.monitor;
+    const char *id = "Crash";
+    int index = getAccountMutexIndex(monitor, id);
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        freopen("/dev/null", "w", stdout);
+        enterMonitor(monitor, id);
+        lockAccountMutex(monitor, index, id);
+        _exit(1);
+    }
+    waitpid(child, NULL, 0);
+
+    int savedStdout = dup(STDOUT_FILENO);
+    fflush(stdout);
+    freopen("/dev/null", "w", stdout);
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    enterMonitor(monitor, id);
+    lockAccountMutex(monitor, index, id);
+    unlockAccountMutex(monitor, index);
+    exitMonitor(monitor);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    cout << "segment-attach crash_recovery_ms=" << elapsedSeconds(start, end) * 1000 << endl;
+
+    closeSharedSegment(&segment, false);
+    unlink("benchmark_segment.log");
+    return 0;
+}
+
+/**
+ * @brief Compares account statements served from the history index with a scan of the whole log.
+ *
+ * Fills a log with transactions spread over many accounts (older ones
+ * spilled to disk once the ring is full), then asks for the last records
+ * of random accounts both ways and checks they agree.
+ * Options: --accounts N, --records N, --capacity N (ring size), --statements N, --last N.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchStatement(int argc, char *argv[]) {
+    long accounts = longOption(argc, argv, "--accounts", 1000);
+    long records = longOption(argc, argv, "--records", 1000000);
+    long capacity = longOption(argc, argv, "--capacity", DEFAULT_LOG_CAPACITY);
+    long statements = longOption(argc, argv, "--statements", 20);
+    long last = longOption(argc, argv, "--last", DEFAULT_STATEMENT_RECORDS);
+    const char *spillPath = "benchmark_transactions.log";
+    if (accounts < 1 || last < 1 || last > MAX_STATEMENT_RECORDS) {
+        cerr << "--accounts must be at least 1 and --last between 1 and " << MAX_STATEMENT_RECORDS << endl;
+        return 1;
+    }
+
+    size_t size = transactionLogSize(capacity);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shm_ptr == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    initializeTransactionLog(shm_ptr, capacity, spillPath);
+
+    TransactionRecord record;
+    memset(&record, 0, sizeof(record));
+    record.transaction_type = TXN_DEPOSIT;
+    record.status = TXN_SUCCESS;
+    record.reason = REASON_NONE;
+    record.amount = 100;
+    unsigned int seed = 4242;
+    for (long i = 0; i < records; i++) {
+        snprintf(record.account_id, sizeof(record.account_id), "Acct%d", (int)(rand_r(&seed) % accounts));
+        record.timestamp_ns = i;
+        appendTransaction(shm_ptr, &record);
+    }
+
+    StatementQuery query;
+    query.limit = last;
+    query.from_ns = 0;
+    query.to_ns = INT64_MAX;
+    TransactionRecord *indexed = new TransactionRecord[last];
+    TransactionRecord *scanned = new TransactionRecord[last];
+    const char *modeNames[] = {"indexed", "scan"};
+    long mismatches = 0;
+    for (int m = 0; m < 2; m++) {
+        unsigned int querySeed = 99;
+        long found = 0;
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long q = 0; q < statements; q++) {
+            char id[ACCOUNT_ID_LENGTH];
+            snprintf(id, sizeof(id), "Acct%d", (int)(rand_r(&querySeed) % accounts));
+            found += (m == 0) ? accountHistory(shm_ptr, id, &query, indexed)
+                              : scanAccountHistory(shm_ptr, id, &query, scanned);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double seconds = elapsedSeconds(start, end);
+        cout << "statement mode=" << modeNames[m] << " accounts=" << accounts << " records=" << records
+             << " capacity=" << capacity << " statements=" << statements << " found=" << found
+             << " seconds=" << seconds << " statements_per_sec=" << (long)(statements / seconds) << endl;
+    }
+
+    // Both ways must return the same records
+    for (long a = 0; a < accounts && a < 100; a++) {
+        char id[ACCOUNT_ID_LENGTH];
+        snprintf(id, sizeof(id), "Acct%d", (int)a);
+        long indexedCount = accountHistory(shm_ptr, id, &query, indexed);
+        long scannedCount = scanAccountHistory(shm_ptr, id, &query, scanned);
+        mismatches += (indexedCount != scannedCount);
+        for (long i = 0; i < indexedCount && i < scannedCount; i++) {
+            mismatches += (indexed[i].sequence != scanned[i].sequence);
+        }
+    }
+    cout << "statement mismatches=" << mismatches << endl;
+
+    delete[] indexed;
+    delete[] scanned;
+    destroyTransactionLog(shm_ptr);
+    munmap(shm_ptr, size);
+    unlink(spillPath);
+    return (mismatches == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Checks that every statement run by the worker pool lists the transactions before it.
+ *
+ * --rounds rounds, spread over --accounts N accounts, each deposit 1.00
+ * into the round's account, inquire and ask for its statement. A statement
+ * must list the account's CREATE and every DEPOSIT and INQUIRY before it,
+ * which its balance tells the number of. The input runs on --workers N
+ * workers one transaction at a time and with --batch N, where the
+ * statement can share a batch with the others.
+ *
+ * @return 0 on success, or 1 if a statement missed a transaction.
+ */
+static int benchStatementOrder(int argc, char *argv[]) {
+    int workers = (int)longOption(argc, argv, "--workers", 8);
+    long rounds = longOption(argc, argv, "--rounds", 400);
+    long accounts = longOption(argc, argv, "--accounts", 2);
+    int batchSize = (int)longOption(argc, argv, "--batch", 8);
+    const char *storePath = "benchmark_accounts.db";
+    const char *inputPath = "benchmark_statements.in";
+    const char *outputPath = "benchmark_statements.out";
+    if (workers < 1 || workers >= MAX_QUEUED_PROCESSES || accounts < 1 || rounds < 1 ||
+        1 + 2 * ((rounds + accounts - 1) / accounts) > MAX_STATEMENT_RECORDS || batchSize < 2 || batchSize > MAX_BATCH_SIZE) {
+        cerr << "Error: --workers must be between 1 and " << MAX_QUEUED_PROCESSES - 1 << ", --accounts positive, --rounds"
+             << " at most " << (MAX_STATEMENT_RECORDS - 1) / 2 << " per account and --batch between 2 and "
+             << MAX_BATCH_SIZE << endl;
+        return 1;
+    }
+
+    ofstream input(inputPath);
+    for (long a = 0; a < accounts; a++) {
+        input << "S" << a << " Create 100\n";
+    }
+    for (long r = 0; r < rounds; r++) {
+        long a = r % accounts;
+        input << "S" << a << " Deposit 1\nS" << a << " Inquiry\nS" << a << " Statement " << MAX_STATEMENT_RECORDS << "\n";
+    }
+    input.close();
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+
+    int batchSizes[] = {1, batchSize};
+    long incomplete = 0;
+    for (int m = 0; m < 2; m++) {
+        unlink(storePath);
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "benchmark_transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        if (openAccountStore(&(monitor->account_store), storePath, accounts * 2) != 0) {
+            return 1;
+        }
+        monitor->storage_backend = STORAGE_MAPPED;
+
+        InputReader reader;
+        if (openInputReader(&reader, inputPath) != 0) {
+            return 1;
+        }
+        fflush(stdout);
+        int savedStdout = dup(STDOUT_FILENO);
+        freopen(outputPath, "w", stdout);
+        runWorkerPool(monitor, &reader, workers, batchSizes[m]);
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+        closeInputReader(&reader);
+
+        // Only headers are checked, so lines interleaved by other workers do not matter
+        ifstream output(outputPath);
+        string line;
+        long statements = 0;
+        long missed = 0;
+        while (getline(output, line)) {
+            double balance;
+            long listed;
+            if (sscanf(line.c_str(), "Statement for account %*s (balance %lf): %ld transactions", &balance, &listed) == 2) {
+                statements++;
+                long deposits = lround(balance - 100);
+                missed += (listed != 1 + 2 * deposits);
+            }
+        }
+        missed += rounds - statements;
+        incomplete += missed;
+        cout << "statement-order workers=" << workers << " batch=" << batchSizes[m] << " statements=" << statements
+             << " incomplete=" << missed << endl;
+
+        closeAccountStore(&(monitor->account_store));
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+    }
+
+    unlink(storePath);
+    unlink(inputPath);
+    unlink(outputPath);
+    unlink("benchmark_transactions.log");
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return (incomplete == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Compares locked and optimistic inquiries in a read-heavy mix, with reports running alongside.
+ *
+ * Writer processes run --operations transactions each on the mapped store,
+ * --read-percent of them INQUIRY and the rest TRANSFER between random
+ * accounts, while one more process takes --reports reports. Transfers keep
+ * the total constant, so every report must show the same total; the run
+ * fails if one does not.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int benchReadMix(int argc, char *argv[]) {
+    int processes = (int)longOption(argc, argv, "--processes", 8);
+    long accounts = longOption(argc, argv, "--accounts", 1000);
+    long operations = longOption(argc, argv, "--operations", 100000);
+    long readPercent = longOption(argc, argv, "--read-percent", 95);
+    long reports = longOption(argc, argv, "--reports", 20);
+    const char *storePath = "benchmark_accounts.db";
+    const char *reportPath = "benchmark_reports.txt";
+    if (processes < 1 || processes >= MAX_QUEUED_PROCESSES || accounts < 2 || readPercent < 0 || readPercent > 100) {
+        cerr << "Error: --processes must be between 1 and " << MAX_QUEUED_PROCESSES - 1
+             << ", --accounts at least 2 and --read-percent between 0 and 100" << endl;
+        return 1;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t snapshot_size = accountSnapshotSize(DEFAULT_SNAPSHOT_CAPACITY);
+    AccountSnapshot *snapshot = (AccountSnapshot *)mmap(NULL, snapshot_size, PROT_READ | PROT_WRITE,
+                                                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    long *reportNs = (long *)mmap(NULL, sizeof(long), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || snapshot == MAP_FAILED || reportNs == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+
+    const char *modeNames[] = {"locked", "optimistic"};
+    long badReports = 0;
+    for (int m = 0; m < 2; m++) {
+        unlink(storePath);
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "benchmark_transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        if (openAccountStore(&(monitor->account_store), storePath, accounts * 2) != 0) {
+            return 1;
+        }
+        monitor->storage_backend = STORAGE_MAPPED;
+        initializeAccountSnapshot(snapshot, DEFAULT_SNAPSHOT_CAPACITY);
+        monitor->snapshot = snapshot;
+        monitor->optimistic_reads = (m == 1);
+        *reportNs = 0;
+
+        fflush(stdout);
+        int savedStdout = dup(STDOUT_FILENO);
+        freopen("/dev/null", "w", stdout);
+        char id[ACCOUNT_ID_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            createAccount(monitor, id, id, 1000 * MONEY_SCALE);
+        }
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        vector<pid_t> writers;
+        for (int p = 0; p < processes; p++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                freopen("/dev/null", "w", stdout); // Silence the per-transaction messages
+                unsigned int seed = 1000 + p;
+                char other[ACCOUNT_ID_LENGTH];
+                for (long i = 0; i < operations; i++) {
+                    snprintf(id, sizeof(id), "Acct%d", (int)(rand_r(&seed) % accounts));
+                    if ((long)(rand_r(&seed) % 100) < readPercent) {
+                        inquiry(monitor, id);
+                    } else {
+                        snprintf(other, sizeof(other), "Acct%d", (int)(rand_r(&seed) % accounts));
+                        if (strcmp(id, other) != 0) {
+                            transfer(monitor, id, (1 + rand_r(&seed) % 100) * MONEY_SCALE, other);
+                        }
+                    }
+                }
+                exit(0);
+            }
+            writers.push_back(pid);
+        }
+        pid_t reporter = fork();
+        if (reporter == 0) {
+            freopen(reportPath, "w", stdout);
+            for (long r = 0; r < reports; r++) {
+                long reportStart = nowNanoseconds();
+                report(monitor);
+                *reportNs += nowNanoseconds() - reportStart;
+            }
+            exit(0);
+        }
+        for (pid_t pid : writers) {
+            waitpid(pid, NULL, 0);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        waitpid(reporter, NULL, 0);
+
+        // Every report must show the starting total
+        char expected[MONEY_TEXT_LENGTH];
+        formatMoney(accounts * 1000 * MONEY_SCALE, expected);
+        ifstream reportFile(reportPath);
+        string line;
+        long taken = 0;
+        while (getline(reportFile, line)) {
+            if (line.compare(0, 7, "Report:") == 0) {
+                taken++;
+                badReports += (line.find(string("total ") + expected) == string::npos);
+            }
+        }
+        badReports += (taken != reports);
+
+        long total = processes * operations;
+        double seconds = elapsedSeconds(start, end);
+        cout << "read-mix mode=" << modeNames[m] << " processes=" << processes << " accounts=" << accounts
+             << " read_percent=" << readPercent << " operations=" << total << " seconds=" << seconds
+             << " operations_per_sec=" << (long)(total / seconds) << " reports=" << taken
+             << " report_ms=" << (taken > 0 ? *reportNs / taken / 1e6 : 0.0)
+             << " before_images=" << snapshot->preserved << endl;
+
+        monitor->snapshot = NULL;
+        pthread_mutex_destroy(&(snapshot->report_mutex));
+        closeAccountStore(&(monitor->account_store));
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+    }
+    cout << "read-mix inconsistent_reports=" << badReports << endl;
+
+    unlink(storePath);
+    unlink(reportPath);
+    unlink("benchmark_transactions.log");
+    munmap(reportNs, sizeof(long));
+    munmap(snapshot, snapshot_size);
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return (badReports == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Replays the transaction log per account and counts the records their account's history does not explain.
+ *
+ * A successful withdrawal or transfer must find enough money in the
+ * balance replayed so far, and one failed for insufficient funds must not;
+ * the replayed balances must end as the stored ones. A transaction
+ * recorded ahead of one its outcome depended on breaks this.
+ *
+ * @param monitor Pointer to the monitor structure, with the log to replay.
+ * @return Number of records and final balances that do not fit.
+ */
+static long countMisorderedRecords(Monitor *monitor) {
+    map<string, Money> balances;
+    long misordered = 0;
+    TransactionLogReader reader;
+    TransactionRecord record;
+    openTransactionLogReader(&reader, monitor->shm_ptr);
+    while (nextTransaction(&reader, &record)) {
+        string id(record.account_id, strnlen(record.account_id, ACCOUNT_ID_LENGTH));
+        bool success = record.status == TXN_SUCCESS;
+        bool overdrawn = balances[id] < record.amount;
+        if (record.transaction_type == TXN_CREATE && success) {
+            balances[id] = record.amount;
+        } else if (record.transaction_type == TXN_DEPOSIT && success) {
+            balances[id] += record.amount;
+        } else if (record.transaction_type == TXN_WITHDRAW || record.transaction_type == TXN_TRANSFER) {
+            if (success) {
+                misordered += overdrawn;
+                balances[id] -= record.amount;
+                if (record.transaction_type == TXN_TRANSFER) {
+                    balances[string(record.recipient_account_id, strnlen(record.recipient_account_id, ACCOUNT_ID_LENGTH))] +=
+                        record.amount;
+                }
+            } else if (record.reason == REASON_INSUFFICIENT_FUNDS) {
+                misordered += !overdrawn;
+            }
+        }
+    }
+    closeTransactionLogReader(&reader);
+
+    for (map<string, Money>::iterator it = balances.begin(); it != balances.end(); ++it) {
+        misordered += (monitorGetBalance(monitor, it->first.c_str()) != it->second);
+    }
+    return misordered;
+}
+
+/**
+ * @brief Measures deposits and transfers skewed onto a few hot accounts, with and without combining.
+ *
+ * --processes N processes each run --operations N updates whose recipient
+ * is drawn from a Zipf distribution (--zipf S) over --accounts N accounts:
+ * half are deposits, half transfers from a uniformly chosen sender. Every
+ * account starts with enough money that nothing fails, so the final
+ * balances must be the same in the first two modes:
+ *   off   each update locks the account and rewrites its file
+ *   auto  contended accounts are promoted and their updates combined
+ *   low   as auto, but accounts start empty and the transfers are
+ *         withdrawals of twice the amount, so balances stay near zero and
+ *         each withdrawal depends on the combined deposits before it
+ * In every mode the log must list each account's transactions in an order
+ * that explains them (see countMisorderedRecords). Uses the files backend
+ * without the cache, in a scratch directory that is removed afterwards.
+ *
+ * @return 0 on success, or 1 if the modes end with different balances or a log is out of order.
+ */
+static int benchHotAccounts(int argc, char *argv[]) {
+    int processes = (int)longOption(argc, argv, "--processes", 8);
+    long accounts = longOption(argc, argv, "--accounts", 1000);
+    long operations = longOption(argc, argv, "--operations", 20000);
+    const char *zipf = stringOption(argc, argv, "--zipf", NULL);
+    double skew = (zipf != NULL) ? atof(zipf) : DEFAULT_WORKLOAD_ZIPF;
+    const char *directory = "benchmark_hot";
+    if (processes < 1 || processes > MAX_QUEUED_PROCESSES || accounts < 2 || operations < 1 || skew < 0) {
+        cerr << "Error: --processes must be between 1 and " << MAX_QUEUED_PROCESSES
+             << ", --accounts at least 2, --operations positive and --zipf not negative" << endl;
+        return 1;
+    }
+
+    size_t monitor_size = monitorSize(DEFAULT_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    size_t log_size = transactionLogSize(DEFAULT_LOG_CAPACITY);
+    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)mmap(NULL, log_size, PROT_READ | PROT_WRITE,
+                                                               MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    AccountCombiner *combiner = (AccountCombiner *)mmap(NULL, sizeof(AccountCombiner), PROT_READ | PROT_WRITE,
+                                                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED || shm_ptr == MAP_FAILED || combiner == MAP_FAILED) {
+        perror("Benchmark mmap");
+        return 1;
+    }
+    if (mkdir(directory, 0777) == -1 && errno != EEXIST) {
+        perror("Benchmark directory");
+        return 1;
+    }
+    if (chdir(directory) == -1) {
+        perror("Benchmark directory");
+        return 1;
+    }
+
+    ZipfSampler sampler;
+    initializeZipfSampler(&sampler, accounts, skew);
+
+    const char *modeNames[] = {"off", "auto", "low"};
+    Money openingBalances[] = {(Money)WORKLOAD_OPENING_BALANCE * MONEY_SCALE, (Money)WORKLOAD_OPENING_BALANCE * MONEY_SCALE,
+                               0};
+    vector<Money> expected;
+    long mismatches = 0;
+    long misordered = 0;
+    for (int m = 0; m < 3; m++) {
+        initializeTransactionLog(shm_ptr, DEFAULT_LOG_CAPACITY, "transactions.log");
+        initializeMonitor(monitor, shm_ptr, DEFAULT_LOCK_STRIPES);
+        initializeAccountCombiner(combiner, true, DEFAULT_HOT_PROMOTE);
+        monitor->combiner = (m > 0) ? combiner : NULL;
+
+        fflush(stdout);
+        int savedStdout = dup(STDOUT_FILENO);
+        freopen("/dev/null", "w", stdout);
+        char id[ACCOUNT_ID_LENGTH];
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            createAccount(monitor, id, id, openingBalances[m]);
+        }
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+
+        timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int p = 0; p < processes; p++) {
+            if (fork() == 0) {
+                freopen("/dev/null", "w", stdout); // Silence the per-transaction messages
+                unsigned int seed = 1000 + p;
+                char from[ACCOUNT_ID_LENGTH];
+                for (long i = 0; i < operations; i++) {
+                    snprintf(id, sizeof(id), "Acct%d", (int)zipfSample(&sampler, &seed));
+                    Money amount = (1 + rand_r(&seed) % 100) * MONEY_SCALE;
+                    snprintf(from, sizeof(from), "Acct%d", (int)(rand_r(&seed) % accounts));
+                    if (i % 2 == 1 && m == 2) {
+                        withdraw(monitor, id, 2 * amount);
+                    } else if (i % 2 == 0 || strcmp(id, from) == 0) {
+                        deposit(monitor, id, amount);
+                    } else {
+                        transfer(monitor, from, amount, id);
+                    }
+                }
+                exit(0);
+            }
+        }
+        for (int p = 0; p < processes; p++) {
+            wait(NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        long combined = 0, writes = 0;
+        for (int i = 0; i < combiner->hot; i++) {
+            combined += combiner->accounts[i].combined;
+            writes += combiner->accounts[i].writes;
+        }
+        LockTableStats stats;
+        getLockTableStats(monitor, &stats);
+        long total = processes * operations;
+        double seconds = elapsedSeconds(start, end);
+        cout << "hot-accounts mode=" << modeNames[m] << " processes=" << processes << " accounts=" << accounts
+             << " zipf=" << skew << " operations=" << total << " seconds=" << seconds
+             << " operations_per_sec=" << (long)(total / seconds) << " contended=" << stats.contended
+             << " promoted=" << ((m > 0) ? combiner->hot : 0) << " combined=" << combined
+             << " updates_per_write=" << (writes > 0 ? (double)combined / writes : 0.0) << endl;
+
+        misordered += countMisorderedRecords(monitor);
+        for (long a = 0; a < accounts; a++) {
+            snprintf(id, sizeof(id), "Acct%d", (int)a);
+            Money balance = monitorGetBalance(monitor, id);
+            if (m == 0) {
+                expected.push_back(balance);
+            } else if (m == 1) {
+                mismatches += (balance != expected[a]);
+            }
+            char filename[30];
+            snprintf(filename, sizeof(filename), "Acct%ld.txt", a);
+            unlink(filename);
+        }
+        monitor->combiner = NULL;
+        destroyMonitor(monitor);
+        destroyTransactionLog(shm_ptr);
+    }
+    cout << "hot-accounts mismatched_balances=" << mismatches << " misordered_records=" << misordered << endl;
+
+    unlink("transactions.log");
+    if (chdir("..") == 0) {
+        rmdir(directory);
+    }
+    munmap(combiner, sizeof(AccountCombiner));
+    munmap(shm_ptr, log_size);
+    munmap(monitor, monitor_size);
+    return (mismatches == 0 && misordered == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Entry point: runs the benchmark named by the first argument.
+ */
+int main(int argc, char *argv[]) {
+    if (argc >= 2 && strcmp(argv[1], "log-append") == 0) {
+        return benchLogAppend(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "monitor-fairness") == 0) {
+        return benchMonitorFairness(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "inquiry-share") == 0) {
+        return benchInquiryShare(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "wal-commit") == 0) {
+        return benchWalCommit(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "wal-recovery") == 0) {
+        return benchWalRecovery(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "parse") == 0) {
+        return benchParse(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "cache-skew") == 0) {
+        return benchCacheSkew(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "money-format") == 0) {
+        return benchMoneyFormat(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "batch-apply") == 0) {
+        return benchBatchApply(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "file-io") == 0) {
+        return benchFileIo(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "shard-scaling") == 0) {
+        return benchShardScaling(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "event-output") == 0) {
+        return benchEventOutput(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "account-lookup") == 0) {
+        return benchAccountLookup(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "segment-attach") == 0) {
+        return benchSegmentAttach(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "statement") == 0) {
+        return benchStatement(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "statement-order") == 0) {
+        return benchStatementOrder(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "read-mix") == 0) {
+        return benchReadMix(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "hot-accounts") == 0) {
+        return benchHotAccounts(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "generate") == 0) {
+        return benchGenerate(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "end-to-end") == 0) {
+        return benchEndToEnd(argc, argv);
+    }
+
+    cerr << "Usage: " << argv[0] << " log-append [--writers N] [--records N] [--capacity N]" << endl;
+    cerr << "       " << argv[0] << " monitor-fairness [--processes N] [--entries N] [--hold-ns N]" << endl;
+    cerr << "       " << argv[0] << " inquiry-share [--processes N] [--inquiries N] [--accounts N]" << endl;
+    cerr << "       " << argv[0] << " wal-commit [--writers N] [--records N] [--batch N] [--max-latency-us N]" << endl;
+    cerr << "       " << argv[0] << " wal-recovery [--accounts N] [--operations N]" << endl;
+    cerr << "       " << argv[0] << " parse [--input FILE | --lines N] [--repeat N]" << endl;
+    cerr << "       " << argv[0] << " cache-skew [--accounts N] [--transactions N] [--hot-percent P]" << endl;
+    cerr << "       " << argv[0] << " money-format [--values N]" << endl;
+    cerr << "       " << argv[0] << " batch-apply [--accounts N] [--transactions N] [--batch N]" << endl;
+    cerr << "       " << argv[0] << " file-io [--accounts N] [--transactions N] [--batch N]" << endl;
+    cerr << "       " << argv[0] << " shard-scaling [--driver ./driver] [--max-shards N] [workload options]" << endl;
+    cerr << "       " << argv[0] << " event-output [--processes N] [--transactions N]" << endl;
+    cerr << "       " << argv[0] << " account-lookup [--accounts N] [--lookups N] [--missing-percent P] [--shards N]" << endl;
+    cerr << "       " << argv[0] << " segment-attach [--lock-stripes N] [--rounds N]" << endl;
+    cerr << "       " << argv[0] << " statement [--accounts N] [--records N] [--capacity N] [--statements N] [--last N]"
+         << endl;
+    cerr << "       " << argv[0] << " statement-order [--workers N] [--rounds N] [--accounts N] [--batch N]" << endl;
+    cerr << "       " << argv[0] << " read-mix [--processes N] [--accounts N] [--operations N] [--read-percent P]"
+         << " [--reports N]" << endl;
+    cerr << "       " << argv[0] << " hot-accounts [--processes N] [--accounts N] [--operations N] [--zipf S]" << endl;
+    cerr << "       " << argv[0] << " generate [--output FILE] [workload options]" << endl;
+    cerr << "       " << argv[0] << " end-to-end [--driver PATH] [--workers N] [--store files|mapped] [--repeat N]"
+         << " [--json FILE] [workload options]" << endl;
+    cerr << "Workload options: [--accounts N] [--transactions N] [--mix C,D,W,I,T,X] [--zipf S]"
+         << " [--fail-percent P] [--seed N]" << endl;
+    return 1;
+}
@@ -0,0 +1,346 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "server.h"
+using namespace std;
+
+/**
+ * @brief Reads a numeric option ("--name N") or returns its default.
+ */
+static long longOption(int argc, char *argv[], const char *name, long defaultValue) {
+    for (int i = 2; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return atol(argv[i + 1]);
+        }
+    }
+    return defaultValue;
+}
+
+/**
+ * @brief Reads a text option ("--name VALUE") or returns its default.
+ */
+static const char *stringOption(int argc, char *argv[], const char *name, const char *defaultValue) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            return argv[i + 1];
+        }
+    }
+    return defaultValue;
+}
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ */
+static long nowNanoseconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+/**
+ * @brief Returns the value at a percentile of sorted samples.
+ */
+static long percentile(const vector<long> &sorted, double p) {
+    size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/**
+ * @brief Connects to the server's socket.
+ *
+ * @return The connected socket, or -1 on failure.
+ */
+static int connectToServer(const char *socketPath) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1 || connect(fd, (sockaddr *)&address, sizeof(address)) == -1) {
+        perror(socketPath);
+        if (fd != -1) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Writes a buffer fully, retrying on short writes.
+ *
+ * @return 0 on success, or -1 on failure.
+ */
+static int writeFully(int fd, const char *buffer, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, buffer, length);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buffer += written;
+        length -= written;
+    }
+    return 0;
+}
+
+/**
+ * @brief Sends every line of a file (or standard input) to the server and prints the replies.
+ *
+ * Requests are pipelined: the client keeps writing while it reads replies,
+ * and closes its side once everything is sent so the server answers an
+ * unterminated last line too.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int sendRequests(const char *socketPath, const char *inputPath) {
+    int input = (inputPath != NULL) ? open(inputPath, O_RDONLY) : STDIN_FILENO;
+    if (input == -1) {
+        perror(inputPath);
+        return 1;
+    }
+    string requests;
+    char buffer[SERVER_BUFFER_SIZE];
+    ssize_t bytesRead;
+    while ((bytesRead = read(input, buffer, sizeof(buffer))) > 0) {
+        requests.append(buffer, bytesRead);
+    }
+    if (inputPath != NULL) {
+        close(input);
+    }
+
+    int fd = connectToServer(socketPath);
+    if (fd == -1) {
+        return 1;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    size_t sent = 0;
+    if (requests.empty()) {
+        shutdown(fd, SHUT_WR);
+    }
+    while (true) {
+        pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN | ((sent < requests.size()) ? POLLOUT : 0);
+        if (poll(&pfd, 1, -1) == -1) {
+            continue;
+        }
+        if ((pfd.revents & POLLOUT) && sent < requests.size()) {
+            ssize_t written = write(fd, requests.data() + sent, requests.size() - sent);
+            if (written > 0) {
+                sent += written;
+                if (sent == requests.size()) {
+                    shutdown(fd, SHUT_WR);
+                }
+            }
+        }
+        if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+            bytesRead = read(fd, buffer, sizeof(buffer));
+            if (bytesRead == 0 || (bytesRead == -1 && errno != EAGAIN && errno != EINTR)) {
+                break;
+            }
+            if (bytesRead > 0) {
+                fwrite(buffer, 1, bytesRead, stdout);
+            }
+        }
+    }
+    close(fd);
+    return (sent == requests.size()) ? 0 : 1;
+}
+
+/**
+ * @brief Appends one load generator request.
+ *
+ * Setup requests create the accounts Load0, Load1, ...; the others pick a
+ * random account and are 40% inquiries, 30% deposits, 20% withdrawals and
+ * 10% transfers.
+ */
+static void appendLoadRequest(string *requests, long index, long accounts, bool setup, unsigned int *seed) {
+    char line[96];
+    if (setup) {
+        snprintf(line, sizeof(line), "Load%ld Create 1000000\n", index);
+    } else {
+        long account = rand_r(seed) % accounts;
+        long amount = 1 + rand_r(seed) % 50;
+        int pick = rand_r(seed) % 10;
+        if (pick < 4) {
+            snprintf(line, sizeof(line), "Load%ld Inquiry\n", account);
+        } else if (pick < 7) {
+            snprintf(line, sizeof(line), "Load%ld Deposit %ld\n", account, amount);
+        } else if (pick < 9) {
+            snprintf(line, sizeof(line), "Load%ld Withdraw %ld\n", account, amount);
+        } else {
+            snprintf(line, sizeof(line), "Load%ld Transfer %ld Load%ld\n", account, amount, rand_r(seed) % accounts);
+        }
+    }
+    requests->append(line);
+}
+
+/**
+ * @brief Runs one load generator connection, keeping up to depth requests in flight.
+ *
+ * @param socketPath The server's socket.
+ * @param count Number of requests to send.
+ * @param depth Most requests sent and not yet answered.
+ * @param accounts Number of Load accounts.
+ * @param setup Whether to send the account creations instead of random requests.
+ * @param seed Seed of the random requests.
+ * @param latencies Receives each request's latency in nanoseconds (may be NULL).
+ * @return true if every request was answered.
+ */
+static bool runLoadConnection(const char *socketPath, long count, long depth, long accounts, bool setup,
+                              unsigned int seed, long *latencies) {
+    int fd = connectToServer(socketPath);
+    if (fd == -1) {
+        return false;
+    }
+
+    vector<long> sendTimes(depth);
+    char buffer[SERVER_BUFFER_SIZE];
+    long sent = 0, received = 0;
+    string requests;
+    while (received < count) {
+        requests.clear();
+        long now = nowNanoseconds();
+        while (sent < count && sent - received < depth) {
+            appendLoadRequest(&requests, sent, accounts, setup, &seed);
+            sendTimes[sent % depth] = now;
+            sent++;
+        }
+        if (!requests.empty() && writeFully(fd, requests.data(), requests.size()) == -1) {
+            break;
+        }
+
+        ssize_t bytesRead = read(fd, buffer, sizeof(buffer));
+        if (bytesRead <= 0) {
+            if (bytesRead == -1 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        now = nowNanoseconds();
+        for (ssize_t i = 0; i < bytesRead; i++) {
+            if (buffer[i] == '\n') {
+                if (latencies != NULL) {
+                    latencies[received] = now - sendTimes[received % depth];
+                }
+                received++;
+            }
+        }
+    }
+    close(fd);
+    return received == count;
+}
+
+/**
+ * @brief Drives the server with --connections N connections of --depth N pipelined requests each.
+ *
+ * First creates --accounts N accounts over one connection, then every
+ * connection process sends --requests N random requests, and reports the
+ * request rate and latency percentiles over all of them.
+ *
+ * @return 0 on success, or 1 on failure.
+ */
+static int runLoad(int argc, char *argv[], const char *socketPath) {
+    long connections = longOption(argc, argv, "--connections", 4);
+    long depth = longOption(argc, argv, "--depth", 1);
+    long requests = longOption(argc, argv, "--requests", 20000);
+    long accounts = longOption(argc, argv, "--accounts", 100);
+    unsigned int seed = (unsigned int)longOption(argc, argv, "--seed", 42);
+    if (connections < 1 || depth < 1 || requests < 1 || accounts < 1) {
+        cerr << "Error: --connections, --depth, --requests and --accounts must be positive" << endl;
+        return 1;
+    }
+
+    if (!runLoadConnection(socketPath, accounts, 64, accounts, true, seed, NULL)) {
+        cerr << "Error: Could not create the load accounts" << endl;
+        return 1;
+    }
+
+    long total = connections * requests;
+    size_t size = total * sizeof(long);
+    long *latencies = (long *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (latencies == MAP_FAILED) {
+        perror("Latency mmap");
+        return 1;
+    }
+
+    long start = nowNanoseconds();
+    for (long c = 0; c < connections; c++) {
+        if (fork() == 0) {
+            bool ok = runLoadConnection(socketPath, requests, depth, accounts, false, seed + c + 1,
+                                        latencies + c * requests);
+            exit(ok ? 0 : 1);
+        }
+    }
+    bool ok = true;
+    for (long c = 0; c < connections; c++) {
+        int status;
+        wait(&status);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    double seconds = (nowNanoseconds() - start) / 1e9;
+    if (!ok) {
+        cerr << "Error: A load connection failed" << endl;
+        munmap(latencies, size);
+        return 1;
+    }
+
+    vector<long> sorted(latencies, latencies + total);
+    sort(sorted.begin(), sorted.end());
+    cout << "load connections=" << connections << " depth=" << depth << " requests=" << total
+         << " seconds=" << seconds << " requests_per_sec=" << (long)(total / seconds)
+         << " latency_p50_us=" << percentile(sorted, 50) / 1000.0
+         << " latency_p90_us=" << percentile(sorted, 90) / 1000.0
+         << " latency_p99_us=" << percentile(sorted, 99) / 1000.0
+         << " latency_max_us=" << sorted.back() / 1000.0 << endl;
+    munmap(latencies, size);
+    return 0;
+}
+
+/**
+ * @brief Entry point: sends a transaction file to a running server, or generates load against it.
+ */
+int main(int argc, char *argv[]) {
+    const char *socketPath = stringOption(argc, argv, "--socket", DEFAULT_SERVER_SOCKET);
+    if (argc >= 2 && strcmp(argv[1], "load") == 0) {
+        return runLoad(argc, argv, socketPath);
+    }
+
+    const char *inputPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            i++;
+        } else if (inputPath == NULL && argv[i][0] != '-') {
+            inputPath = argv[i];
+        } else {
+            cerr << "Usage: " << argv[0] << " [--socket P] [input_file]" << endl;
+            cerr << "       " << argv[0] << " load [--socket P] [--connections N] [--depth N] [--requests N]"
+                 << " [--accounts N] [--seed N]" << endl;
+            return 1;
+        }
+    }
+    return sendRequests(socketPath, inputPath);
+}
@@ -6,140 +6,649 @@
  */
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
-#include <algorithm>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <pthread.h>
 #include "monitor.h"
 #include "sharedmemory.h"
+#include "shared_segment.h"
+#include "worker_pool.h"
+#include "server.h"
+#include "shard_engine.h"
+#include "money.cpp"
+#include "transaction_log.cpp"
+#include "async_io.cpp"
+#include "event_output.cpp"
+#include "write_ahead_log.cpp"
+#include "account_store.cpp"
+#include "account_cache.cpp"
+#include "account_snapshot.cpp"
+#include "account_combiner.cpp"
+#include "account_directory.cpp"
+#include "metrics.cpp"
 #include "monitor_init_and_queue.cpp"
+#include "shared_segment.cpp"
 #include "monitor_helpers.cpp"
 #include "monitor_transactions.cpp"
+#include "input_parser.cpp"
+#include "worker_pool.cpp"
+#include "server.cpp"
+#include "shard_engine.cpp"
 using namespace std;
 
-/**
- * @brief Converts a string to uppercase.
- *
- * @param str The input string.
- * @return A new string with all characters converted to uppercase.
- */
-string toUpperCase(const string &str) {
-    string result = str;
-    transform(result.begin(), result.end(), result.begin(),
-              [](unsigned char c) { return toupper(c); });
-    return result;
-}
-
 /**
  * @brief Entry point of the application. Reads input commands, processes transactions, and manages shared memory.
  *
  * @param argc The number of command-line arguments.
- * @param argv An array of command-line arguments. The second argument should specify the input file path.
+ * @param argv An array of command-line arguments. The last argument should specify the input file path,
+ *             optionally preceded by "--workers N" to run transactions on a pool of N worker processes
+ *             (with "--batch N" letting each worker apply up to N consecutive lines under one monitor entry)
+ *             ("--shards N" instead partitions the accounts over N pinned worker processes that share
+ *             no locks, see runShardEngine) and "--store files|mapped" (with "--store-path P" and "--store-capacity N") to pick the
+ *             account storage backend, and "--log-capacity N" / "--log-spill P" to size the shared
+ *             transaction log and choose where older records are spilled ("--keep-segment" leaves the
+ *             shared memory holding the monitor and log initialized, so the next run with the same sizes
+ *             attaches to it without initializing the lock table again). "--lock-stripes N" sizes the
+ *             account lock table and "--lock-stats" prints its contention statistics at the end.
+ *             Account files are only locked in shared memory (inquiries shared, updates exclusive);
+ *             "--lock-mode flock" also flocks them, for outside tools that rely on it.
+ *             "--wal P" logs every balance change to a write-ahead log at P before applying it
+ *             (tuned with "--wal-batch N", "--wal-max-latency US" and "--wal-checkpoint N").
+ *             With the files backend, balances are cached in shared memory and written back in
+ *             batches ("--cache N" entries, 0 disables; "--cache-flush N"; "--cache-stats").
+ *             "--account-shards N" keeps account files in N subdirectories of accounts/ instead of the
+ *             working directory, and "--account-filter N" sizes the membership filter that answers
+ *             lookups of missing accounts without the filesystem (0 disables; "--directory-stats").
+ *             "--metrics" prints per-type, per-phase latency percentiles and outcome counts at the
+ *             end, and "--metrics-json P" also writes them to P as JSON.
+ *             "--io uring" submits account file reads and writes and the write-ahead log's
+ *             flushes through io_uring ("--io sync", the default, uses plain system calls).
+ *             "--inquiry optimistic" answers INQUIRY lines without waiting for the account's lane
+ *             (see monitorReadBalanceOptimistic). A "Report" line prints every balance as of one
+ *             point in time while writers keep running; "--snapshot-capacity N" bounds how many
+ *             accounts may change while one report reads (see beginSnapshot).
+ *             "--hot-accounts auto" combines the deposits and incoming transfer credits of accounts
+ *             whose lanes keep a queue ("--hot-promote N" contended updates promote one), so one
+ *             storage write applies many of them (see monitorCombineDelta); "--hot-accounts ID,ID"
+ *             names the hot accounts instead, and "off" (the default) disables combining.
+ *             Transaction and queue messages are collected in per-process buffers and written in
+ *             bulk by a writer thread; "--verbosity summary" prints outcome counts instead of them
+ *             and the log dump, and "--verbosity silent" prints neither ("full" is the default, and the
+ *             only one that also prints the write-ahead log's statistics).
+ *             "--serve P" replaces the input file: the driver stays up and serves transactions sent
+ *             over the Unix domain socket P (see runServer) on --workers N processes until it is
+ *             stopped with SIGINT or SIGTERM, then writes back and dumps the log as after a batch.
  * @return 0 on successful execution, or an error code for failure.
  */
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        cerr << "Usage: " << argv[0] << " <input_file>" << endl;
+    int workerCount = 0; // 0 selects the original fork-per-line mode
+    int batchSize = 1;
+    int executionShards = 0;
+    StorageBackend storageBackend = STORAGE_FILES;
+    const char *storePath = "accounts.db";
+    uint64_t storeCapacity = DEFAULT_STORE_CAPACITY;
+    int lockStripes = DEFAULT_LOCK_STRIPES;
+    bool printLockStats = false;
+    bool flockCompat = false;
+    bool keepSegment = false;
+    long logCapacity = DEFAULT_LOG_CAPACITY;
+    const char *spillPath = DEFAULT_SPILL_PATH;
+    const char *walPath = NULL;
+    int walBatchSize = DEFAULT_WAL_BATCH_SIZE;
+    long walMaxLatencyUs = DEFAULT_WAL_MAX_LATENCY_US;
+    long walCheckpointInterval = DEFAULT_WAL_CHECKPOINT;
+    uint64_t cacheCapacity = DEFAULT_CACHE_CAPACITY;
+    long cacheFlushThreshold = DEFAULT_CACHE_FLUSH;
+    bool printCacheStats = false;
+    int accountShards = 0;
+    uint64_t accountFilter = DEFAULT_ACCOUNT_FILTER;
+    bool printDirectoryStats = false;
+    bool printMetricsReport = false;
+    const char *metricsJsonPath = NULL;
+    bool asyncIo = false;
+    bool optimisticReads = false;
+    uint64_t snapshotCapacity = DEFAULT_SNAPSHOT_CAPACITY;
+    const char *hotAccounts = NULL; // "auto" or a comma-separated list of account IDs
+    long hotPromote = DEFAULT_HOT_PROMOTE;
+    OutputVerbosity verbosity = OUTPUT_FULL;
+    const char *servePath = NULL;
+    const char *inputPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workerCount = atoi(argv[++i]);
+            if (workerCount < 1 || workerCount > MAX_WORKERS) {
+                cerr << "Error: --workers must be between 1 and " << MAX_WORKERS << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+            executionShards = atoi(argv[++i]);
+            if (executionShards < 1 || executionShards > MAX_EXEC_SHARDS) {
+                cerr << "Error: --shards must be between 1 and " << MAX_EXEC_SHARDS << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchSize = atoi(argv[++i]);
+            if (batchSize < 1 || batchSize > MAX_BATCH_SIZE) {
+                cerr << "Error: --batch must be between 1 and " << MAX_BATCH_SIZE << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--store") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "files") == 0) {
+                storageBackend = STORAGE_FILES;
+            } else if (strcmp(argv[i], "mapped") == 0) {
+                storageBackend = STORAGE_MAPPED;
+            } else {
+                cerr << "Error: --store must be files or mapped" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--store-path") == 0 && i + 1 < argc) {
+            storePath = argv[++i];
+        } else if (strcmp(argv[i], "--store-capacity") == 0 && i + 1 < argc) {
+            storeCapacity = strtoull(argv[++i], NULL, 10);
+            if (storeCapacity == 0) {
+                cerr << "Error: --store-capacity must be positive" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--lock-stripes") == 0 && i + 1 < argc) {
+            long requested = atol(argv[++i]);
+            if (requested < 1 || requested > (1L << 24)) {
+                cerr << "Error: --lock-stripes must be between 1 and " << (1L << 24) << endl;
+                return 1;
+            }
+            lockStripes = 1;
+            while (lockStripes < requested) {
+                lockStripes <<= 1;
+            }
+        } else if (strcmp(argv[i], "--lock-stats") == 0) {
+            printLockStats = true;
+        } else if (strcmp(argv[i], "--lock-mode") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "internal") == 0) {
+                flockCompat = false;
+            } else if (strcmp(argv[i], "flock") == 0) {
+                flockCompat = true;
+            } else {
+                cerr << "Error: --lock-mode must be internal or flock" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--log-capacity") == 0 && i + 1 < argc) {
+            logCapacity = atol(argv[++i]);
+            if (logCapacity < 1) {
+                cerr << "Error: --log-capacity must be positive" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--log-spill") == 0 && i + 1 < argc) {
+            spillPath = argv[++i];
+        } else if (strcmp(argv[i], "--wal") == 0 && i + 1 < argc) {
+            walPath = argv[++i];
+        } else if (strcmp(argv[i], "--wal-batch") == 0 && i + 1 < argc) {
+            walBatchSize = atoi(argv[++i]);
+            if (walBatchSize < 1 || walBatchSize > WAL_BUFFER_RECORDS) {
+                cerr << "Error: --wal-batch must be between 1 and " << WAL_BUFFER_RECORDS << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--wal-max-latency") == 0 && i + 1 < argc) {
+            walMaxLatencyUs = atol(argv[++i]);
+            if (walMaxLatencyUs < 0) {
+                cerr << "Error: --wal-max-latency must not be negative" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--wal-checkpoint") == 0 && i + 1 < argc) {
+            walCheckpointInterval = atol(argv[++i]);
+            if (walCheckpointInterval < 1) {
+                cerr << "Error: --wal-checkpoint must be positive" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cacheCapacity = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--cache-flush") == 0 && i + 1 < argc) {
+            cacheFlushThreshold = atol(argv[++i]);
+            if (cacheFlushThreshold < 1) {
+                cerr << "Error: --cache-flush must be positive" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--cache-stats") == 0) {
+            printCacheStats = true;
+        } else if (strcmp(argv[i], "--metrics") == 0) {
+            printMetricsReport = true;
+        } else if (strcmp(argv[i], "--metrics-json") == 0 && i + 1 < argc) {
+            metricsJsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--account-shards") == 0 && i + 1 < argc) {
+            int requested = atoi(argv[++i]);
+            if (requested < 0 || requested > MAX_ACCOUNT_SHARDS) {
+                cerr << "Error: --account-shards must be between 0 and " << MAX_ACCOUNT_SHARDS << endl;
+                return 1;
+            }
+            accountShards = 0;
+            if (requested > 0) {
+                accountShards = 1;
+                while (accountShards < requested) {
+                    accountShards <<= 1;
+                }
+            }
+        } else if (strcmp(argv[i], "--account-filter") == 0 && i + 1 < argc) {
+            long long requested = atoll(argv[++i]);
+            if (requested < 0) {
+                cerr << "Error: --account-filter must not be negative" << endl;
+                return 1;
+            }
+            accountFilter = (uint64_t)requested;
+        } else if (strcmp(argv[i], "--directory-stats") == 0) {
+            printDirectoryStats = true;
+        } else if (strcmp(argv[i], "--keep-segment") == 0) {
+            keepSegment = true;
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            servePath = argv[++i];
+        } else if (strcmp(argv[i], "--verbosity") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "silent") == 0) {
+                verbosity = OUTPUT_SILENT;
+            } else if (strcmp(argv[i], "summary") == 0) {
+                verbosity = OUTPUT_SUMMARY;
+            } else if (strcmp(argv[i], "full") == 0) {
+                verbosity = OUTPUT_FULL;
+            } else {
+                cerr << "Error: --verbosity must be silent, summary or full" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--io") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "sync") == 0) {
+                asyncIo = false;
+            } else if (strcmp(argv[i], "uring") == 0) {
+                asyncIo = true;
+            } else {
+                cerr << "Error: --io must be sync or uring" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--inquiry") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "locked") == 0) {
+                optimisticReads = false;
+            } else if (strcmp(argv[i], "optimistic") == 0) {
+                optimisticReads = true;
+            } else {
+                cerr << "Error: --inquiry must be locked or optimistic" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--snapshot-capacity") == 0 && i + 1 < argc) {
+            snapshotCapacity = strtoull(argv[++i], NULL, 10);
+            if (snapshotCapacity < 1) {
+                cerr << "Error: --snapshot-capacity must be positive" << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--hot-accounts") == 0 && i + 1 < argc) {
+            i++;
+            hotAccounts = (strcmp(argv[i], "off") == 0) ? NULL : argv[i];
+        } else if (strcmp(argv[i], "--hot-promote") == 0 && i + 1 < argc) {
+            hotPromote = atol(argv[++i]);
+            if (hotPromote < 1) {
+                cerr << "Error: --hot-promote must be positive" << endl;
+                return 1;
+            }
+        } else if (inputPath == NULL) {
+            inputPath = argv[i];
+        } else {
+            inputPath = NULL;
+            break;
+        }
+    }
+
+    if ((inputPath == NULL) == (servePath == NULL)) {
+        cerr << "Usage: " << argv[0] << " [--workers N] [--batch N] [--shards N] [--store files|mapped] [--store-path P]"
+             << " [--store-capacity N] [--lock-stripes N] [--lock-stats] [--lock-mode internal|flock] [--log-capacity N] [--log-spill P] [--keep-segment]"
+             << " [--wal P] [--wal-batch N] [--wal-max-latency US] [--wal-checkpoint N]"
+             << " [--cache N] [--cache-flush N] [--cache-stats] [--account-shards N] [--account-filter N] [--directory-stats] [--metrics] [--metrics-json P] [--io sync|uring] [--inquiry locked|optimistic] [--snapshot-capacity N] [--hot-accounts off|auto|ID[,ID...]] [--hot-promote N] [--verbosity silent|summary|full] <input_file | --serve P>" << endl;
+        return 1;
+    }
+    if (executionShards > 0 && (workerCount > 0 || servePath != NULL || walPath != NULL || storageBackend != STORAGE_FILES ||
+                                hotAccounts != NULL)) {
+        cerr << "Error: --shards cannot be combined with --workers, --serve, --wal, --store mapped or --hot-accounts" << endl;
         return 1;
     }
 
     // Open the input file
-    ifstream inputFile(argv[1]);
-    if (!inputFile.is_open()) {
-        cerr << "Error: Could not open input file " << argv[1] << endl;
+    InputReader inputFile;
+    if (inputPath != NULL && openInputReader(&inputFile, inputPath) != 0) {
+        cerr << "Error: Could not open input file " << inputPath << endl;
         return 1;
     }
 
-    // Generate a key for shared memory
-    key_t shm_key = ftok(".", 'x');
-    int shm_id = shmget(shm_key, sizeof(SharedMemorySegment), IPC_CREAT | 0666);
-    if (shm_id < 0) {
-        perror("Parent shmget");
+    // Attach the monitor and transaction log, reusing a segment an earlier run kept if it matches
+    SharedSegment segment;
+    if (openSharedSegment(&segment, ftok(".", 'x'), lockStripes, logCapacity, spillPath) != 0) {
         return 1;
     }
+    Monitor *monitor = segment.monitor;
+    SharedMemorySegment *shm_ptr = segment.log;
+    monitor->flock_compat = flockCompat;
+    if (printLockStats && segment.reused) {
+        resetLockTableStats(monitor);
+    }
 
-    // Attach to shared memory
-    SharedMemorySegment *shm_ptr = (SharedMemorySegment *)shmat(shm_id, NULL, 0);
-    if (shm_ptr == (SharedMemorySegment *)-1) {
-        perror("Parent shmat");
-        return 1;
+    if (storageBackend == STORAGE_MAPPED) {
+        if (openAccountStore(&(monitor->account_store), storePath, storeCapacity) != 0) {
+            return 1;
+        }
+        monitor->storage_backend = STORAGE_MAPPED;
     }
 
-    // Initialize shared memory
-    shm_ptr->transaction_count = 0;
-
-    // Initialize shared memory mutex
-    pthread_mutexattr_t shmMutexAttr;
-    pthread_mutexattr_init(&shmMutexAttr);
-    pthread_mutexattr_setpshared(&shmMutexAttr, PTHREAD_PROCESS_SHARED);
-    pthread_mutex_init(&(shm_ptr->mutex), &shmMutexAttr);
-
-    // Initialize Monitor
-    Monitor monitor;
-    initializeMonitor(&monitor, shm_ptr);
-
-    string line;
-    while (getline(inputFile, line)) {
-        stringstream ss(line);
-        string accountId, command, recipientId;
-        double amount;
-
-        ss >> accountId >> command;
-        command = toUpperCase(command); // Normalize the command
-
-        pid_t pid = fork();
-        if (pid == 0) { // Child process
-            if (command == "WITHDRAW") {
-                ss >> amount;
-                withdraw(&monitor, accountId.c_str(), amount);
-            } else if (command == "CREATE") {
-                ss >> amount;
-                createAccount(&monitor, accountId.c_str(), ("User_" + accountId).c_str(), amount);
-            } else if (command == "INQUIRY") {
-                inquiry(&monitor, accountId.c_str());
-            } else if (command == "DEPOSIT") {
-                ss >> amount;
-                deposit(&monitor, accountId.c_str(), amount);
-            } else if (command == "TRANSFER") {
-                ss >> amount >> recipientId;
-                transfer(&monitor, accountId.c_str(), amount, recipientId.c_str());
-            } else if (command == "CLOSE") {
-                closeAccount(&monitor, accountId.c_str());
-            } else {
-                cerr << "Unknown command: " << command << endl;
+    AccountCache *cache = NULL;
+    size_t cache_size = 0;
+    if (storageBackend == STORAGE_FILES && cacheCapacity > 0) {
+        uint64_t entries = 1;
+        while (entries < cacheCapacity) {
+            entries <<= 1;
+        }
+        cache_size = accountCacheSize(entries);
+        cache = (AccountCache *)mmap(NULL, cache_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (cache == MAP_FAILED) {
+            perror("Account cache mmap");
+            return 1;
+        }
+        initializeAccountCache(cache, entries, cacheFlushThreshold);
+        monitor->cache = cache;
+    }
+
+    AccountDirectory *directory = NULL;
+    size_t directory_size = 0;
+    if (storageBackend == STORAGE_FILES && (accountShards > 0 || accountFilter > 0)) {
+        uint64_t counters = 0;
+        if (accountFilter > 0) {
+            counters = 1;
+            while (counters < accountFilter) {
+                counters <<= 1;
+            }
+        }
+        directory_size = accountDirectorySize(counters);
+        directory = (AccountDirectory *)mmap(NULL, directory_size, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (directory == MAP_FAILED) {
+            perror("Account directory mmap");
+            return 1;
+        }
+        if (openAccountDirectory(directory, accountShards, counters) != 0) {
+            return 1;
+        }
+        monitor->directory = directory;
+    }
+
+    WriteAheadLog *wal = NULL;
+    if (walPath != NULL) {
+        // Finish any changes a crashed run logged but did not apply
+        long replayed = monitorRecoverAccounts(monitor, walPath);
+        if (replayed < 0) {
+            return 1;
+        }
+        if (replayed > 0) {
+            cout << "Recovered " << replayed << " changes from write-ahead log " << walPath << endl;
+        }
+
+        wal = (WriteAheadLog *)mmap(NULL, sizeof(WriteAheadLog), PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (wal == MAP_FAILED) {
+            perror("Write-ahead log mmap");
+            return 1;
+        }
+        if (openWriteAheadLog(wal, walPath, walBatchSize, walMaxLatencyUs, walCheckpointInterval) != 0) {
+            return 1;
+        }
+        monitor->wal = wal;
+    }
+
+    if (asyncIo) {
+        if (asyncIoAvailable()) {
+            monitor->async_io = true;
+            if (wal != NULL) {
+                wal->async_io = true;
             }
-            exit(0);
-        } else if (pid > 0) { // Parent process
-            wait(NULL); // Wait for child process to finish
         } else {
-            perror("Fork failed");
+            cerr << "io_uring is not available, falling back to --io sync" << endl;
         }
     }
 
+    Metrics *metrics = NULL;
+    if (printMetricsReport || metricsJsonPath != NULL) {
+        metrics = (Metrics *)mmap(NULL, sizeof(Metrics), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (metrics == MAP_FAILED) {
+            perror("Metrics mmap");
+            return 1;
+        }
+        initializeMetrics(metrics);
+        monitor->metrics = metrics;
+    }
+
+    // Shard monitors keep no snapshot table, so reports are only available without --shards
+    AccountSnapshot *snapshot = NULL;
+    size_t snapshot_size = 0;
+    if (executionShards == 0) {
+        uint64_t entries = 1;
+        while (entries < snapshotCapacity) {
+            entries <<= 1;
+        }
+        snapshot_size = accountSnapshotSize(entries);
+        snapshot = (AccountSnapshot *)mmap(NULL, snapshot_size, PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (snapshot == MAP_FAILED) {
+            perror("Account snapshot mmap");
+            return 1;
+        }
+        initializeAccountSnapshot(snapshot, entries);
+        monitor->snapshot = snapshot;
+    }
+    monitor->optimistic_reads = optimisticReads;
+
+    AccountCombiner *combiner = NULL;
+    if (hotAccounts != NULL) {
+        combiner = (AccountCombiner *)mmap(NULL, sizeof(AccountCombiner), PROT_READ | PROT_WRITE,
+                                           MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (combiner == MAP_FAILED) {
+            perror("Account combiner mmap");
+            return 1;
+        }
+        bool detect = (strcmp(hotAccounts, "auto") == 0);
+        initializeAccountCombiner(combiner, detect, hotPromote);
+        for (const char *id = hotAccounts; !detect && *id != '\0';) {
+            size_t length = strcspn(id, ",");
+            char accountId[ACCOUNT_ID_LENGTH];
+            if (length == 0 || length >= ACCOUNT_ID_LENGTH) {
+                cerr << "Error: --hot-accounts must be off, auto or a list of account IDs" << endl;
+                return 1;
+            }
+            memcpy(accountId, id, length);
+            accountId[length] = '\0';
+            if (promoteHotAccount(combiner, accountId, getAccountMutexIndex(monitor, accountId)) == NULL) {
+                cerr << "Error: --hot-accounts lists more than " << HOT_ACCOUNT_SLOTS << " accounts" << endl;
+                return 1;
+            }
+            id += length + (id[length] == ',');
+        }
+        monitor->combiner = combiner;
+    }
+
+    // Replies of the server are its messages, so only batch runs buffer them
+    EventOutput *output = NULL;
+    if (servePath == NULL) {
+        output = (EventOutput *)mmap(NULL, sizeof(EventOutput), PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (output == MAP_FAILED) {
+            perror("Event output mmap");
+            return 1;
+        }
+        initializeEventOutput(output, verbosity, STDOUT_FILENO);
+        cout.flush();
+        if (verbosity == OUTPUT_FULL && startEventWriter(output) != 0) {
+            munmap(output, sizeof(EventOutput));
+            output = NULL;
+        }
+        monitor->output = output;
+    }
+
+    if (servePath != NULL) {
+        if (runServer(monitor, servePath, (workerCount > 0) ? workerCount : DEFAULT_SERVER_WORKERS) != 0) {
+            cerr << "Error: Could not start server" << endl;
+        }
+    } else if (executionShards > 0) {
+        if (runShardEngine(monitor, &inputFile, executionShards) != 0) {
+            cerr << "Error: Could not start the shards" << endl;
+        }
+    } else if (workerCount > 0) {
+        if (runWorkerPool(monitor, &inputFile, workerCount, batchSize) != 0) {
+            cerr << "Error: Could not start worker pool" << endl;
+        }
+    } else {
+        string_view line;
+        while (nextInputLine(&inputFile, &line)) {
+            Transaction transaction;
+            string_view command;
+            ParseStatus status = parseTransaction(line, &transaction, &command);
+            if (status != PARSE_OK) {
+                if (status != PARSE_BLANK) {
+                    reportParseError(&inputFile, status, command);
+                }
+                continue;
+            }
+
+            pid_t pid = fork();
+            if (pid == 0) { // Child process
+                executeTransaction(monitor, &transaction);
+                exit(0);
+            } else if (pid > 0) { // Parent process
+                wait(NULL); // Wait for child process to finish
+            } else {
+                perror("Fork failed");
+            }
+        }
+    }
+
+    // Every process that emits messages has exited; write out what is left
+    if (output != NULL) {
+        if (verbosity == OUTPUT_FULL) {
+            stopEventWriter(output);
+        }
+        monitor->output = NULL;
+        munmap(output, sizeof(EventOutput));
+    }
+
     // Display transactions from shared memory
-    cout << "\nTransactions recorded in shared memory:\n";
-    for (int i = 0; i < shm_ptr->transaction_count; i++) {
-        TransactionRecord &record = shm_ptr->records[i];
-        cout << "Transaction Type: " << record.transaction_type
-             << ", Account ID: " << record.account_id
-             << ", Amount: " << record.amount
-             << ", Status: " << record.status
-             << ", Reason: " << record.reason
-             << ", Timestamp: " << record.timestamp << endl;
+    if (verbosity == OUTPUT_FULL) {
+        cout << "\nTransactions recorded in shared memory:\n";
+        cout.flush();
+        if (dumpTransactionLog(shm_ptr, STDOUT_FILENO) != 0) {
+            perror("Transaction log dump");
+        }
+    } else if (verbosity == OUTPUT_SUMMARY) {
+        printTransactionSummary(shm_ptr);
+    }
+
+    // Once records have overflowed to disk, make the spill file a complete log
+    if (shm_ptr->spill_count > shm_ptr->base) {
+        spillTransactions(shm_ptr);
+    }
+
+    if (metrics != NULL) {
+        if (printMetricsReport) {
+            printMetrics(metrics);
+        }
+        if (metricsJsonPath != NULL) {
+            writeMetricsJson(metrics, metricsJsonPath);
+        }
+        monitor->metrics = NULL;
+        munmap(metrics, sizeof(Metrics));
     }
 
-    // Destroy Monitor
-    destroyMonitor(&monitor);
+    if (printLockStats) {
+        LockTableStats stats;
+        getLockTableStats(monitor, &stats);
+        cout << "\nLock table: stripes=" << monitor->lock_stripes
+             << ", stripes used=" << stats.stripes_used
+             << ", acquisitions=" << stats.acquisitions
+             << ", contended=" << stats.contended
+             << ", collisions=" << stats.collisions
+             << ", wait ms=" << stats.wait_ns / 1e6 << "\n";
 
-    // Cleanup shared memory
-    shmdt(shm_ptr);
-    shmctl(shm_id, IPC_RMID, NULL);
+        if (combiner != NULL) {
+            long combined = 0, writes = 0;
+            for (int i = 0; i < combiner->hot; i++) {
+                combined += combiner->accounts[i].combined;
+                writes += combiner->accounts[i].writes;
+            }
+            cout << "Hot accounts: promoted=" << combiner->hot
+                 << ", updates combined=" << combined
+                 << ", storage writes=" << writes
+                 << ", updates per write=" << (writes > 0 ? (double)combined / writes : 0.0) << "\n";
+        }
+    }
+
+    if (printCacheStats && cache != NULL) {
+        long lookups = cache->hits + cache->misses;
+        cout << "\nAccount cache: entries=" << cache->used
+             << ", hits=" << cache->hits
+             << ", misses=" << cache->misses
+             << ", hit rate=" << (lookups > 0 ? 100.0 * cache->hits / lookups : 0.0) << "%"
+             << ", write-backs=" << cache->writebacks
+             << ", batches=" << cache->batches << "\n";
+    }
+
+    if (printDirectoryStats && directory != NULL) {
+        cout << "\nAccount directory: shards=" << directory->shards
+             << ", filter counters=" << directory->filter_size
+             << ", files indexed=" << directory->indexed
+             << ", lookups answered by filter=" << directory->filter_negatives
+             << ", false positives=" << directory->filter_false_positives << "\n";
+    }
 
-    inputFile.close();
+    if (wal != NULL) {
+        if (verbosity == OUTPUT_FULL) {
+            cout << "\nWrite-ahead log: changes=" << wal->records
+                 << ", group flushes=" << wal->flushes
+                 << ", changes per flush=" << (wal->flushes > 0 ? (double)wal->records / wal->flushes : 0.0) << "\n";
+        }
+
+        // Every change has been applied, so a final checkpoint leaves the log empty
+        monitorCheckpoint(monitor, true);
+        monitor->wal = NULL;
+        closeWriteAheadLog(wal);
+        munmap(wal, sizeof(WriteAheadLog));
+    }
+
+    // Write every cached balance back to its account file
+    if (cache != NULL) {
+        monitorFlushCache(monitor);
+        monitor->cache = NULL;
+        munmap(cache, cache_size);
+    }
+
+    if (directory != NULL) {
+        monitor->directory = NULL;
+        munmap(directory, directory_size);
+    }
+
+    if (combiner != NULL) {
+        monitor->combiner = NULL;
+        munmap(combiner, sizeof(AccountCombiner));
+    }
+
+    if (snapshot != NULL) {
+        monitor->snapshot = NULL;
+        pthread_mutex_destroy(&(snapshot->report_mutex));
+        munmap(snapshot, snapshot_size);
+    }
+
+    // Detach the monitor and transaction log (removing them unless --keep-segment)
+    closeAccountStore(&(monitor->account_store));
+    closeSharedSegment(&segment, keepSegment);
+
+    if (inputPath != NULL) {
+        closeInputReader(&inputFile);
+    }
     return 0;
 }
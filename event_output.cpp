@@ -0,0 +1,296 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "event_output.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define EVENT_WRITER_MIN_SLEEP_NS 50000L    // Writer's first sleep once the buffers are empty
+#define EVENT_WRITER_MAX_SLEEP_NS 2000000L  // Longest sleep between looks while idle
+
+// Buffer this process appends to (see selectEventProducer)
+static int event_producer = 0;
+
+/**
+ * @brief Prepares an empty event output.
+ *
+ * @param output Pointer to the output, which must live in shared memory.
+ * @param verbosity How much is printed.
+ * @param fd Where the writer writes the messages.
+ */
+void initializeEventOutput(EventOutput *output, OutputVerbosity verbosity, int fd) {
+    output->verbosity = verbosity;
+    output->fd = fd;
+    output->stopping = 0;
+    output->bytes_written = 0;
+    output->writes = 0;
+    for (int i = 0; i < EVENT_PRODUCERS; i++) {
+        output->buffers[i].tail = 0;
+        output->buffers[i].events = 0;
+        output->buffers[i].head = 0;
+    }
+}
+
+/**
+ * @brief Picks the buffer this process appends its messages to.
+ *
+ * Each buffer must have one producer at a time: worker i uses buffer i + 1,
+ * and the one-at-a-time children of the serial driver share buffer 0.
+ *
+ * @param producer The buffer index.
+ */
+void selectEventProducer(int producer) {
+    event_producer = producer % EVENT_PRODUCERS;
+}
+
+/**
+ * @brief Writes gathered messages out and counts the write.
+ */
+static void writeEvents(EventOutput *output, const char *data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    if (writeFully(output->fd, data, length) == -1) {
+        perror("Event output");
+    }
+    output->bytes_written += length;
+    output->writes++;
+}
+
+/**
+ * @brief Moves everything the producers have appended to the output.
+ *
+ * Whole buffers are gathered into one write of up to EVENT_WRITE_SIZE bytes.
+ * Producers only publish complete lines, so lines of different producers
+ * are never mixed.
+ *
+ * @param output Pointer to the event output.
+ * @param staged Scratch space of EVENT_WRITE_SIZE bytes.
+ * @return Number of bytes moved.
+ */
+static size_t drainEventBuffers(EventOutput *output, char *staged) {
+    size_t total = 0;
+    size_t stagedLength = 0;
+    for (int i = 0; i < EVENT_PRODUCERS; i++) {
+        EventBuffer *buffer = &(output->buffers[i]);
+        long head = buffer->head;
+        long tail = __atomic_load_n(&(buffer->tail), __ATOMIC_ACQUIRE);
+        size_t length = tail - head;
+        if (length == 0) {
+            continue;
+        }
+        // A buffer never holds more than EVENT_WRITE_SIZE bytes, so it fits once the stage is written
+        if (stagedLength + length > EVENT_WRITE_SIZE) {
+            writeEvents(output, staged, stagedLength);
+            stagedLength = 0;
+        }
+        size_t offset = head % EVENT_BUFFER_SIZE;
+        size_t first = (length < EVENT_BUFFER_SIZE - offset) ? length : EVENT_BUFFER_SIZE - offset;
+        memcpy(staged + stagedLength, buffer->data + offset, first);
+        memcpy(staged + stagedLength + first, buffer->data, length - first);
+        stagedLength += length;
+        __atomic_store_n(&(buffer->head), tail, __ATOMIC_RELEASE);
+        total += length;
+    }
+    writeEvents(output, staged, stagedLength);
+    return total;
+}
+
+/**
+ * @brief Body of the writer thread: drains the buffers until stopped and empty.
+ */
+static void *eventWriterLoop(void *argument) {
+    EventOutput *output = (EventOutput *)argument;
+    static char staged[EVENT_WRITE_SIZE];
+    long sleepNs = EVENT_WRITER_MIN_SLEEP_NS;
+    while (true) {
+        // Read before draining, so everything appended before the stop is written
+        bool stopping = __atomic_load_n(&(output->stopping), __ATOMIC_ACQUIRE);
+        if (drainEventBuffers(output, staged) > 0) {
+            sleepNs = EVENT_WRITER_MIN_SLEEP_NS;
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        timespec pause = {0, sleepNs};
+        nanosleep(&pause, NULL);
+        sleepNs = (sleepNs * 2 < EVENT_WRITER_MAX_SLEEP_NS) ? sleepNs * 2 : EVENT_WRITER_MAX_SLEEP_NS;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Starts the writer thread in the calling (driver) process.
+ *
+ * Start it before forking the processes that emit events; they do not
+ * inherit the thread, only the shared buffers.
+ *
+ * @param output Pointer to the event output.
+ * @return 0 on success, or -1 if the thread could not be started.
+ */
+int startEventWriter(EventOutput *output) {
+    fflush(stdout);
+    int error = pthread_create(&(output->writer), NULL, eventWriterLoop, output);
+    if (error != 0) {
+        fprintf(stderr, "Event writer: %s\n", strerror(error));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes out every pending message and stops the writer thread.
+ *
+ * Call once no process will emit events any more.
+ *
+ * @param output Pointer to the event output.
+ */
+void stopEventWriter(EventOutput *output) {
+    __atomic_store_n(&(output->stopping), 1, __ATOMIC_RELEASE);
+    pthread_join(output->writer, NULL);
+}
+
+/**
+ * @brief Appends a complete message to this process's buffer, waiting for the writer while it is full.
+ */
+static void appendEvent(EventOutput *output, const char *text, size_t length) {
+    EventBuffer *buffer = &(output->buffers[event_producer]);
+    long tail = buffer->tail;
+    while (tail + (long)length - __atomic_load_n(&(buffer->head), __ATOMIC_ACQUIRE) > EVENT_BUFFER_SIZE) {
+        sched_yield();
+    }
+    size_t offset = tail % EVENT_BUFFER_SIZE;
+    size_t first = (length < EVENT_BUFFER_SIZE - offset) ? length : EVENT_BUFFER_SIZE - offset;
+    memcpy(buffer->data + offset, text, first);
+    memcpy(buffer->data, text + first, length - first);
+    buffer->events++;
+    __atomic_store_n(&(buffer->tail), tail + (long)length, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Emits a transaction or queue message.
+ *
+ * Without an event output the message is printed to stdout as before (the
+ * server captures it there as the reply); otherwise it is appended to this
+ * process's buffer if the verbosity is full and dropped if not. The
+ * message should end with a newline.
+ *
+ * @param output The event output, or NULL to print directly.
+ * @param format printf-style format of the message.
+ */
+void emitEvent(EventOutput *output, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (output == NULL) {
+        vprintf(format, args);
+        va_end(args);
+        return;
+    }
+    if (output->verbosity != OUTPUT_FULL) {
+        va_end(args);
+        return;
+    }
+    char line[EVENT_LINE_LENGTH];
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    if (length >= (int)sizeof(line)) {
+        length = sizeof(line) - 1;
+        line[length - 1] = '\n';
+    }
+    appendEvent(output, line, length);
+}
+
+/**
+ * @brief Returns the number of messages emitted so far.
+ */
+long eventCount(const EventOutput *output) {
+    long count = 0;
+    for (int i = 0; i < EVENT_PRODUCERS; i++) {
+        count += __atomic_load_n(&(output->buffers[i].events), __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+/**
+ * @brief Writes every record of the log, one line each, in large writes.
+ *
+ * The lines are the ones formatTransaction produces; the timestamp text is
+ * only rebuilt when the second changes.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param fd Where the lines are written.
+ * @return 0 on success, or -1 if writing failed.
+ */
+int dumpTransactionLog(SharedMemorySegment *shm_ptr, int fd) {
+    static char text[EVENT_WRITE_SIZE];
+    size_t length = 0;
+    int64_t second = -1;
+    char timestamp[TIMESTAMP_LENGTH];
+    int result = 0;
+
+    TransactionLogReader reader;
+    TransactionRecord record;
+    openTransactionLogReader(&reader, shm_ptr);
+    while (nextTransaction(&reader, &record) && result == 0) {
+        if (record.timestamp_ns / 1000000000LL != second) {
+            second = record.timestamp_ns / 1000000000LL;
+            formatTimestamp(record.timestamp_ns, timestamp);
+        }
+        if (sizeof(text) - length < RECORD_TEXT_LENGTH + 1) {
+            result = writeFully(fd, text, length);
+            length = 0;
+        }
+        int written = formatTransactionAt(&record, timestamp, text + length, RECORD_TEXT_LENGTH);
+        length += (written < RECORD_TEXT_LENGTH) ? written : RECORD_TEXT_LENGTH - 1;
+        text[length++] = '\n';
+    }
+    closeTransactionLogReader(&reader);
+    if (result == 0) {
+        result = writeFully(fd, text, length);
+    }
+    return result;
+}
+
+/**
+ * @brief Prints how many logged transactions of each type succeeded and failed.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ */
+void printTransactionSummary(SharedMemorySegment *shm_ptr) {
+    long counts[TXN_TYPE_COUNT][TXN_STATUS_COUNT];
+    memset(counts, 0, sizeof(counts));
+
+    TransactionLogReader reader;
+    TransactionRecord record;
+    openTransactionLogReader(&reader, shm_ptr);
+    while (nextTransaction(&reader, &record)) {
+        if (record.transaction_type < TXN_TYPE_COUNT && record.status < TXN_STATUS_COUNT) {
+            counts[record.transaction_type][record.status]++;
+        }
+    }
+    closeTransactionLogReader(&reader);
+
+    long succeeded = 0, failed = 0;
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        succeeded += counts[type][TXN_SUCCESS];
+        failed += counts[type][TXN_FAILED];
+    }
+    printf("\nTransactions recorded in shared memory: %ld (%ld succeeded, %ld failed)\n",
+           succeeded + failed, succeeded, failed);
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        if (counts[type][TXN_SUCCESS] + counts[type][TXN_FAILED] > 0) {
+            printf("  %s: %ld succeeded, %ld failed\n", transactionTypeName((TransactionType)type),
+                   counts[type][TXN_SUCCESS], counts[type][TXN_FAILED]);
+        }
+    }
+}
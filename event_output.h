@@ -0,0 +1,55 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef EVENT_OUTPUT_H
+#define EVENT_OUTPUT_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include "sharedmemory.h"
+
+#define EVENT_PRODUCERS 65              // Slot 0 for the driver's own children, one per worker (MAX_WORKERS)
+#define EVENT_BUFFER_SIZE (1 << 16)     // Bytes of messages one producer can have waiting
+#define EVENT_LINE_LENGTH 256           // Longest message line
+#define EVENT_WRITE_SIZE (1 << 16)      // Bytes the writer gathers into one write
+
+// How much the driver prints
+enum OutputVerbosity {
+    OUTPUT_SILENT,   // Only what was asked for explicitly (statistics, metrics)
+    OUTPUT_SUMMARY,  // Outcome counts instead of per-transaction messages and the log dump
+    OUTPUT_FULL      // Every transaction message, queue message and logged record
+};
+
+// Single-producer, single-consumer byte ring; the producer only moves tail and
+// the writer only moves head, each on its own cache line
+struct EventBuffer {
+    alignas(64) long tail;   // Bytes appended so far (written by the producer)
+    long events;             // Messages appended (written by the producer)
+    alignas(64) long head;   // Bytes written out so far (written by the writer)
+    char data[EVENT_BUFFER_SIZE];
+};
+
+// Transaction messages on their way to the output, in memory shared by every
+// process; a writer thread in the driver drains the buffers in bulk
+struct EventOutput {
+    OutputVerbosity verbosity;
+    int fd;               // Where the writer writes
+    int stopping;         // Set once every producer has finished; the writer drains and exits
+    long bytes_written;   // Written by the writer
+    long writes;          // write calls made by the writer
+    pthread_t writer;     // Valid in the driver process only
+    EventBuffer buffers[EVENT_PRODUCERS];
+};
+
+void initializeEventOutput(EventOutput *output, OutputVerbosity verbosity, int fd);
+int startEventWriter(EventOutput *output);
+void stopEventWriter(EventOutput *output);
+void selectEventProducer(int producer);
+void emitEvent(EventOutput *output, const char *format, ...) __attribute__((format(printf, 2, 3)));
+long eventCount(const EventOutput *output);
+int dumpTransactionLog(SharedMemorySegment *shm_ptr, int fd);
+void printTransactionSummary(SharedMemorySegment *shm_ptr);
+
+#endif // EVENT_OUTPUT_H
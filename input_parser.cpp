@@ -0,0 +1,343 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "input_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/**
+ * @brief Maps an input file into memory so lines can be parsed in place.
+ *
+ * Inputs that cannot be mapped (pipes, /dev/stdin) are read into one heap buffer instead.
+ *
+ * @param reader Receives the open reader.
+ * @param path Path of the input file.
+ * @return 0 on success, or -1 if the file could not be opened or read.
+ */
+int openInputReader(InputReader *reader, const char *path) {
+    reader->data = NULL;
+    reader->size = 0;
+    reader->position = 0;
+    reader->line_number = 0;
+    reader->mapped = false;
+
+    reader->fd = open(path, O_RDONLY);
+    if (reader->fd == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(reader->fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            return 0;
+        }
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, st.st_size, MADV_SEQUENTIAL);
+            reader->data = (const char *)data;
+            reader->size = st.st_size;
+            reader->mapped = true;
+            return 0;
+        }
+    }
+
+    size_t capacity = 0;
+    char *buffer = NULL;
+    for (;;) {
+        if (reader->size == capacity) {
+            capacity = (capacity == 0) ? (1 << 20) : capacity * 2;
+            char *grown = (char *)realloc(buffer, capacity);
+            if (grown == NULL) {
+                free(buffer);
+                close(reader->fd);
+                return -1;
+            }
+            buffer = grown;
+        }
+        ssize_t bytesRead = read(reader->fd, buffer + reader->size, capacity - reader->size);
+        if (bytesRead <= 0) {
+            break;
+        }
+        reader->size += bytesRead;
+    }
+    reader->data = buffer;
+    return 0;
+}
+
+/**
+ * @brief Unmaps (or frees) the input and closes the file.
+ *
+ * @param reader Pointer to the reader.
+ */
+void closeInputReader(InputReader *reader) {
+    if (reader->mapped) {
+        munmap((void *)reader->data, reader->size);
+    } else {
+        free((void *)reader->data);
+    }
+    close(reader->fd);
+    reader->data = NULL;
+}
+
+/**
+ * @brief Returns the next line of the input, without copying it.
+ *
+ * @param reader Pointer to the reader.
+ * @param line Receives the line (without its newline); valid until the reader is closed.
+ * @return true if a line was returned, false at the end of the input.
+ */
+bool nextInputLine(InputReader *reader, string_view *line) {
+    if (reader->position >= reader->size) {
+        return false;
+    }
+    const char *start = reader->data + reader->position;
+    size_t remaining = reader->size - reader->position;
+    const char *newline = (const char *)memchr(start, '\n', remaining);
+    size_t length = (newline != NULL) ? (size_t)(newline - start) : remaining;
+
+    *line = string_view(start, length);
+    reader->position += length + 1;
+    reader->line_number++;
+    return true;
+}
+
+/**
+ * @brief Returns the next whitespace-separated token of a line.
+ *
+ * @param line The line being tokenized.
+ * @param position Offset to start from; advanced past the token.
+ * @return The token, or an empty view at the end of the line.
+ */
+static string_view nextToken(string_view line, size_t *position) {
+    size_t i = *position;
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r' ||
+                               line[i] == '\v' || line[i] == '\f')) {
+        i++;
+    }
+    size_t start = i;
+    while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r' &&
+           line[i] != '\v' && line[i] != '\f') {
+        i++;
+    }
+    *position = i;
+    return line.substr(start, i - start);
+}
+
+/**
+ * @brief Compares a word of the same length against an uppercase keyword, ignoring case.
+ *
+ * Clearing bit 0x20 folds only 'a'-'z' onto 'A'-'Z', so no other byte can match a letter.
+ */
+static bool matchesKeyword(string_view word, const char *keyword) {
+    for (size_t i = 0; i < word.size(); i++) {
+        if ((word[i] & ~0x20) != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Recognizes a command word in any letter case.
+ *
+ * The word's length and first letter select the single keyword it can be,
+ * so each word is compared against at most one keyword.
+ *
+ * @param word The command word from the input line.
+ * @return The command, or CMD_UNKNOWN.
+ */
+CommandType recognizeCommand(string_view word) {
+    switch (word.size()) {
+        case 5:
+            return matchesKeyword(word, "CLOSE") ? CMD_CLOSE : CMD_UNKNOWN;
+        case 6:
+            if ((word[0] & ~0x20) == 'R') {
+                return matchesKeyword(word, "REPORT") ? CMD_REPORT : CMD_UNKNOWN;
+            }
+            return matchesKeyword(word, "CREATE") ? CMD_CREATE : CMD_UNKNOWN;
+        case 7:
+            if ((word[0] & ~0x20) == 'D') {
+                return matchesKeyword(word, "DEPOSIT") ? CMD_DEPOSIT : CMD_UNKNOWN;
+            }
+            return matchesKeyword(word, "INQUIRY") ? CMD_INQUIRY : CMD_UNKNOWN;
+        case 8:
+            if ((word[0] & ~0x20) == 'W') {
+                return matchesKeyword(word, "WITHDRAW") ? CMD_WITHDRAW : CMD_UNKNOWN;
+            }
+            return matchesKeyword(word, "TRANSFER") ? CMD_TRANSFER : CMD_UNKNOWN;
+        case 9:
+            return matchesKeyword(word, "STATEMENT") ? CMD_STATEMENT : CMD_UNKNOWN;
+        default:
+            return CMD_UNKNOWN;
+    }
+}
+
+/**
+ * @brief Copies an account ID token into a fixed-size field.
+ *
+ * @return false if the ID is too long for the field.
+ */
+static bool copyAccountId(char *field, string_view id) {
+    if (id.size() >= ACCOUNT_ID_LENGTH) {
+        return false;
+    }
+    memcpy(field, id.data(), id.size());
+    field[id.size()] = '\0';
+    return true;
+}
+
+/**
+ * @brief Parses a non-negative decimal integer token.
+ *
+ * @return false if the token is empty, has a non-digit or is too large.
+ */
+static bool parseCount(string_view token, int64_t *value) {
+    if (token.empty() || token.size() > 18) {
+        return false;
+    }
+    int64_t result = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        result = result * 10 + (c - '0');
+    }
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief Parses a statement's arguments: nothing, a record count, or a time range.
+ *
+ * "Statement" asks for the last DEFAULT_STATEMENT_RECORDS records,
+ * "Statement N" for the last N, and "Statement FROM TO" for the records
+ * between two times in whole seconds since the Unix epoch (inclusive,
+ * at most MAX_STATEMENT_RECORDS of them).
+ *
+ * @return PARSE_OK or PARSE_BAD_STATEMENT.
+ */
+static ParseStatus parseStatement(string_view line, size_t position, StatementQuery *query) {
+    string_view first = nextToken(line, &position);
+    string_view second = nextToken(line, &position);
+    int64_t count = DEFAULT_STATEMENT_RECORDS;
+    query->from_ns = 0;
+    query->to_ns = INT64_MAX;
+    if (!second.empty()) {
+        int64_t from, to;
+        if (!parseCount(first, &from) || !parseCount(second, &to) || from > to ||
+            to > INT64_MAX / 1000000000LL - 1) {
+            return PARSE_BAD_STATEMENT;
+        }
+        query->from_ns = from * 1000000000LL;
+        query->to_ns = (to + 1) * 1000000000LL - 1;
+        count = MAX_STATEMENT_RECORDS;
+    } else if (!first.empty()) {
+        if (!parseCount(first, &count) || count < 1 || count > MAX_STATEMENT_RECORDS) {
+            return PARSE_BAD_STATEMENT;
+        }
+    }
+    query->limit = count;
+    return PARSE_OK;
+}
+
+/**
+ * @brief Parses one input line into a transaction without allocating.
+ *
+ * @param line The input line, e.g. "Alice Transfer 40 Bob", or "Report".
+ * @param transaction Receives the parsed transaction. Its ticket is left untouched.
+ * @param command Receives the command word as written, for error reporting.
+ * @return PARSE_OK, PARSE_BLANK for an empty line, or the reason the line is malformed.
+ */
+ParseStatus parseTransaction(string_view line, Transaction *transaction, string_view *command) {
+    size_t position = 0;
+    string_view accountId = nextToken(line, &position);
+    *command = nextToken(line, &position);
+    if (accountId.empty()) {
+        return PARSE_BLANK;
+    }
+    if (command->empty() && recognizeCommand(accountId) == CMD_REPORT) {
+        // The only command without an account
+        *command = accountId;
+        transaction->command = CMD_REPORT;
+        transaction->account_id[0] = '\0';
+        transaction->recipient_account_id[0] = '\0';
+        transaction->amount = 0;
+        return PARSE_OK;
+    }
+
+    transaction->command = recognizeCommand(*command);
+    if (transaction->command == CMD_UNKNOWN || transaction->command == CMD_REPORT) {
+        return PARSE_UNKNOWN_COMMAND;
+    }
+    if (!copyAccountId(transaction->account_id, accountId)) {
+        return PARSE_ID_TOO_LONG;
+    }
+
+    transaction->amount = 0;
+    transaction->recipient_account_id[0] = '\0';
+    if (transaction->command == CMD_INQUIRY || transaction->command == CMD_CLOSE) {
+        return PARSE_OK;
+    }
+    if (transaction->command == CMD_STATEMENT) {
+        return parseStatement(line, position, &(transaction->statement));
+    }
+
+    string_view amount = nextToken(line, &position);
+    if (amount.empty()) {
+        return PARSE_MISSING_FIELD;
+    }
+    if (!parseMoney(amount.data(), amount.size(), &(transaction->amount))) {
+        return PARSE_BAD_AMOUNT;
+    }
+
+    if (transaction->command == CMD_TRANSFER) {
+        string_view recipientId = nextToken(line, &position);
+        if (recipientId.empty()) {
+            return PARSE_MISSING_FIELD;
+        }
+        if (!copyAccountId(transaction->recipient_account_id, recipientId)) {
+            return PARSE_ID_TOO_LONG;
+        }
+    }
+    return PARSE_OK;
+}
+
+/**
+ * @brief Describes why a line could not be parsed.
+ */
+const char *parseStatusMessage(ParseStatus status) {
+    switch (status) {
+        case PARSE_OK: return "ok";
+        case PARSE_BLANK: return "blank line";
+        case PARSE_UNKNOWN_COMMAND: return "unknown command";
+        case PARSE_MISSING_FIELD: return "missing amount or recipient";
+        case PARSE_BAD_AMOUNT: return "amount is not a number";
+        case PARSE_ID_TOO_LONG: return "account ID too long";
+        case PARSE_BAD_STATEMENT: return "statement needs a count (1-1000) or a FROM TO range in epoch seconds";
+    }
+    return "malformed line";
+}
+
+/**
+ * @brief Reports a malformed input line, with its line number, on stderr.
+ *
+ * @param reader The reader the line came from.
+ * @param status The parse result.
+ * @param command The command word of the line.
+ */
+void reportParseError(const InputReader *reader, ParseStatus status, string_view command) {
+    if (status == PARSE_UNKNOWN_COMMAND) {
+        fprintf(stderr, "Line %ld: Unknown command: %.*s\n", reader->line_number, (int)command.size(), command.data());
+    } else {
+        fprintf(stderr, "Line %ld: %s\n", reader->line_number, parseStatusMessage(status));
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef INPUT_PARSER_H
+#define INPUT_PARSER_H
+
+#include <stddef.h>
+#include <string_view>
+#include "monitor.h"
+
+// Commands understood by the driver
+enum CommandType {
+    CMD_UNKNOWN,
+    CMD_CREATE,
+    CMD_DEPOSIT,
+    CMD_WITHDRAW,
+    CMD_INQUIRY,
+    CMD_TRANSFER,
+    CMD_CLOSE,
+    CMD_STATEMENT,
+    CMD_REPORT       // "Report" on a line of its own: every account's balance at one point in time
+};
+
+// A parsed input line
+struct Transaction {
+    CommandType command;
+    char account_id[ACCOUNT_ID_LENGTH];           // Empty for REPORT
+    char recipient_account_id[ACCOUNT_ID_LENGTH]; // For TRANSFER transactions
+    Money amount;
+    StatementQuery statement; // For STATEMENT transactions
+    MonitorTicket ticket; // Admission tickets, reserved in input order by the parser
+};
+
+// Outcome of parsing one input line
+enum ParseStatus {
+    PARSE_OK,
+    PARSE_BLANK,            // Nothing but whitespace; skipped silently
+    PARSE_UNKNOWN_COMMAND,
+    PARSE_MISSING_FIELD,    // Amount or recipient missing
+    PARSE_BAD_AMOUNT,       // Amount is not a number
+    PARSE_ID_TOO_LONG,      // Account ID does not fit in ACCOUNT_ID_LENGTH - 1 characters
+    PARSE_BAD_STATEMENT     // Statement count or time range is not valid
+};
+
+// Input file mapped into memory and split into lines in place
+struct InputReader {
+    const char *data;
+    size_t size;
+    size_t position;   // Offset of the next unread line
+    long line_number;  // Number of the line returned last (1-based)
+    int fd;
+    bool mapped;       // data is a file mapping (otherwise a heap buffer)
+};
+
+int openInputReader(InputReader *reader, const char *path);
+void closeInputReader(InputReader *reader);
+bool nextInputLine(InputReader *reader, std::string_view *line);
+CommandType recognizeCommand(std::string_view word);
+ParseStatus parseTransaction(std::string_view line, Transaction *transaction, std::string_view *command);
+const char *parseStatusMessage(ParseStatus status);
+void reportParseError(const InputReader *reader, ParseStatus status, std::string_view command);
+
+#endif // INPUT_PARSER_H
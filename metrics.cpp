@@ -0,0 +1,266 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "metrics.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const char *const METRIC_PHASE_NAMES[PHASE_COUNT] = {
+    "queue_wait", "lock_wait", "storage_read", "storage_write", "log_append", "total"
+};
+
+/**
+ * @brief Phase times of the transaction this process is running, reported by metricsEndTransaction.
+ */
+static long transaction_start_ns = 0;
+static long phase_ns[PHASE_COUNT];
+static bool phase_seen[PHASE_COUNT];
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds.
+ */
+static long monotonicNanoseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+/**
+ * @brief Maps a latency onto its histogram bucket.
+ *
+ * Values below HISTOGRAM_SUB_BUCKETS get a bucket each; above that, every
+ * power of two is split into HISTOGRAM_SUB_BUCKETS equal buckets.
+ */
+static int histogramBucket(uint64_t value) {
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return (int)value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - HISTOGRAM_SUB_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (int)((value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief Returns the largest latency that maps onto a bucket.
+ */
+static long histogramBucketLimit(int bucket) {
+    if (bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t sub = bucket % HISTOGRAM_SUB_BUCKETS;
+    uint64_t limit = ((HISTOGRAM_SUB_BUCKETS + sub + 1) << shift) - 1;
+    return (limit > (uint64_t)INT64_MAX) ? INT64_MAX : (long)limit;
+}
+
+/**
+ * @brief Clears every histogram and counter.
+ *
+ * @param metrics Pointer to the metrics, which must live in shared memory.
+ */
+void initializeMetrics(Metrics *metrics) {
+    memset(metrics, 0, sizeof(*metrics));
+}
+
+/**
+ * @brief Starts timing a phase.
+ *
+ * @param metrics Pointer to the metrics, or NULL if metrics are disabled.
+ * @return The start time to pass to metricsAddPhase (0 when disabled, so the clock is never read).
+ */
+long metricsStart(const Metrics *metrics) {
+    return (metrics != NULL) ? monotonicNanoseconds() : 0;
+}
+
+/**
+ * @brief Adds the time since startNs to a phase of the current transaction.
+ *
+ * @param metrics Pointer to the metrics, or NULL if metrics are disabled.
+ * @param phase The phase that just finished.
+ * @param startNs Value returned by metricsStart when the phase began.
+ */
+void metricsAddPhase(Metrics *metrics, MetricPhase phase, long startNs) {
+    if (metrics != NULL) {
+        phase_ns[phase] += monotonicNanoseconds() - startNs;
+        phase_seen[phase] = true;
+    }
+}
+
+/**
+ * @brief Starts timing a new transaction in this process.
+ *
+ * @param metrics Pointer to the metrics, or NULL if metrics are disabled.
+ */
+void metricsBeginTransaction(Metrics *metrics) {
+    if (metrics != NULL) {
+        memset(phase_ns, 0, sizeof(phase_ns));
+        memset(phase_seen, 0, sizeof(phase_seen));
+        transaction_start_ns = monotonicNanoseconds();
+    }
+}
+
+/**
+ * @brief Records the phases of the finished transaction and counts its outcome.
+ *
+ * @param metrics Pointer to the metrics, or NULL if metrics are disabled.
+ * @param type The transaction's type.
+ * @param reason The transaction's reason (REASON_NONE on success).
+ */
+void metricsEndTransaction(Metrics *metrics, TransactionType type, TransactionReason reason) {
+    if (metrics == NULL) {
+        return;
+    }
+    phase_ns[PHASE_TOTAL] = monotonicNanoseconds() - transaction_start_ns;
+    phase_seen[PHASE_TOTAL] = true;
+
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        if (phase_seen[phase]) {
+            recordLatency(&(metrics->latency[type][phase]), phase_ns[phase]);
+        }
+    }
+    __atomic_add_fetch(&(metrics->outcomes[type][reason]), 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Adds one latency to a histogram without locking.
+ *
+ * @param histogram Pointer to the histogram.
+ * @param nanoseconds The latency.
+ */
+void recordLatency(LatencyHistogram *histogram, long nanoseconds) {
+    if (nanoseconds < 0) {
+        nanoseconds = 0;
+    }
+    __atomic_add_fetch(&(histogram->buckets[histogramBucket(nanoseconds)]), 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&(histogram->count), 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&(histogram->sum_ns), nanoseconds, __ATOMIC_RELAXED);
+
+    long max = __atomic_load_n(&(histogram->max_ns), __ATOMIC_RELAXED);
+    while (nanoseconds > max &&
+           !__atomic_compare_exchange_n(&(histogram->max_ns), &max, nanoseconds, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @brief Returns a percentile of a histogram (within the bucket resolution).
+ *
+ * @param histogram Pointer to the histogram.
+ * @param percentile Percentile between 0 and 100.
+ * @return The latency in nanoseconds, or 0 if the histogram is empty.
+ */
+long histogramPercentile(const LatencyHistogram *histogram, double percentile) {
+    if (histogram->count == 0) {
+        return 0;
+    }
+    long rank = (long)(percentile / 100.0 * histogram->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    long seen = 0;
+    for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank) {
+            long limit = histogramBucketLimit(bucket);
+            return (limit < histogram->max_ns) ? limit : histogram->max_ns;
+        }
+    }
+    return histogram->max_ns;
+}
+
+/**
+ * @brief Returns the name of a phase as used in the metrics output.
+ */
+const char *metricPhaseName(MetricPhase phase) {
+    return (phase >= 0 && phase < PHASE_COUNT) ? METRIC_PHASE_NAMES[phase] : "unknown";
+}
+
+/**
+ * @brief Prints latency percentiles per type and phase, then outcome counts per type and reason.
+ *
+ * @param metrics Pointer to the metrics.
+ */
+void printMetrics(const Metrics *metrics) {
+    printf("\nLatency (microseconds):\n");
+    printf("%-10s %-14s %10s %10s %10s %10s %10s %10s\n", "Type", "Phase", "Count", "Mean", "p50", "p90", "p99", "Max");
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            const LatencyHistogram *histogram = &(metrics->latency[type][phase]);
+            if (histogram->count == 0) {
+                continue;
+            }
+            printf("%-10s %-14s %10ld %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                   transactionTypeName((TransactionType)type), metricPhaseName((MetricPhase)phase),
+                   histogram->count, histogram->sum_ns / 1e3 / histogram->count,
+                   histogramPercentile(histogram, 50) / 1e3, histogramPercentile(histogram, 90) / 1e3,
+                   histogramPercentile(histogram, 99) / 1e3, histogram->max_ns / 1e3);
+        }
+    }
+
+    printf("\nOutcomes:\n");
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        for (int reason = 0; reason < REASON_COUNT; reason++) {
+            long count = metrics->outcomes[type][reason];
+            if (count > 0) {
+                printf("%-10s %-28s %10ld\n", transactionTypeName((TransactionType)type),
+                       (reason == REASON_NONE) ? "Success" : transactionReasonName((TransactionReason)reason), count);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Writes the metrics as a JSON document.
+ *
+ * @param metrics Pointer to the metrics.
+ * @param path Path of the output file.
+ * @return 0 on success, or -1 if the file could not be written.
+ */
+int writeMetricsJson(const Metrics *metrics, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Error writing metrics file: %s\n", path);
+        return -1;
+    }
+
+    fprintf(file, "{\n  \"latency\": [");
+    bool first = true;
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            const LatencyHistogram *histogram = &(metrics->latency[type][phase]);
+            if (histogram->count == 0) {
+                continue;
+            }
+            fprintf(file, "%s\n    {\"type\": \"%s\", \"phase\": \"%s\", \"count\": %ld, \"mean_ns\": %ld, "
+                          "\"p50_ns\": %ld, \"p90_ns\": %ld, \"p99_ns\": %ld, \"p999_ns\": %ld, \"max_ns\": %ld}",
+                    first ? "" : ",", transactionTypeName((TransactionType)type), metricPhaseName((MetricPhase)phase),
+                    histogram->count, histogram->sum_ns / histogram->count,
+                    histogramPercentile(histogram, 50), histogramPercentile(histogram, 90),
+                    histogramPercentile(histogram, 99), histogramPercentile(histogram, 99.9), histogram->max_ns);
+            first = false;
+        }
+    }
+
+    fprintf(file, "\n  ],\n  \"outcomes\": [");
+    first = true;
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        for (int reason = 0; reason < REASON_COUNT; reason++) {
+            long count = metrics->outcomes[type][reason];
+            if (count == 0) {
+                continue;
+            }
+            fprintf(file, "%s\n    {\"type\": \"%s\", \"status\": \"%s\", \"reason\": \"%s\", \"count\": %ld}",
+                    first ? "" : ",", transactionTypeName((TransactionType)type),
+                    (reason == REASON_NONE) ? "SUCCESS" : "FAILED",
+                    transactionReasonName((TransactionReason)reason), count);
+            first = false;
+        }
+    }
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+    return 0;
+}
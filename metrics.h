@@ -0,0 +1,52 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include "sharedmemory.h"
+
+#define HISTOGRAM_SUB_BITS 4                            // 16 sub-buckets per power of two (about 6% resolution)
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+// Phases of a transaction that are timed separately
+enum MetricPhase {
+    PHASE_QUEUE_WAIT,     // enterMonitor until admitted
+    PHASE_LOCK_WAIT,      // Locking the account stripes
+    PHASE_STORAGE_READ,   // Reading balances
+    PHASE_STORAGE_WRITE,  // Writing balances, creating and deleting accounts (including the WAL commit)
+    PHASE_LOG_APPEND,     // Appending the transaction record to the shared log
+    PHASE_TOTAL,          // enterMonitor until the record is appended
+    PHASE_COUNT
+};
+
+// Log-linear (HDR-style) latency histogram in nanoseconds; every field is updated atomically
+struct LatencyHistogram {
+    long count;
+    long sum_ns;
+    long max_ns;
+    long buckets[HISTOGRAM_BUCKETS];
+};
+
+// Metrics shared by every process (must live in shared memory)
+struct Metrics {
+    LatencyHistogram latency[TXN_TYPE_COUNT][PHASE_COUNT];
+    long outcomes[TXN_TYPE_COUNT][REASON_COUNT];  // Transactions by type and reason (REASON_NONE = success)
+};
+
+void initializeMetrics(Metrics *metrics);
+long metricsStart(const Metrics *metrics);
+void metricsAddPhase(Metrics *metrics, MetricPhase phase, long startNs);
+void metricsBeginTransaction(Metrics *metrics);
+void metricsEndTransaction(Metrics *metrics, TransactionType type, TransactionReason reason);
+void recordLatency(LatencyHistogram *histogram, long nanoseconds);
+long histogramPercentile(const LatencyHistogram *histogram, double percentile);
+const char *metricPhaseName(MetricPhase phase);
+void printMetrics(const Metrics *metrics);
+int writeMetricsJson(const Metrics *metrics, const char *path);
+
+#endif // METRICS_H
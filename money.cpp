@@ -0,0 +1,132 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "money.h"
+#include <string.h>
+
+/**
+ * @brief Formats an amount with exactly MONEY_DECIMALS decimals, e.g. 150 as "1.50".
+ *
+ * Produces the same text as printf("%.2lf") did for double balances, using
+ * integer arithmetic only.
+ *
+ * @param amount The amount.
+ * @param buffer Receives the text; must hold MONEY_TEXT_LENGTH bytes.
+ * @return The length of the text.
+ */
+int formatMoney(Money amount, char *buffer) {
+    char digits[MONEY_TEXT_LENGTH];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+
+    uint64_t magnitude = (amount < 0) ? 0 - (uint64_t)amount : (uint64_t)amount;
+    uint64_t whole = magnitude / MONEY_SCALE;
+    uint64_t fraction = magnitude % MONEY_SCALE;
+
+    for (int i = 0; i < MONEY_DECIMALS; i++) {
+        *--p = (char)('0' + fraction % 10);
+        fraction /= 10;
+    }
+    *--p = '.';
+    do {
+        *--p = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole != 0);
+    if (amount < 0) {
+        *--p = '-';
+    }
+
+    int length = (int)(end - p);
+    memcpy(buffer, p, length);
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * @brief Formats an amount without trailing zero decimals, e.g. 150 as "1.5" and 4000 as "40".
+ *
+ * @param amount The amount.
+ * @param buffer Receives the text; must hold MONEY_TEXT_LENGTH bytes.
+ * @return The length of the text.
+ */
+int formatMoneyShort(Money amount, char *buffer) {
+    int length = formatMoney(amount, buffer);
+    while (buffer[length - 1] == '0') {
+        length--;
+    }
+    if (buffer[length - 1] == '.') {
+        length--;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * @brief Parses a decimal amount such as "40", "-3.5" or "1000.00".
+ *
+ * Digits beyond MONEY_DECIMALS are rounded half away from zero, as
+ * printf("%.2lf") rounded the old double balances.
+ *
+ * @param text The text (not necessarily terminated).
+ * @param length Number of characters to parse; all of them must belong to the amount.
+ * @param amount Receives the amount.
+ * @return true on success, false if the text is not a number or is out of range.
+ */
+bool parseMoney(const char *text, size_t length, Money *amount) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = (text[i] == '-');
+        i++;
+    }
+
+    const uint64_t limit = (uint64_t)INT64_MAX / 10 - 9;
+    uint64_t value = 0;
+    int digits = 0;
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; i++) {
+        if (value > limit) {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+        digits++;
+    }
+
+    int decimals = 0;
+    bool roundUp = false;
+    if (i < length && text[i] == '.') {
+        for (i++; i < length && text[i] >= '0' && text[i] <= '9'; i++) {
+            if (decimals < MONEY_DECIMALS) {
+                if (value > limit) {
+                    return false;
+                }
+                value = value * 10 + (text[i] - '0');
+                decimals++;
+            } else if (decimals == MONEY_DECIMALS) {
+                roundUp = (text[i] >= '5');
+                decimals++;
+            }
+            digits++;
+        }
+    }
+    if (digits == 0 || i != length) {
+        return false;
+    }
+
+    for (int d = (decimals < MONEY_DECIMALS) ? decimals : MONEY_DECIMALS; d < MONEY_DECIMALS; d++) {
+        if (value > limit) {
+            return false;
+        }
+        value *= 10;
+    }
+    if (roundUp) {
+        value++;
+    }
+    if (value > (uint64_t)INT64_MAX) {
+        return false;
+    }
+
+    *amount = negative ? -(Money)value : (Money)value;
+    return true;
+}
@@ -0,0 +1,23 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MONEY_DECIMALS 2        // Digits after the decimal point
+#define MONEY_SCALE 100         // 10^MONEY_DECIMALS smallest units per whole unit
+#define MONEY_TEXT_LENGTH 24    // Enough for any Money value, its sign, point and terminator
+
+// Amount of money as a whole number of cents (fixed-point, exact under addition and comparison)
+typedef int64_t Money;
+
+int formatMoney(Money amount, char *buffer);
+int formatMoneyShort(Money amount, char *buffer);
+bool parseMoney(const char *text, size_t length, Money *amount);
+
+#endif // MONEY_H
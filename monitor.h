@@ -9,41 +9,178 @@
 #define MONITOR_H
 
 #include <pthread.h>
-#include <queue>
+#include <sys/types.h>
 #include "sharedmemory.h"
+#include "account_store.h"
+#include "write_ahead_log.h"
+#include "account_cache.h"
+#include "account_snapshot.h"
+#include "account_combiner.h"
+#include "account_directory.h"
+#include "metrics.h"
+#include "event_output.h"
+#include "async_io.h"
 
-#define MAX_ACCOUNTS 100  // Define maximum number of accounts
+#define DEFAULT_LOCK_STRIPES 4096  // Default number of account locks (rounded up to a power of two)
+#define MAX_QUEUED_PROCESSES 64  // Maximum number of processes waiting on the monitor at once
+#define MAX_BATCH_SIZE 256        // Transactions applied under one monitor entry
+#define MAX_BATCH_LANES (2 * MAX_BATCH_SIZE)
 
-// Monitor structure
+// Account storage backends
+enum StorageBackend {
+    STORAGE_FILES,   // One "<id>.txt" file per account
+    STORAGE_MAPPED   // Fixed-size slots in a single memory-mapped file
+};
+
+// Entry in the monitor's process queue
+struct QueuedProcess {
+    long ticket;  // Registration number of the entry, or -1 if the entry is free
+    pid_t pid;    // Process waiting on or inside the monitor
+};
+
+// Admission lane: a ticket lock for every account whose mutex index maps to it
+// (one cache line each so lanes of unrelated accounts do not share lines)
+struct alignas(64) AdmissionLane {
+    long next_ticket;   // Next ticket handed out on this lane (atomic)
+    long now_serving;   // Ticket currently admitted on this lane (atomic)
+    uint32_t wake;      // Futex word, bumped whenever now_serving advances
+    uint32_t sleeping;  // Number of waiters blocked (or about to block) on wake
+    uint32_t readers;   // Shared holders admitted and not yet exited (atomic)
+    uint64_t holder_hash; // Hash of the account admitted most recently on this lane
+    pid_t holder_pid;     // Process last admitted exclusively on this lane
+    long holder_ticket;   // Ticket it was admitted with (written after holder_pid)
+    long holder_next;     // Ticket the lane goes to when it exits (after its batch's run)
+};
+
+// Tickets a transaction holds: one per distinct lane it touches, in lane order
+// (the lane is taken shared or exclusive when the ticket is served, not when it is drawn)
+struct MonitorTicket {
+    int count;
+    int lanes[2];
+    long tickets[2];
+};
+
+// Tickets a batch holds: a run of consecutive tickets on every distinct lane it touches, in lane order
+struct BatchTicket {
+    int count;
+    int lanes[MAX_BATCH_LANES];
+    long first[MAX_BATCH_LANES];             // First ticket of the batch's run on the lane
+    long last[MAX_BATCH_LANES];              // Last ticket of the run
+    const char *accounts[MAX_BATCH_LANES];   // An account of the batch on the lane (for lock statistics)
+};
+
+// Account lock stripe with contention statistics (waits on the stripe's
+// admission lane and on its lock are both counted)
+struct alignas(64) LockStripe {
+    pthread_mutex_t lock;   // Robust; held while an account mapped to this stripe is updated or written back
+    pid_t fill;             // Spinlock serializing cache fills by readers sharing the lane (holder's pid, or 0)
+    long version;           // Seqlock: odd while an account mapped to this stripe is being changed (atomic)
+    uint64_t holder_hash;   // Hash of the account that last acquired the stripe
+    long acquisitions;      // Times the stripe was locked
+    long contended;         // Acquisitions that had to wait
+    long collisions;        // Waits caused by a different account sharing the stripe
+    long wait_ns;           // Total time spent waiting for the stripe
+};
+
+// Totals over every lock stripe
+struct LockTableStats {
+    long acquisitions;
+    long contended;
+    long collisions;
+    long wait_ns;
+    int stripes_used;       // Stripes locked at least once
+};
+
+// Monitor structure (must live in memory shared by every process that uses it;
+// the admission lanes and lock stripes follow it, see monitorSize)
 struct Monitor {
-    pthread_mutex_t mutex;             // Mutex for synchronization
-    pthread_cond_t cond;               // Condition variable for queue
-    std::queue<pid_t> process_queue;   // Queue to manage process access
-    pthread_mutex_t account_mutexes[MAX_ACCOUNTS]; // Mutexes for accounts (deadlock prevention)
+    long next_ticket;                  // Registration counter for process_queue entries (atomic)
+    QueuedProcess process_queue[MAX_QUEUED_PROCESSES]; // Processes waiting on or inside the monitor
+    pthread_mutex_t admission_mutex;   // Orders ticket draws that span two lanes
+    int lock_stripes;                  // Number of lanes and account lock stripes (power of two)
+    AdmissionLane *lanes;              // One admission lane per lock stripe
+    LockStripe *account_mutexes;       // Striped mutexes for accounts (deadlock prevention)
     SharedMemorySegment *shm_ptr;      // Pointer to shared memory segment
+    StorageBackend storage_backend;    // Where account balances are kept
+    AccountStore account_store;        // Mapped store (STORAGE_MAPPED only)
+    WriteAheadLog *wal;                // Redo log for balance changes, or NULL if disabled
+    AccountCache *cache;               // Shared balance cache (STORAGE_FILES only), or NULL if disabled
+    AccountDirectory *directory;       // Account file layout and membership filter (STORAGE_FILES only), or NULL for plain "<id>.txt"
+    Metrics *metrics;                  // Latency histograms and outcome counters, or NULL if disabled
+    EventOutput *output;               // Buffered transaction messages, or NULL to print them directly
+    AccountSnapshot *snapshot;         // Writer epochs and before-images for REPORT, or NULL if reports are off
+    AccountCombiner *combiner;         // Hot accounts whose deposits and credits are combined, or NULL if off
+    bool optimistic_reads;             // Inquiries read without entering the monitor (stripe seqlock)
+    bool async_io;                     // Account files (and the WAL) go through io_uring (STORAGE_FILES only)
+    bool flock_compat;                 // Also flock account files, for outside tools that lock them
 };
 
 // Monitor initialization and destruction
-void initializeMonitor(Monitor *monitor, SharedMemorySegment *shm_ptr);
+size_t monitorSize(int lockStripes);
+void initializeMonitor(Monitor *monitor, SharedMemorySegment *shm_ptr, int lockStripes = DEFAULT_LOCK_STRIPES);
+void attachMonitor(Monitor *monitor, SharedMemorySegment *shm_ptr);
+void resetLockTableStats(Monitor *monitor);
 void destroyMonitor(Monitor *monitor);
 
 // Monitor queue functions
-void enterMonitor(Monitor *monitor);
+void reserveMonitorTicket(Monitor *monitor, const char *accountId, const char *otherAccountId, MonitorTicket *ticket);
+void assignMonitorTicket(const MonitorTicket *ticket);
+void enterMonitor(Monitor *monitor, const char *accountId, const char *otherAccountId = NULL);
+void enterMonitorShared(Monitor *monitor, const char *accountId);
 void exitMonitor(Monitor *monitor);
+long heldLaneTicket(int lane);
+void handOnLane(Monitor *monitor, int lane);
+void reserveBatchTicket(Monitor *monitor, BatchTicket *ticket);
+void enterMonitorBatch(Monitor *monitor, const BatchTicket *ticket);
+void exitMonitorBatch(Monitor *monitor, const BatchTicket *ticket);
 void displayProcessQueue(Monitor *monitor);
 
 // Helper functions
-int getAccountMutexIndex(const char *accountId);
-double monitorGetBalance(Monitor *monitor, const char *accountId);
-void monitorUpdateBalance(Monitor *monitor, const char *accountId, double newBalance);
-void monitorRecordTransaction(Monitor *monitor, const char *type, const char *accountId, double amount, const char *status, const char *reason, const char *recipientAccountId = NULL);
+bool processExited(pid_t pid);
+int getAccountMutexIndex(Monitor *monitor, const char *accountId);
+void lockAccountMutex(Monitor *monitor, int index, const char *accountId);
+void unlockAccountMutex(Monitor *monitor, int index);
+void recordLockWait(Monitor *monitor, int index, bool collision, long waitNanoseconds);
+void getLockTableStats(Monitor *monitor, LockTableStats *stats);
+Money monitorGetBalance(Monitor *monitor, const char *accountId);
+Money monitorReadBalanceOptimistic(Monitor *monitor, const char *accountId);
+Money monitorSnapshotBalance(Monitor *monitor, const char *accountId);
+void monitorForEachAccount(Monitor *monitor, AccountVisitor visit, void *context);
+bool monitorCombineStripe(Monitor *monitor, int index);
+HotAccount *monitorHotAccount(Monitor *monitor, const char *accountId);
+void monitorCombineDelta(Monitor *monitor, HotAccount *hot, CombineRequest *request, Money amount);
+void monitorSettleHotAccount(Monitor *monitor, const char *accountId);
+void monitorUpdateBalance(Monitor *monitor, const char *accountId, Money newBalance);
+void monitorUpdateBalances(Monitor *monitor, const char *accountId, Money newBalance, const char *otherAccountId, Money otherBalance);
+int monitorCreateAccount(Monitor *monitor, const char *accountId, const char *name, Money initialBalance);
+int monitorDeleteAccount(Monitor *monitor, const char *accountId);
+void monitorFlushCache(Monitor *monitor);
+void monitorPrefetchBalances(Monitor *monitor, const char *const *accountIds, int count);
+void monitorCheckpoint(Monitor *monitor, bool force);
+long monitorRecoverAccounts(Monitor *monitor, const char *walPath);
+void monitorRecordTransaction(Monitor *monitor, TransactionType type, const char *accountId, Money amount, TransactionStatus status, TransactionReason reason, const char *recipientAccountId = NULL);
+void monitorBeginRecordBatch(TransactionRecord *records);
+long monitorEndRecordBatch(Monitor *monitor);
 
 // Transaction functions
-void createAccount(Monitor *monitor, const char *accountId, const char *name, double initialBalance);
-void deposit(Monitor *monitor, const char *accountId, double amount);
-void withdraw(Monitor *monitor, const char *accountId, double amount);
+void createAccount(Monitor *monitor, const char *accountId, const char *name, Money initialBalance);
+void deposit(Monitor *monitor, const char *accountId, Money amount);
+void withdraw(Monitor *monitor, const char *accountId, Money amount);
 void inquiry(Monitor *monitor, const char *accountId);
-void transfer(Monitor *monitor, const char *fromAccountId, double amount, const char *toAccountId);
+void transfer(Monitor *monitor, const char *fromAccountId, Money amount, const char *toAccountId);
 void closeAccount(Monitor *monitor, const char *accountId);
+void statement(Monitor *monitor, const char *accountId, const StatementQuery *query);
+void report(Monitor *monitor);
+void printStatement(Monitor *monitor, const char *accountId, const TransactionRecord *records, long count);
+
+// Transaction bodies; the caller is in the monitor and holds the accounts' lock stripes
+// (inquiryLocked and statementLocked only need their lane shared)
+void createAccountLocked(Monitor *monitor, const char *accountId, const char *name, Money initialBalance);
+void depositLocked(Monitor *monitor, const char *accountId, Money amount);
+void withdrawLocked(Monitor *monitor, const char *accountId, Money amount);
+void inquiryLocked(Monitor *monitor, const char *accountId);
+void transferLocked(Monitor *monitor, const char *fromAccountId, Money amount, const char *toAccountId);
+void closeAccountLocked(Monitor *monitor, const char *accountId);
+void statementLocked(Monitor *monitor, const char *accountId, const StatementQuery *query);
 
 #endif // MONITOR_H
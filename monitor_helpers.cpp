@@ -14,39 +14,164 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sched.h>
 
 using namespace std;
 
 /**
  * @brief Computes the mutex index for a given account ID.
  *
+ * @param monitor Pointer to the monitor structure.
  * @param accountId The account ID as a string.
- * @return The mutex index derived from the account ID.
+ * @return The lock stripe the account's hash maps to.
+ */
+int getAccountMutexIndex(Monitor *monitor, const char *accountId) {
+    return (int)(hashAccountId(accountId) & (uint64_t)(monitor->lock_stripes - 1));
+}
+
+/**
+ * @brief Adds one wait to a lock stripe's contention statistics.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param index The stripe index from getAccountMutexIndex.
+ * @param collision Whether the stripe was held on behalf of a different account.
+ * @param waitNanoseconds How long the wait took.
  */
-int getAccountMutexIndex(const char *accountId) {
-    // Simple hash function to map account ID to mutex index
-    int index = 0;
-    for (int i = 0; accountId[i] != '\0'; i++) {
-        index += accountId[i];
+void recordLockWait(Monitor *monitor, int index, bool collision, long waitNanoseconds) {
+    LockStripe *stripe = &(monitor->account_mutexes[index]);
+    __atomic_add_fetch(&(stripe->contended), 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&(stripe->wait_ns), waitNanoseconds, __ATOMIC_RELAXED);
+    if (collision) {
+        __atomic_add_fetch(&(stripe->collisions), 1, __ATOMIC_RELAXED);
     }
-    return index % MAX_ACCOUNTS;
 }
 
 /**
- * @brief Retrieves the balance of an account.
+ * @brief Locks an account's stripe, for reading and updating its accounts.
+ *
+ * Waits are only timed when the stripe is already held, so an uncontended
+ * lock costs one trylock plus two counter updates. The stripe is a robust
+ * mutex: if its holder died mid-transaction, the next locker takes it over.
+ * With hot accounts, the locker also applies their pending combined updates.
  *
  * @param monitor Pointer to the monitor structure.
- * @param accountId The account ID as a string.
- * @return The account balance, or -1 if the account does not exist or an error occurs.
+ * @param index The stripe index from getAccountMutexIndex.
+ * @param accountId The account being locked.
+ */
+void lockAccountMutex(Monitor *monitor, int index, const char *accountId) {
+    LockStripe *stripe = &(monitor->account_mutexes[index]);
+    uint64_t hash = hashAccountId(accountId);
+    long lockStart = metricsStart(monitor->metrics);
+
+    if (!tryLockSharedMutex(&(stripe->lock))) {
+        uint64_t holder = __atomic_load_n(&(stripe->holder_hash), __ATOMIC_RELAXED);
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        lockSharedMutex(&(stripe->lock));
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        recordLockWait(monitor, index, holder != hash,
+                       (end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec));
+    }
+
+    __atomic_add_fetch(&(stripe->acquisitions), 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&(stripe->holder_hash), hash, __ATOMIC_RELAXED);
+    metricsAddPhase(monitor->metrics, PHASE_LOCK_WAIT, lockStart);
+
+    // Combined updates published by earlier tickets are applied before the
+    // caller reads any account of the stripe
+    if (monitor->combiner != NULL) {
+        while (!monitorCombineStripe(monitor, index)) {
+            sched_yield(); // A running report has no room for the before-image yet
+        }
+    }
+}
+
+/**
+ * @brief Unlocks an account's stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param index The stripe index from getAccountMutexIndex.
+ */
+void unlockAccountMutex(Monitor *monitor, int index) {
+    pthread_mutex_unlock(&(monitor->account_mutexes[index].lock));
+}
+
+/**
+ * @brief Clears the contention statistics of every lock stripe.
+ *
+ * A segment reused from an earlier run keeps that run's counts until this
+ * is called, which is only needed when they are going to be printed.
+ *
+ * @param monitor Pointer to the monitor structure.
+ */
+void resetLockTableStats(Monitor *monitor) {
+    for (int i = 0; i < monitor->lock_stripes; i++) {
+        LockStripe *stripe = &(monitor->account_mutexes[i]);
+        stripe->acquisitions = 0;
+        stripe->contended = 0;
+        stripe->collisions = 0;
+        stripe->wait_ns = 0;
+    }
+}
+
+/**
+ * @brief Sums the contention statistics of every lock stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param stats Receives the totals.
+ */
+void getLockTableStats(Monitor *monitor, LockTableStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < monitor->lock_stripes; i++) {
+        LockStripe *stripe = &(monitor->account_mutexes[i]);
+        stats->acquisitions += stripe->acquisitions;
+        stats->contended += stripe->contended;
+        stats->collisions += stripe->collisions;
+        stats->wait_ns += stripe->wait_ns;
+        if (stripe->acquisitions > 0) {
+            stats->stripes_used++;
+        }
+    }
+}
+
+/**
+ * @brief Checks whether account files go through io_uring.
+ *
+ * io_uring cannot flock, so the flock-compatible mode keeps the synchronous helpers.
+ */
+static bool useAsyncFiles(Monitor *monitor) {
+    return monitor->async_io && !monitor->flock_compat;
+}
+
+/**
+ * @brief Parses the contents of an account file, ignoring trailing whitespace.
+ *
+ * @return true if the text holds a balance.
  */
-double monitorGetBalance(Monitor *monitor, const char *accountId) {
-    char filename[30];
-    snprintf(filename, sizeof(filename), "%s.txt", accountId);
+static bool parseBalanceText(const char *buffer, ssize_t length, Money *balance) {
+    while (length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == ' ')) {
+        length--;
+    }
+    return length > 0 && parseMoney(buffer, length, balance);
+}
 
+/**
+ * @brief Reads an account's balance from its "<id>.txt" file.
+ *
+ * @param filename The account file's path (see accountFilePath).
+ * @param missing Set to whether the file does not exist.
+ * @param useFlock Whether to take a shared flock for outside tools (the caller's stripe already excludes writers).
+ * @return The account balance, or -1 if the account does not exist or an error occurs.
+ */
+static Money readBalanceFile(const char *filename, bool *missing, bool useFlock) {
     int fd = open(filename, O_RDONLY);
 
+    *missing = (fd == -1 && errno == ENOENT);
     if (fd == -1) {
-        if (errno != ENOENT) // Check if the error is not 'File Not Found'
+        if (!*missing) // Check if the error is not 'File Not Found'
         {
             printf("Error reading account file: %s\n", filename);
         }
@@ -54,7 +179,7 @@ double monitorGetBalance(Monitor *monitor, const char *accountId) {
     }
 
     // Lock the file for reading
-    if (flock(fd, LOCK_SH) == -1) {
+    if (useFlock && flock(fd, LOCK_SH) == -1) {
         printf("Error locking the file for reading.\n");
         close(fd);
         return -1;
@@ -65,106 +190,1351 @@ double monitorGetBalance(Monitor *monitor, const char *accountId) {
 
     if (bytesRead <= 0) {
         printf("Error reading balance from file.\n");
-        flock(fd, LOCK_UN);
+        if (useFlock) {
+            flock(fd, LOCK_UN);
+        }
+        close(fd);
+        return -1;
+    }
+    Money balance;
+    if (!parseBalanceText(buffer, bytesRead, &balance)) {
+        printf("Error reading balance from file.\n");
+        if (useFlock) {
+            flock(fd, LOCK_UN);
+        }
         close(fd);
         return -1;
     }
-    buffer[bytesRead] = '\0';
-
-    double balance = atof(buffer);
 
     // Unlock and close the file
-    flock(fd, LOCK_UN);
+    if (useFlock) {
+        flock(fd, LOCK_UN);
+    }
     close(fd);
 
     return balance;
 }
 
 /**
- * @brief Updates the balance of an account.
+ * @brief Reads an account's balance from its "<id>.txt" file with one io_uring submission.
+ *
+ * The open, read and close run as one linked chain; the account's lock
+ * stripe already keeps every other process of the monitor away from the
+ * file, so no flock is taken.
+ *
+ * @param filename The account file's path (see accountFilePath).
+ * @param missing Set to whether the file does not exist.
+ * @param balance Receives the balance, or -1 if the account does not exist or an error occurs.
+ * @return false if io_uring is unavailable (nothing was read).
+ */
+static bool readBalanceFileAsync(const char *filename, bool *missing, Money *balance) {
+    AsyncFileOp op;
+    snprintf(op.path, sizeof(op.path), "%s", filename);
+    if (asyncReadFiles(&op, 1) != 0) {
+        return false;
+    }
+
+    *missing = (op.result == -ENOENT);
+    *balance = -1;
+    if (op.result != 0) {
+        if (!*missing) {
+            printf("Error reading account file: %s\n", op.path);
+        }
+    } else if (!parseBalanceText(op.buffer, op.length, balance)) {
+        printf("Error reading balance from file.\n");
+        *balance = -1;
+    }
+    return true;
+}
+
+/**
+ * @brief Takes a stripe's cache fill spinlock, freeing it first if its holder died.
+ *
+ * @param fill The stripe's fill word (holder's pid, or 0).
+ */
+static void lockCacheFill(pid_t *fill) {
+    pid_t self = getpid();
+    pid_t holder = 0;
+    for (int spin = 1; !__atomic_compare_exchange_n(fill, &holder, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+         spin++) {
+        if (spin % 1024 == 0 && processExited(holder)) {
+            __atomic_compare_exchange_n(fill, &holder, 0, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+        holder = 0;
+        sched_yield();
+    }
+}
+
+/**
+ * @brief Reads the balance of an account from the storage backend.
+ *
+ * With the account cache enabled, accounts are read from their files only
+ * on first access; later reads (including of accounts known not to exist)
+ * are answered from shared memory. Accounts the directory's filter rules
+ * out are reported missing without looking for their file.
  *
  * @param monitor Pointer to the monitor structure.
  * @param accountId The account ID as a string.
- * @param newBalance The new balance to set for the account.
+ * @return The account balance, or -1 if the account does not exist or an error occurs.
+ */
+static Money readBalance(Monitor *monitor, const char *accountId) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        AccountSlot *slot = storeFindAccount(&(monitor->account_store), accountId);
+        if (slot == NULL) {
+            return -1;
+        }
+        return slot->balance_cents;
+    }
+
+    AccountCache *cache = monitor->cache;
+    pid_t *fill = NULL;
+    if (cache != NULL) {
+        CacheEntry *entry = cacheFindEntry(cache, accountId);
+        if (entry == NULL) {
+            // Readers sharing the lane can miss together; only the first may add the entry
+            fill = &(monitor->account_mutexes[getAccountMutexIndex(monitor, accountId)].fill);
+            lockCacheFill(fill);
+            entry = cacheFindEntry(cache, accountId);
+            if (entry != NULL) {
+                __atomic_store_n(fill, 0, __ATOMIC_RELEASE);
+            }
+        }
+        if (entry != NULL) {
+            __atomic_add_fetch(&(cache->hits), 1, __ATOMIC_RELAXED);
+            return (entry->state == CACHE_ABSENT) ? -1 : entry->balance;
+        }
+        __atomic_add_fetch(&(cache->misses), 1, __ATOMIC_RELAXED);
+    }
+
+    bool missing = true;
+    Money balance = -1;
+    if (directoryMayContain(monitor->directory, accountId)) {
+        char filename[ACCOUNT_PATH_LENGTH];
+        accountFilePath(monitor->directory, accountId, filename, sizeof(filename));
+        if (!useAsyncFiles(monitor) || !readBalanceFileAsync(filename, &missing, &balance)) {
+            balance = readBalanceFile(filename, &missing, monitor->flock_compat);
+        }
+        if (missing && monitor->directory != NULL) {
+            __atomic_add_fetch(&(monitor->directory->filter_false_positives), 1, __ATOMIC_RELAXED);
+        }
+    }
+    if (cache != NULL) {
+        if (balance >= 0 || missing) {
+            cacheAddEntry(cache, accountId, missing ? CACHE_ABSENT : CACHE_CLEAN, balance);
+        }
+        __atomic_store_n(fill, 0, __ATOMIC_RELEASE);
+    }
+    return balance;
+}
+
+/**
+ * @brief Retrieves the balance of an account.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @return The account balance, or -1 if the account does not exist or an error occurs.
+ */
+Money monitorGetBalance(Monitor *monitor, const char *accountId) {
+    long readStart = metricsStart(monitor->metrics);
+    Money balance = readBalance(monitor, accountId);
+    metricsAddPhase(monitor->metrics, PHASE_STORAGE_READ, readStart);
+    return balance;
+}
+
+/**
+ * @brief Reads an account's balance without changing anything, for readers that do not hold its lane.
+ *
+ * Unlike readBalance this neither fills the cache nor prints errors: a
+ * reader racing a writer may find a file half rewritten, and the caller's
+ * version check then sends it back for another read. No flock is taken.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @return The balance, -1 if the account does not exist, or -2 if its file holds no balance.
  */
-void monitorUpdateBalance(Monitor *monitor, const char *accountId, double newBalance) {
-    char filename[30];
-    snprintf(filename, sizeof(filename), "%s.txt", accountId);
+static Money peekBalance(Monitor *monitor, const char *accountId) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        return readBalance(monitor, accountId);
+    }
 
-    int fd = open(filename, O_WRONLY);
+    if (monitor->cache != NULL) {
+        CacheEntry *entry = cacheFindEntry(monitor->cache, accountId);
+        if (entry != NULL) {
+            return (__atomic_load_n(&(entry->state), __ATOMIC_ACQUIRE) == CACHE_ABSENT) ? -1 : entry->balance;
+        }
+    }
+    if (!directoryMayContain(monitor->directory, accountId)) {
+        return -1;
+    }
 
+    char filename[ACCOUNT_PATH_LENGTH];
+    accountFilePath(monitor->directory, accountId, filename, sizeof(filename));
+    int fd = open(filename, O_RDONLY);
     if (fd == -1) {
-        printf("Error updating the file.\n");
+        return -1;
+    }
+    char buffer[50];
+    ssize_t bytesRead = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    Money balance;
+    if (bytesRead <= 0 || !parseBalanceText(buffer, bytesRead, &balance)) {
+        return -2;
+    }
+    return balance;
+}
+
+/**
+ * @brief Reads an account's balance without entering the monitor.
+ *
+ * Optimistic read: the balance is read between two loads of the account's
+ * stripe version and read again if a writer changed an account of the
+ * stripe in between, so neither side ever waits for the other's lock.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @return The account balance, or -1 if the account does not exist.
+ */
+Money monitorReadBalanceOptimistic(Monitor *monitor, const char *accountId) {
+    long *version = &(monitor->account_mutexes[getAccountMutexIndex(monitor, accountId)].version);
+    for (int attempt = 1;; attempt++) {
+        long before = __atomic_load_n(version, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            if (attempt % 64 == 0) {
+                sched_yield(); // The writer may have been preempted mid-change
+            }
+            continue;
+        }
+        long readStart = metricsStart(monitor->metrics);
+        Money balance = peekBalance(monitor, accountId);
+        metricsAddPhase(monitor->metrics, PHASE_STORAGE_READ, readStart);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(version, __ATOMIC_RELAXED) == before) {
+            return (balance < 0) ? -1 : balance; // A file that still holds no balance is not an account
+        }
+    }
+}
+
+/**
+ * @brief Reads an account's balance as of the running report's cut (see beginSnapshot).
+ *
+ * Like monitorReadBalanceOptimistic, but a before-image saved by a writer
+ * admitted after the cut takes the place of the current balance. Writers
+ * save the before-image before they change the stripe version, so a read
+ * that raced with one is retried and then finds it.
+ *
+ * @param monitor Pointer to the monitor structure (with a snapshot table).
+ * @param accountId The account ID as a string.
+ * @return The balance at the cut, or -1 if the account did not exist then.
+ */
+Money monitorSnapshotBalance(Monitor *monitor, const char *accountId) {
+    long *version = &(monitor->account_mutexes[getAccountMutexIndex(monitor, accountId)].version);
+    for (int attempt = 1;; attempt++) {
+        long before = __atomic_load_n(version, __ATOMIC_SEQ_CST);
+        if (before & 1) {
+            if (attempt % 64 == 0) {
+                sched_yield();
+            }
+            continue;
+        }
+        SnapshotEntry *entry = snapshotFindEntry(monitor->snapshot, accountId);
+        Money balance = (entry != NULL) ? entry->balance : peekBalance(monitor, accountId);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(version, __ATOMIC_SEQ_CST) == before) {
+            return (balance < 0) ? -1 : balance;
+        }
+    }
+}
+
+/**
+ * @brief Calls a function with the ID of every account in the storage backend.
+ *
+ * The listing is not atomic: accounts created or closed meanwhile may or
+ * may not be listed (a report adds the before-images of those changed
+ * after its cut itself). With the files backend every "<id>.txt" file is
+ * listed, so the caller must skip IDs that turn out to hold no balance.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param visit Called with each account ID.
+ * @param context Passed to visit.
+ */
+void monitorForEachAccount(Monitor *monitor, AccountVisitor visit, void *context) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        storeForEachAccount(&(monitor->account_store), visit, context);
         return;
     }
+    forEachAccountFile(monitor->directory, visit, context);
+}
 
-    // Lock the file for writing
-    if (flock(fd, LOCK_EX) == -1) {
-        printf("Error locking the file for writing.\n");
-        close(fd);
+/**
+ * @brief Saves an account's balance for the running report before this writer first changes it.
+ *
+ * Only writers admitted after the report's cut do this. If the report's
+ * table is full, the writer waits for the report to finish rather than
+ * change the account under it; the report never waits for such writers.
+ */
+static void preserveBeforeImage(Monitor *monitor, const char *accountId) {
+    AccountSnapshot *snapshot = monitor->snapshot;
+    if (snapshot == NULL || held_epoch == -1 || !snapshotWantsBeforeImage(snapshot, held_epoch) ||
+        snapshotFindEntry(snapshot, accountId) != NULL) {
         return;
     }
+    if (!snapshotAddEntry(snapshot, accountId, readBalance(monitor, accountId))) {
+        __atomic_add_fetch(&(snapshot->full_waits), 1, __ATOMIC_RELAXED);
+        while (snapshotWantsBeforeImage(snapshot, held_epoch)) {
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief Marks an account's stripe as being changed (odd version), saving a before-image first if a report needs one.
+ *
+ * The caller holds the account's lane exclusively, so it is the stripe's only writer.
+ *
+ * @return The stripe index, to pass to endAccountWrite.
+ */
+static int beginAccountWrite(Monitor *monitor, const char *accountId) {
+    preserveBeforeImage(monitor, accountId);
+    int index = getAccountMutexIndex(monitor, accountId);
+    __atomic_add_fetch(&(monitor->account_mutexes[index].version), 1, __ATOMIC_SEQ_CST);
+    return index;
+}
+
+/**
+ * @brief Marks a change started by beginAccountWrite as finished.
+ */
+static void endAccountWrite(Monitor *monitor, int index) {
+    __atomic_add_fetch(&(monitor->account_mutexes[index].version), 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Replaces an account's "<id>.txt" file with one holding a new balance.
+ *
+ * The balance is written to "<file>.tmp", synced and renamed over the
+ * account file, so a crash leaves the old balance or the new one, never an
+ * empty or torn file. The caller's stripe keeps every other writer of the
+ * account, and so of its temporary file, out.
+ *
+ * @param filename The account file's path (see accountFilePath).
+ * @param newBalance The new balance to set for the account.
+ * @param useFlock Whether to hold an exclusive flock on the account file while it is replaced, for outside tools.
+ */
+static void writeBalanceFile(const char *filename, Money newBalance, bool useFlock) {
+    int fd = -1;
+    if (useFlock) {
+        fd = open(filename, O_WRONLY);
+        if (fd == -1 || flock(fd, LOCK_EX) == -1) {
+            printf("Error locking the file for writing.\n");
+            if (fd != -1) {
+                close(fd);
+            }
+            return;
+        }
+    }
+
+    char tempName[ACCOUNT_PATH_LENGTH + sizeof(".tmp")];
+    snprintf(tempName, sizeof(tempName), "%s.tmp", filename);
+    int tempFd = open(tempName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    char buffer[MONEY_TEXT_LENGTH];
+    ssize_t length = formatMoney(newBalance, buffer);
+    if (tempFd == -1 || write(tempFd, buffer, length) != length || fdatasync(tempFd) == -1 ||
+        rename(tempName, filename) == -1) {
+        printf("Error updating the file.\n");
+        unlink(tempName);
+    }
+    if (tempFd != -1) {
+        close(tempFd);
+    }
 
-    // Truncate the file and write new balance
-    if (ftruncate(fd, 0) == -1) {
-        printf("Error truncating the file.\n");
+    // Unlock and close the file
+    if (useFlock) {
         flock(fd, LOCK_UN);
         close(fd);
-        return;
     }
+}
 
-    char buffer[50];
-    snprintf(buffer, sizeof(buffer), "%.2lf", newBalance);
-    write(fd, buffer, strlen(buffer));
+/**
+ * @brief Rewrites an account's "<id>.txt" file with one io_uring submission.
+ *
+ * As in readBalanceFileAsync, the caller's lock stripe replaces the flock.
+ *
+ * @param accountId The account ID as a string.
+ * @param newBalance The new balance to set for the account.
+ * @return false if io_uring is unavailable (nothing was written).
+ */
+static bool writeBalanceFileAsync(const char *filename, Money newBalance) {
+    AsyncFileOp op;
+    snprintf(op.path, sizeof(op.path), "%s", filename);
+    op.length = formatMoney(newBalance, op.buffer);
+    if (asyncWriteFiles(&op, 1) != 0) {
+        return false;
+    }
+    if (op.result != 0) {
+        printf("Error updating the file.\n");
+    }
+    return true;
+}
 
-    // Unlock and close the file
-    flock(fd, LOCK_UN);
-    close(fd);
+// Dirty cache entries written back with one io_uring submission
+struct WriteBackGroup {
+    int count;
+    AsyncFileOp ops[ASYNC_IO_FILES];
+    CacheEntry *entries[ASYNC_IO_FILES];
+    int locked;                               // Stripes locked for the group
+    pthread_mutex_t *locks[ASYNC_IO_FILES];
+};
+
+/**
+ * @brief Writes a group of dirty entries back, marks them clean and unlocks their stripes.
+ */
+static void finishWriteBackGroup(Monitor *monitor, WriteBackGroup *group) {
+    AccountCache *cache = monitor->cache;
+    bool written = (asyncWriteFiles(group->ops, group->count) == 0);
+
+    for (int i = 0; i < group->count; i++) {
+        CacheEntry *entry = group->entries[i];
+        if (!written) {
+            writeBalanceFile(group->ops[i].path, entry->balance, monitor->flock_compat);
+        } else if (group->ops[i].result != 0) {
+            printf("Error updating the file.\n");
+        }
+        __atomic_store_n(&(entry->state), (uint32_t)CACHE_CLEAN, __ATOMIC_RELEASE);
+        __atomic_sub_fetch(&(cache->dirty), 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&(cache->writebacks), 1, __ATOMIC_RELAXED);
+    }
+    for (int i = 0; i < group->locked; i++) {
+        pthread_mutex_unlock(group->locks[i]);
+    }
+    group->count = 0;
+    group->locked = 0;
 }
 
 /**
- * @brief Records a transaction in shared memory.
+ * @brief Writes dirty cache entries back in groups of ASYNC_IO_FILES, one io_uring submission per group.
+ *
+ * Each entry's stripe stays locked until its group has been written, as
+ * the synchronous write-back holds it for the duration of each write.
  *
  * @param monitor Pointer to the monitor structure.
- * @param type The type of transaction (e.g., "DEPOSIT", "WITHDRAW").
- * @param accountId The account ID associated with the transaction.
- * @param amount The transaction amount.
- * @param status The status of the transaction (e.g., "SUCCESS", "FAILED").
- * @param reason A descriptive reason for the transaction status.
- * @param recipientAccountId (Optional) The recipient account ID for transactions like "TRANSFER".
+ * @param quiescent Whether no other process can be updating the cache.
  */
-void monitorRecordTransaction(Monitor *monitor, const char *type, const char *accountId, double amount, const char *status, const char *reason, const char *recipientAccountId) {
-    TransactionRecord record;
-    strcpy(record.transaction_type, type);
-    strcpy(record.account_id, accountId);
+static void writeBackEntriesAsync(Monitor *monitor, bool quiescent) {
+    AccountCache *cache = monitor->cache;
+    WriteBackGroup group;
+    group.count = 0;
+    group.locked = 0;
 
-    if (recipientAccountId != NULL) {
-        strcpy(record.recipient_account_id, recipientAccountId);
-    } else {
-        record.recipient_account_id[0] = '\0';
+    for (uint64_t i = 0; i < cache->capacity; i++) {
+        CacheEntry *entry = &(cache->entries[i]);
+        if (__atomic_load_n(&(entry->state), __ATOMIC_ACQUIRE) != CACHE_DIRTY) {
+            continue;
+        }
+
+        if (!quiescent) {
+            pthread_mutex_t *lock = &(monitor->account_mutexes[getAccountMutexIndex(monitor, entry->id)].lock);
+            bool held = false;
+            for (int m = 0; m < group.locked && !held; m++) {
+                held = (group.locks[m] == lock);
+            }
+            if (!held) {
+                if (!tryLockSharedMutex(lock)) {
+                    continue;
+                }
+                group.locks[group.locked++] = lock;
+            }
+        }
+        if (entry->state != CACHE_DIRTY) {
+            continue;
+        }
+
+        AsyncFileOp *op = &(group.ops[group.count]);
+        accountFilePath(monitor->directory, entry->id, op->path, sizeof(op->path));
+        op->length = formatMoney(entry->balance, op->buffer);
+        group.entries[group.count++] = entry;
+        if (group.count == ASYNC_IO_FILES || group.locked == ASYNC_IO_FILES) {
+            finishWriteBackGroup(monitor, &group);
+        }
     }
+    finishWriteBackGroup(monitor, &group);
+}
 
-    record.amount = amount;
-    strcpy(record.status, status);
-    strcpy(record.reason, reason);
+/**
+ * @brief Writes dirty cache entries back to their account files.
+ *
+ * In a running batch each entry is written under its account's lock stripe,
+ * and entries whose stripe is busy (including the caller's own) are left
+ * for a later batch. A quiescent flush, made when no transaction can be
+ * changing the cache, writes every dirty entry without locking.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param quiescent Whether no other process can be updating the cache.
+ */
+static void writeBackCache(Monitor *monitor, bool quiescent) {
+    AccountCache *cache = monitor->cache;
+    int expected = 0;
+    while (!__atomic_compare_exchange_n(&(cache->flushing), &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if (!quiescent) {
+            return; // Another process is already writing a batch
+        }
+        expected = 0;
+        sched_yield();
+    }
 
-    // Get current timestamp
-    time_t now = time(NULL);
-    strftime(record.timestamp, sizeof(record.timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    bool async = useAsyncFiles(monitor);
+    for (uint64_t i = 0; i < cache->capacity && !async; i++) {
+        CacheEntry *entry = &(cache->entries[i]);
+        if (__atomic_load_n(&(entry->state), __ATOMIC_ACQUIRE) != CACHE_DIRTY) {
+            continue;
+        }
+
+        pthread_mutex_t *lock = &(monitor->account_mutexes[getAccountMutexIndex(monitor, entry->id)].lock);
+        if (!quiescent && !tryLockSharedMutex(lock)) {
+            continue;
+        }
+        if (entry->state == CACHE_DIRTY) {
+            char filename[ACCOUNT_PATH_LENGTH];
+            accountFilePath(monitor->directory, entry->id, filename, sizeof(filename));
+            writeBalanceFile(filename, entry->balance, monitor->flock_compat);
+            __atomic_store_n(&(entry->state), (uint32_t)CACHE_CLEAN, __ATOMIC_RELEASE);
+            __atomic_sub_fetch(&(cache->dirty), 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&(cache->writebacks), 1, __ATOMIC_RELAXED);
+        }
+        if (!quiescent) {
+            pthread_mutex_unlock(lock);
+        }
+    }
+    if (async) {
+        writeBackEntriesAsync(monitor, quiescent);
+    }
+
+    __atomic_add_fetch(&(cache->batches), 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&(cache->flushing), 0, __ATOMIC_RELEASE);
+}
 
-    // Critical Section Start
-    pthread_mutex_lock(&(monitor->shm_ptr->mutex));
+/**
+ * @brief Writes every dirty cache entry back while transactions keep running.
+ *
+ * Unlike a running batch, which skips busy stripes, this waits for each
+ * dirty entry's stripe, so every change applied before the call is
+ * written back when it returns. The caller must hold no lock stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ */
+static void writeBackCacheLocked(Monitor *monitor) {
+    AccountCache *cache = monitor->cache;
+    int expected = 0;
+    while (!__atomic_compare_exchange_n(&(cache->flushing), &expected, 1, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        expected = 0;
+        sched_yield(); // A running batch only tries its stripes, so it finishes
+    }
 
-    // Write to shared memory
-    int idx = monitor->shm_ptr->transaction_count;
+    for (uint64_t i = 0; i < cache->capacity; i++) {
+        CacheEntry *entry = &(cache->entries[i]);
+        if (__atomic_load_n(&(entry->state), __ATOMIC_ACQUIRE) != CACHE_DIRTY) {
+            continue;
+        }
 
-    if (idx < MAX_TRANSACTIONS) {
-        monitor->shm_ptr->records[idx] = record;
-        monitor->shm_ptr->transaction_count++;
-    } else {
-        printf("Transaction record limit reached.\n");
+        pthread_mutex_t *lock = &(monitor->account_mutexes[getAccountMutexIndex(monitor, entry->id)].lock);
+        lockSharedMutex(lock);
+        if (entry->state == CACHE_DIRTY) {
+            char filename[ACCOUNT_PATH_LENGTH];
+            accountFilePath(monitor->directory, entry->id, filename, sizeof(filename));
+            writeBalanceFile(filename, entry->balance, monitor->flock_compat);
+            __atomic_store_n(&(entry->state), (uint32_t)CACHE_CLEAN, __ATOMIC_RELEASE);
+            __atomic_sub_fetch(&(cache->dirty), 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&(cache->writebacks), 1, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(lock);
+    }
+
+    __atomic_add_fetch(&(cache->batches), 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&(cache->flushing), 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Writes every dirty cache entry back to its account file.
+ *
+ * Only call this while no transaction is running (at shutdown, or before
+ * the final checkpoint).
+ *
+ * @param monitor Pointer to the monitor structure.
+ */
+void monitorFlushCache(Monitor *monitor) {
+    if (monitor->cache != NULL) {
+        writeBackCache(monitor, true);
+    }
+}
+
+/**
+ * @brief Writes an account's balance to the storage backend.
+ *
+ * With the account cache enabled, the change stays in the cache entry and
+ * reaches the account file with the next write-back batch.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @param newBalance The new balance to set for the account.
+ */
+static void writeBalance(Monitor *monitor, const char *accountId, Money newBalance) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        AccountSlot *slot = storeFindAccount(&(monitor->account_store), accountId);
+        if (slot == NULL) {
+            printf("Error updating the account store.\n");
+            return;
+        }
+        slot->balance_cents = newBalance;
+        return;
+    }
+
+    AccountCache *cache = monitor->cache;
+    CacheEntry *entry = (cache != NULL) ? cacheFindEntry(cache, accountId) : NULL;
+    if (entry == NULL) {
+        char filename[ACCOUNT_PATH_LENGTH];
+        accountFilePath(monitor->directory, accountId, filename, sizeof(filename));
+        if (!useAsyncFiles(monitor) || !writeBalanceFileAsync(filename, newBalance)) {
+            writeBalanceFile(filename, newBalance, monitor->flock_compat);
+        }
+        return;
+    }
+
+    entry->balance = newBalance;
+    if (entry->state != CACHE_DIRTY) {
+        __atomic_store_n(&(entry->state), (uint32_t)CACHE_DIRTY, __ATOMIC_RELEASE);
+        if (__atomic_add_fetch(&(cache->dirty), 1, __ATOMIC_RELAXED) >= cache->flush_threshold) {
+            writeBackCache(monitor, false);
+        }
+    }
+}
+
+/**
+ * @brief Loads accounts that are not cached yet into the cache with one io_uring submission per ASYNC_IO_FILES.
+ *
+ * Used before a batch runs, so its first accesses are answered from the
+ * cache instead of each waiting for its own file read. Does nothing
+ * unless the files backend runs with the cache and io_uring. The caller
+ * must hold the accounts' lock stripes.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountIds The accounts the batch touches (duplicates are skipped).
+ * @param count Number of account IDs.
+ */
+void monitorPrefetchBalances(Monitor *monitor, const char *const *accountIds, int count) {
+    AccountCache *cache = monitor->cache;
+    if (monitor->storage_backend != STORAGE_FILES || cache == NULL || !useAsyncFiles(monitor)) {
+        return;
+    }
+
+    AsyncFileOp ops[ASYNC_IO_FILES];
+    const char *ids[ASYNC_IO_FILES];
+    int pending = 0;
+    for (int i = 0; i <= count; i++) {
+        if (i < count) {
+            bool seen = (cacheFindEntry(cache, accountIds[i]) != NULL);
+            for (int j = 0; j < pending && !seen; j++) {
+                seen = (strcmp(ids[j], accountIds[i]) == 0);
+            }
+            if (!seen && !directoryMayContain(monitor->directory, accountIds[i])) {
+                cacheAddEntry(cache, accountIds[i], CACHE_ABSENT, 0);
+                __atomic_add_fetch(&(cache->misses), 1, __ATOMIC_RELAXED);
+            } else if (!seen) {
+                ids[pending] = accountIds[i];
+                accountFilePath(monitor->directory, accountIds[i], ops[pending].path, sizeof(ops[pending].path));
+                pending++;
+            }
+        }
+        if (pending == 0 || (pending < ASYNC_IO_FILES && i < count)) {
+            continue;
+        }
+
+        long readStart = metricsStart(monitor->metrics);
+        if (asyncReadFiles(ops, pending) != 0) {
+            return;
+        }
+        for (int j = 0; j < pending; j++) {
+            Money balance;
+            if (ops[j].result == 0 && parseBalanceText(ops[j].buffer, ops[j].length, &balance)) {
+                cacheAddEntry(cache, ids[j], CACHE_CLEAN, balance);
+            } else if (ops[j].result == -ENOENT) {
+                cacheAddEntry(cache, ids[j], CACHE_ABSENT, 0);
+            } else {
+                continue; // Left for the transaction's own read to report
+            }
+            __atomic_add_fetch(&(cache->misses), 1, __ATOMIC_RELAXED);
+        }
+        metricsAddPhase(monitor->metrics, PHASE_STORAGE_READ, readStart);
+        pending = 0;
+    }
+}
+
+/**
+ * @brief Fills in one entry of a redo record.
+ */
+static void setWalEntry(WalEntry *entry, const char *accountId, WalOperation operation, Money balance) {
+    snprintf(entry->account_id, sizeof(entry->account_id), "%s", accountId);
+    entry->operation = operation;
+    entry->balance_cents = balance;
+}
+
+/**
+ * @brief Makes a change durable in the write-ahead log before it is applied to storage.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param record The redo record (ignored if the log is disabled).
+ * @return The record's LSN, or 0 if the log is disabled.
+ */
+static uint64_t logAccountChange(Monitor *monitor, WalRecord *record) {
+    if (monitor->wal == NULL) {
+        return 0;
+    }
+    uint64_t lsn = walAppend(monitor->wal, record);
+    walCommit(monitor->wal, lsn);
+    return lsn;
+}
+
+/**
+ * @brief Marks a logged change as applied.
+ *
+ * The caller still holds lock stripes, so a checkpoint that falls due is
+ * left for exitMonitor or exitMonitorBatch to run.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param lsn LSN returned by logAccountChange.
+ */
+static void finishAccountChange(Monitor *monitor, uint64_t lsn) {
+    if (monitor->wal != NULL && walApplied(monitor->wal, lsn)) {
+        checkpoint_due = true;
+    }
+}
+
+/**
+ * @brief Updates the balance of an account.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @param newBalance The new balance to set for the account.
+ */
+void monitorUpdateBalance(Monitor *monitor, const char *accountId, Money newBalance) {
+    WalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.count = 1;
+    setWalEntry(&record.entries[0], accountId, WAL_SET_BALANCE, newBalance);
+
+    long writeStart = metricsStart(monitor->metrics);
+    uint64_t lsn = logAccountChange(monitor, &record);
+    int stripe = beginAccountWrite(monitor, accountId);
+    writeBalance(monitor, accountId, newBalance);
+    endAccountWrite(monitor, stripe);
+    finishAccountChange(monitor, lsn);
+    metricsAddPhase(monitor->metrics, PHASE_STORAGE_WRITE, writeStart);
+}
+
+/**
+ * @brief Updates the balances of two accounts as one logged change (used by transfers).
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The first account ID.
+ * @param newBalance The first account's new balance.
+ * @param otherAccountId The second account ID, written after the first.
+ * @param otherBalance The second account's new balance.
+ */
+void monitorUpdateBalances(Monitor *monitor, const char *accountId, Money newBalance, const char *otherAccountId, Money otherBalance) {
+    WalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.count = 2;
+    setWalEntry(&record.entries[0], accountId, WAL_SET_BALANCE, newBalance);
+    setWalEntry(&record.entries[1], otherAccountId, WAL_SET_BALANCE, otherBalance);
+
+    long writeStart = metricsStart(monitor->metrics);
+    uint64_t lsn = logAccountChange(monitor, &record);
+    int stripe = beginAccountWrite(monitor, accountId);
+    writeBalance(monitor, accountId, newBalance);
+    endAccountWrite(monitor, stripe);
+    stripe = beginAccountWrite(monitor, otherAccountId);
+    writeBalance(monitor, otherAccountId, otherBalance);
+    endAccountWrite(monitor, stripe);
+    finishAccountChange(monitor, lsn);
+    metricsAddPhase(monitor->metrics, PHASE_STORAGE_WRITE, writeStart);
+}
+
+/**
+ * @brief Orders combined updates by their lane ticket (for qsort).
+ */
+static int compareCombineRequests(const void *a, const void *b) {
+    long ticketA = (*(CombineRequest *const *)a)->ticket;
+    long ticketB = (*(CombineRequest *const *)b)->ticket;
+    return (ticketA > ticketB) - (ticketA < ticketB);
+}
+
+/**
+ * @brief Applies a hot account's pending updates with one storage write; the caller holds its stripe.
+ *
+ * Updates are applied in ticket order, so each submitter sees the balance
+ * it would have seen had it run alone. Submitters admitted before a running
+ * report's cut come first in that order; if the rest need a before-image
+ * and the report's table is full, they stay pending until it finishes.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param hot The hot account.
+ * @return false if updates were left pending for a report.
+ */
+static bool combineHotAccount(Monitor *monitor, HotAccount *hot) {
+    CombineRequest *pending[COMBINE_REQUESTS];
+    int count = 0;
+    for (int i = 0; i < COMBINE_REQUESTS; i++) {
+        if (__atomic_load_n(&(hot->requests[i].state), __ATOMIC_ACQUIRE) == COMBINE_PENDING) {
+            pending[count++] = &(hot->requests[i]);
+        }
+    }
+    if (count == 0) {
+        return true;
+    }
+    qsort(pending, count, sizeof(pending[0]), compareCombineRequests);
+
+    Money balance = monitorGetBalance(monitor, hot->id);
+    if (balance < 0) {
+        for (int i = 0; i < count; i++) {
+            pending[i]->balance = -1;
+            pending[i]->reason = REASON_ACCOUNT_NOT_FOUND;
+            __atomic_store_n(&(pending[i]->state), (uint32_t)COMBINE_DONE, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+
+    // Updates admitted after the cut come last, so the balance after the
+    // earlier ones is the one the report must see
+    AccountSnapshot *snapshot = monitor->snapshot;
+    int apply = 0;
+    Money cutBalance = balance;
+    for (; apply < count; apply++) {
+        long epoch = pending[apply]->epoch;
+        if (snapshot != NULL && epoch != -1 && snapshotWantsBeforeImage(snapshot, epoch)) {
+            if (snapshotFindEntry(snapshot, hot->id) == NULL && !snapshotAddEntry(snapshot, hot->id, cutBalance)) {
+                break;
+            }
+            apply = count;
+            break;
+        }
+        cutBalance += pending[apply]->amount;
+    }
+    if (apply == 0) {
+        return false;
+    }
+
+    for (int i = 0; i < apply; i++) {
+        balance += pending[i]->amount;
+        pending[i]->balance = balance;
+    }
+
+    WalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.count = 1;
+    setWalEntry(&record.entries[0], hot->id, WAL_SET_BALANCE, balance);
+
+    long writeStart = metricsStart(monitor->metrics);
+    uint64_t lsn = logAccountChange(monitor, &record);
+    long *version = &(monitor->account_mutexes[hot->stripe].version);
+    __atomic_add_fetch(version, 1, __ATOMIC_SEQ_CST);
+    writeBalance(monitor, hot->id, balance);
+    __atomic_add_fetch(version, 1, __ATOMIC_RELEASE);
+    finishAccountChange(monitor, lsn);
+    metricsAddPhase(monitor->metrics, PHASE_STORAGE_WRITE, writeStart);
+
+    for (int i = 0; i < apply; i++) {
+        pending[i]->reason = REASON_NONE;
+        __atomic_store_n(&(pending[i]->state), (uint32_t)COMBINE_DONE, __ATOMIC_RELEASE);
+    }
+    hot->combined += apply;
+    hot->writes++;
+    return apply == count;
+}
+
+/**
+ * @brief Applies the pending combined updates of every hot account on a stripe; the caller holds the stripe.
+ *
+ * @param monitor Pointer to the monitor structure (with a combiner).
+ * @param index The stripe index.
+ * @return false if updates were left pending for a running report.
+ */
+bool monitorCombineStripe(Monitor *monitor, int index) {
+    AccountCombiner *combiner = monitor->combiner;
+    int hot = __atomic_load_n(&(combiner->hot), __ATOMIC_ACQUIRE);
+    bool done = true;
+    for (int i = 0; i < hot && i < HOT_ACCOUNT_SLOTS; i++) {
+        if (combiner->accounts[i].stripe == index) {
+            done = combineHotAccount(monitor, &(combiner->accounts[i])) && done;
+        }
+    }
+    return done;
+}
+
+/**
+ * @brief Finds out whether an update of an account should be combined; the caller holds its lane exclusively.
+ *
+ * With detection on, an update that finds at least HOT_LANE_DEPTH tickets
+ * drawn on the account's lane counts as contended, and the account is
+ * promoted once enough of its updates were.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account being updated.
+ * @return The hot account, or NULL to update it the usual way.
+ */
+HotAccount *monitorHotAccount(Monitor *monitor, const char *accountId) {
+    AccountCombiner *combiner = monitor->combiner;
+    if (combiner == NULL) {
+        return NULL;
+    }
+    HotAccount *hot = findHotAccount(combiner, accountId);
+    if (hot != NULL || !combiner->detect) {
+        return hot;
+    }
+
+    int index = getAccountMutexIndex(monitor, accountId);
+    AdmissionLane *lane = &(monitor->lanes[index]);
+    long depth = __atomic_load_n(&(lane->next_ticket), __ATOMIC_RELAXED) -
+                 __atomic_load_n(&(lane->now_serving), __ATOMIC_RELAXED);
+    if (depth < HOT_LANE_DEPTH || !noteContendedUpdate(combiner, accountId)) {
+        return NULL;
+    }
+    return promoteHotAccount(combiner, accountId, index);
+}
+
+/**
+ * @brief Adds an amount to a hot account by combining it with other pending updates.
+ *
+ * The update is published with the caller's ticket and the account's lane
+ * is handed on at once, so later tickets queue their own updates instead of
+ * waiting. Whichever process next holds the account's stripe applies every
+ * pending update with one write; until then the caller helps by trying to
+ * take the stripe itself, after giving the processes queued behind it up
+ * to COMBINE_WINDOW_YIELDS yields to publish theirs. On return the request holds the outcome; the
+ * caller records it and then frees the request with releaseCombineRequest.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param hot The hot account; the caller holds its lane exclusively.
+ * @param request A request claimed with claimCombineRequest.
+ * @param amount The amount to add.
+ */
+void monitorCombineDelta(Monitor *monitor, HotAccount *hot, CombineRequest *request, Money amount) {
+    request->amount = amount;
+    request->ticket = heldLaneTicket(hot->stripe);
+    request->epoch = held_epoch;
+    __atomic_store_n(&(request->state), (uint32_t)COMBINE_PENDING, __ATOMIC_RELEASE);
+    handOnLane(monitor, hot->stripe);
+
+    long waitStart = metricsStart(monitor->metrics);
+    // Combine window: while submitters are queued behind on the lane, let
+    // them publish their updates first, so one write applies them all
+    AdmissionLane *lane = &(monitor->lanes[hot->stripe]);
+    for (int i = 0; i < COMBINE_WINDOW_YIELDS && __atomic_load_n(&(request->state), __ATOMIC_ACQUIRE) != COMBINE_DONE &&
+                    __atomic_load_n(&(lane->next_ticket), __ATOMIC_RELAXED) >
+                        __atomic_load_n(&(lane->now_serving), __ATOMIC_RELAXED); i++) {
+        sched_yield();
+    }
+    pthread_mutex_t *lock = &(monitor->account_mutexes[hot->stripe].lock);
+    for (int spin = 1; __atomic_load_n(&(request->state), __ATOMIC_ACQUIRE) != COMBINE_DONE; spin++) {
+        if (tryLockSharedMutex(lock)) {
+            monitorCombineStripe(monitor, hot->stripe);
+            pthread_mutex_unlock(lock);
+        } else if (spin % 64 == 0) {
+            sched_yield();
+        }
+    }
+    metricsAddPhase(monitor->metrics, PHASE_LOCK_WAIT, waitStart);
+}
+
+/**
+ * @brief Waits until the combined updates of a hot account published before the caller's ticket are applied and recorded.
+ *
+ * Does nothing for other accounts. The caller holds the account's lane
+ * (shared or exclusive), so no new update can be published meanwhile.
+ * Every reader and every writer that does not combine calls this before
+ * it records itself, so the log lists an account's transactions in ticket
+ * order. A caller holding the account's stripe only waits for the
+ * submitters to record: lockAccountMutex has applied their updates.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account about to be read.
+ */
+void monitorSettleHotAccount(Monitor *monitor, const char *accountId) {
+    HotAccount *hot = (monitor->combiner != NULL) ? findHotAccount(monitor->combiner, accountId) : NULL;
+    if (hot == NULL) {
+        return;
+    }
+    pthread_mutex_t *lock = &(monitor->account_mutexes[hot->stripe].lock);
+    for (int i = 0, spin = 1; i < COMBINE_REQUESTS; spin++) {
+        uint32_t state = __atomic_load_n(&(hot->requests[i].state), __ATOMIC_ACQUIRE);
+        if (state == COMBINE_FREE) {
+            i++;
+        } else if (state == COMBINE_PENDING && tryLockSharedMutex(lock)) {
+            monitorCombineStripe(monitor, hot->stripe);
+            pthread_mutex_unlock(lock);
+        } else if (spin % 64 == 0) {
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief Adds a new account to the storage backend.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @param name The name of the account holder.
+ * @param initialBalance The initial balance for the account.
+ * @return 0 on success, or -1 if the account could not be stored.
+ */
+static int storeNewAccount(Monitor *monitor, const char *accountId, const char *name, Money initialBalance) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        if (storeCreateAccount(&(monitor->account_store), accountId, name, initialBalance) != 0) {
+            printf("Error adding account %s to the account store.\n", accountId);
+            return -1;
+        }
+        return 0;
+    }
+
+    char filename[ACCOUNT_PATH_LENGTH];
+    accountFilePath(monitor->directory, accountId, filename, sizeof(filename));
+    directoryAddAccount(monitor->directory, accountId);
+
+    int fd = open(filename, O_WRONLY | O_CREAT, 0666);
+
+    if (fd == -1) {
+        printf("Error creating account file: %s\n", filename);
+        return -1;
+    }
+
+    // Write initial balance
+    char buffer[MONEY_TEXT_LENGTH];
+    write(fd, buffer, formatMoney(initialBalance, buffer));
+    close(fd);
+
+    if (monitor->cache != NULL) {
+        CacheEntry *entry = cacheFindEntry(monitor->cache, accountId);
+        if (entry == NULL) {
+            cacheAddEntry(monitor->cache, accountId, CACHE_CLEAN, initialBalance);
+        } else {
+            entry->balance = initialBalance;
+            __atomic_store_n(&(entry->state), (uint32_t)CACHE_CLEAN, __ATOMIC_RELEASE);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Removes an account from the storage backend.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @return 0 on success, or -1 on failure.
+ */
+static int removeAccount(Monitor *monitor, const char *accountId) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        return storeDeleteAccount(&(monitor->account_store), accountId);
+    }
+
+    char filename[ACCOUNT_PATH_LENGTH];
+    accountFilePath(monitor->directory, accountId, filename, sizeof(filename));
+    if (remove(filename) != 0) {
+        return -1;
+    }
+    directoryRemoveAccount(monitor->directory, accountId);
+
+    CacheEntry *entry = (monitor->cache != NULL) ? cacheFindEntry(monitor->cache, accountId) : NULL;
+    if (entry != NULL) {
+        if (entry->state == CACHE_DIRTY) {
+            __atomic_sub_fetch(&(monitor->cache->dirty), 1, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&(entry->state), (uint32_t)CACHE_ABSENT, __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+/**
+ * @brief Creates the storage for a new account.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @param name The name of the account holder.
+ * @param initialBalance The initial balance for the account.
+ * @return 0 on success, or -1 if the account could not be stored.
+ */
+int monitorCreateAccount(Monitor *monitor, const char *accountId, const char *name, Money initialBalance) {
+    WalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.count = 1;
+    setWalEntry(&record.entries[0], accountId, WAL_CREATE, initialBalance);
+    strncpy(record.name, name, ACCOUNT_NAME_LENGTH - 1);
+
+    long writeStart = metricsStart(monitor->metrics);
+    uint64_t lsn = logAccountChange(monitor, &record);
+    int stripe = beginAccountWrite(monitor, accountId);
+    int result = storeNewAccount(monitor, accountId, name, initialBalance);
+    endAccountWrite(monitor, stripe);
+    finishAccountChange(monitor, lsn);
+    metricsAddPhase(monitor->metrics, PHASE_STORAGE_WRITE, writeStart);
+    return result;
+}
+
+/**
+ * @brief Deletes the storage of an account.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @return 0 on success, or -1 on failure.
+ */
+int monitorDeleteAccount(Monitor *monitor, const char *accountId) {
+    WalRecord record;
+    memset(&record, 0, sizeof(record));
+    record.count = 1;
+    setWalEntry(&record.entries[0], accountId, WAL_DELETE, 0);
+
+    long writeStart = metricsStart(monitor->metrics);
+    uint64_t lsn = logAccountChange(monitor, &record);
+    int stripe = beginAccountWrite(monitor, accountId);
+    int result = removeAccount(monitor, accountId);
+    endAccountWrite(monitor, stripe);
+    finishAccountChange(monitor, lsn);
+    metricsAddPhase(monitor->metrics, PHASE_STORAGE_WRITE, writeStart);
+    return result;
+}
+
+/**
+ * @brief Flushes every account change made so far to disk.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param quiescent Whether no other process can be changing accounts.
+ */
+static void syncAccountStorage(Monitor *monitor, bool quiescent) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        msync(monitor->account_store.header, monitor->account_store.mapped_size, MS_SYNC);
+        return;
+    }
+
+    if (quiescent) {
+        monitorFlushCache(monitor);
+    } else if (monitor->cache != NULL) {
+        writeBackCacheLocked(monitor);
+    }
+
+    // Account files live in (or below) the working directory; syncing its
+    // filesystem also covers files created or removed since the last checkpoint
+    int fd = open(".", O_RDONLY);
+    if (fd != -1) {
+        syncfs(fd);
+        close(fd);
+    }
+}
+
+/**
+ * @brief Checkpoints the account store: once it is on disk, the applied records leave the write-ahead log.
+ *
+ * Transactions keep running meanwhile. The checkpoint covers every record
+ * up to the lowest one not yet applied; later records stay in the log for
+ * the next checkpoint. The caller must hold no lock stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param force Checkpoint even if the checkpoint interval has not been reached
+ *              (only while no transaction is running; the log is left empty).
+ */
+void monitorCheckpoint(Monitor *monitor, bool force) {
+    checkpoint_due = false;
+    if (monitor->wal == NULL || !walBeginCheckpoint(monitor->wal, force)) {
+        return;
+    }
+    syncAccountStorage(monitor, force);
+    walEndCheckpoint(monitor->wal);
+}
+
+/**
+ * @brief Checks whether an account's storage exists, whether or not it can be read.
+ *
+ * Recovery asks this rather than monitorGetBalance: a crash can leave an
+ * account file empty or torn, and its balance must still be rewritten.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account ID as a string.
+ * @return true if the account slot or file exists.
+ */
+static bool accountStored(Monitor *monitor, const char *accountId) {
+    if (monitor->storage_backend == STORAGE_MAPPED) {
+        return storeFindAccount(&(monitor->account_store), accountId) != NULL;
+    }
+    char filename[ACCOUNT_PATH_LENGTH];
+    accountFilePath(monitor->directory, accountId, filename, sizeof(filename));
+    struct stat info;
+    return stat(filename, &info) == 0;
+}
+
+/**
+ * @brief Replays the records of one log file.
+ *
+ * Every balance a record carries is written again, so account files a
+ * crash left torn are restored as well.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param fd The log file, positioned at its start.
+ * @param afterLsn Records up to this LSN are skipped.
+ * @param lastLsn Receives the LSN of the last record replayed (unchanged if none).
+ * @return The number of records replayed.
+ */
+static long replayWalFile(Monitor *monitor, int fd, uint64_t afterLsn, uint64_t *lastLsn) {
+    long replayed = 0;
+    WalRecord record;
+    while (walReadRecord(fd, &record)) {
+        if (record.lsn <= afterLsn) {
+            continue;
+        }
+        for (uint32_t i = 0; i < record.count; i++) {
+            WalEntry *entry = &(record.entries[i]);
+            Money balance = entry->balance_cents;
+            bool exists = accountStored(monitor, entry->account_id);
+
+            if (entry->operation == WAL_DELETE) {
+                if (exists) {
+                    removeAccount(monitor, entry->account_id);
+                }
+            } else if (exists) {
+                writeBalance(monitor, entry->account_id, balance);
+            } else if (entry->operation == WAL_CREATE) {
+                storeNewAccount(monitor, entry->account_id, record.name, balance);
+            }
+        }
+        *lastLsn = record.lsn;
+        replayed++;
+    }
+    return replayed;
+}
+
+/**
+ * @brief Replays a write-ahead log left behind by a crash, then empties it.
+ *
+ * Must run before monitor->wal is set, so the replayed changes are not logged again.
+ * Replay stops at the first torn record; its transaction was never acknowledged.
+ * A crash during a checkpoint can leave records only in the compaction file
+ * (see walEndCheckpoint); those past the log's last record are replayed after it.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param walPath Path of the log file.
+ * @return The number of records replayed, or -1 if the log could not be read.
+ */
+long monitorRecoverAccounts(Monitor *monitor, const char *walPath) {
+    char compactionPath[WAL_PATH_LENGTH + 16];
+    walCompactionPath(walPath, compactionPath, sizeof(compactionPath));
+
+    int fd = open(walPath, O_RDONLY);
+    if (fd == -1 && errno != ENOENT) {
+        return -1;
+    }
+    long replayed = 0;
+    uint64_t lastLsn = 0;
+    if (fd != -1) {
+        replayed = replayWalFile(monitor, fd, 0, &lastLsn);
+        close(fd);
+    }
+    int compactionFd = open(compactionPath, O_RDONLY);
+    if (compactionFd != -1) {
+        replayed += replayWalFile(monitor, compactionFd, lastLsn, &lastLsn);
+        close(compactionFd);
+    }
+    if (fd == -1 && compactionFd == -1) {
+        return 0;
+    }
+
+    syncAccountStorage(monitor, true);
+    if (fd != -1 && truncate(walPath, 0) == -1) {
+        printf("Error truncating write-ahead log: %s\n", walPath);
+        return -1;
+    }
+    if (compactionFd != -1) {
+        unlink(compactionPath);
+    }
+    return replayed;
+}
+
+/**
+ * @brief Records of the batch this process is applying, or NULL when records are appended one at a time.
+ */
+static TransactionRecord *batch_records = NULL;
+static long batch_count = 0;
+
+/**
+ * @brief Records a transaction in shared memory.
+ *
+ * Inside monitorBeginRecordBatch/monitorEndRecordBatch the record is only
+ * collected, and the whole batch is appended at the end.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param type The type of transaction (e.g., TXN_DEPOSIT, TXN_WITHDRAW).
+ * @param accountId The account ID associated with the transaction.
+ * @param amount The transaction amount.
+ * @param status The status of the transaction (TXN_SUCCESS or TXN_FAILED).
+ * @param reason The reason for the transaction status (REASON_NONE on success).
+ * @param recipientAccountId (Optional) The recipient account ID for transactions like TXN_TRANSFER.
+ */
+void monitorRecordTransaction(Monitor *monitor, TransactionType type, const char *accountId, Money amount, TransactionStatus status, TransactionReason reason, const char *recipientAccountId) {
+    TransactionRecord record;
+    record.transaction_type = type;
+    record.status = status;
+    record.reason = reason;
+    record.amount = amount;
+
+    strncpy(record.account_id, accountId, ACCOUNT_ID_LENGTH - 1);
+    record.account_id[ACCOUNT_ID_LENGTH - 1] = '\0';
+
+    if (recipientAccountId != NULL) {
+        strncpy(record.recipient_account_id, recipientAccountId, ACCOUNT_ID_LENGTH - 1);
+        record.recipient_account_id[ACCOUNT_ID_LENGTH - 1] = '\0';
+    } else {
+        record.recipient_account_id[0] = '\0';
+    }
+
+    // Get current timestamp
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    record.timestamp_ns = (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+
+    if (batch_records != NULL) {
+        batch_records[batch_count++] = record;
+        return;
+    }
+
+    long appendStart = metricsStart(monitor->metrics);
+    appendTransaction(monitor->shm_ptr, &record);
+    metricsAddPhase(monitor->metrics, PHASE_LOG_APPEND, appendStart);
+    metricsEndTransaction(monitor->metrics, type, reason);
+}
+
+/**
+ * @brief Starts collecting this process's transaction records instead of appending each one.
+ *
+ * @param records Buffer with room for every record of the batch.
+ */
+void monitorBeginRecordBatch(TransactionRecord *records) {
+    batch_records = records;
+    batch_count = 0;
+}
+
+/**
+ * @brief Appends the records collected since monitorBeginRecordBatch to the log in one step.
+ *
+ * Every transaction of the batch is counted in the metrics with the
+ * batch's phase times, since none of them completes before the batch does.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @return Number of records appended.
+ */
+long monitorEndRecordBatch(Monitor *monitor) {
+    long count = batch_count;
+    long appendStart = metricsStart(monitor->metrics);
+    appendTransactions(monitor->shm_ptr, batch_records, count);
+    metricsAddPhase(monitor->metrics, PHASE_LOG_APPEND, appendStart);
+    for (long i = 0; i < count; i++) {
+        metricsEndTransaction(monitor->metrics, batch_records[i].transaction_type, batch_records[i].reason);
     }
 
-    pthread_mutex_unlock(&(monitor->shm_ptr->mutex));
-    // Critical Section End
+    batch_records = NULL;
+    batch_count = 0;
+    return count;
 }
@@ -10,37 +10,154 @@
 #include <iostream>
 #include <unistd.h>
 #include <sys/file.h>
+#include <fcntl.h>
+#include <signal.h>
 #include <errno.h>
 #include <time.h>
 #include <string.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 using namespace std;
 
+#define MONITOR_SPIN_LIMIT 100          // Checks of a lane's now_serving before a waiter sleeps
+#define MONITOR_LIVENESS_CHECK_MS 100   // How long a waiter sleeps before checking that the lane's holder is alive
 
+/**
+ * @brief Blocks while a process-shared futex word still holds the expected value.
+ *
+ * @return false if the timeout passed first.
+ */
+static bool futexWait(uint32_t *word, uint32_t expected, long timeoutMs) {
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+    return syscall(SYS_futex, word, FUTEX_WAIT, expected, &timeout, NULL, 0) == 0 || errno != ETIMEDOUT;
+}
+
+/**
+ * @brief Wakes every process blocked on a process-shared futex word.
+ */
+static void futexWakeAll(uint32_t *word) {
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * @brief Checks whether a process has exited (including one that is a zombie not yet waited for).
+ *
+ * @param pid The process.
+ * @return true if the process no longer runs.
+ */
+bool processExited(pid_t pid) {
+    if (kill(pid, 0) == -1) {
+        return errno == ESRCH;
+    }
+    char path[32], stat[256];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    ssize_t length = read(fd, stat, sizeof(stat) - 1);
+    close(fd);
+    if (length <= 0) {
+        return false;
+    }
+    stat[length] = '\0';
+    const char *end = strrchr(stat, ')'); // The state follows the command name
+    return end != NULL && end[1] == ' ' && (end[2] == 'Z' || end[2] == 'X');
+}
+
+/**
+ * @brief Rounds a size up to a whole number of cache lines.
+ */
+static size_t cacheLineAlign(size_t size) {
+    return (size + 63) & ~(size_t)63;
+}
+
+/**
+ * @brief Computes the memory needed for a monitor and its lock table.
+ *
+ * @param lockStripes Number of lock stripes (already a power of two).
+ * @return Size in bytes of the monitor, its admission lanes and its lock stripes.
+ */
+size_t monitorSize(int lockStripes) {
+    return cacheLineAlign(sizeof(Monitor)) + lockStripes * (sizeof(AdmissionLane) + sizeof(LockStripe));
+}
 
 /**
  * @brief Initializes the monitor and its synchronization primitives.
  *
- * @param monitor Pointer to the monitor structure to initialize.
+ * @param monitor Pointer to the monitor structure to initialize, followed by
+ *                monitorSize(lockStripes) bytes of shared memory.
  * @param shm_ptr Pointer to the shared memory segment.
+ * @param lockStripes Number of admission lanes and account lock stripes (power of two).
  */
-void initializeMonitor(Monitor *monitor, SharedMemorySegment *shm_ptr) {
-    pthread_mutexattr_t mutexAttr;
-    pthread_mutexattr_init(&mutexAttr);
-    // Set the mutex to be shared between processes
-    pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
-    pthread_mutex_init(&(monitor->mutex), &mutexAttr);
+void initializeMonitor(Monitor *monitor, SharedMemorySegment *shm_ptr, int lockStripes) {
+    initializeSharedMutex(&(monitor->admission_mutex));
+
+    monitor->lock_stripes = lockStripes;
+    monitor->lanes = (AdmissionLane *)((char *)monitor + cacheLineAlign(sizeof(Monitor)));
+    monitor->account_mutexes = (LockStripe *)(monitor->lanes + lockStripes);
 
-    pthread_condattr_t condAttr;
-    pthread_condattr_init(&condAttr);
-    pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
-    pthread_cond_init(&(monitor->cond), &condAttr);
+    for (int i = 0; i < lockStripes; i++) {
+        LockStripe *stripe = &(monitor->account_mutexes[i]);
+        initializeSharedMutex(&(stripe->lock));
+        stripe->fill = 0;
+        stripe->version = 0;
+        stripe->holder_hash = 0;
 
-    for (int i = 0; i < MAX_ACCOUNTS; i++) {
-        pthread_mutex_init(&(monitor->account_mutexes[i]), &mutexAttr);
+        monitor->lanes[i].next_ticket = 0;
+        monitor->lanes[i].now_serving = 0;
+        monitor->lanes[i].wake = 0;
+        monitor->lanes[i].sleeping = 0;
+        monitor->lanes[i].readers = 0;
+        monitor->lanes[i].holder_hash = 0;
+        monitor->lanes[i].holder_pid = 0;
+        monitor->lanes[i].holder_ticket = -1;
+        monitor->lanes[i].holder_next = 0;
+    }
+    resetLockTableStats(monitor);
+
+    attachMonitor(monitor, shm_ptr);
+}
+
+/**
+ * @brief Prepares a monitor initialized by an earlier run for a new run.
+ *
+ * Takes constant time: the admission lanes and lock stripes are reused as
+ * the earlier run left them, which is only valid if every process of that
+ * run exited the monitor (see openSharedSegment). The lock table is found
+ * again from the monitor's own address, and every per-run setting is reset.
+ *
+ * @param monitor Pointer to the monitor structure, followed by its lanes and stripes.
+ * @param shm_ptr Pointer to the shared memory segment.
+ */
+void attachMonitor(Monitor *monitor, SharedMemorySegment *shm_ptr) {
+    monitor->lanes = (AdmissionLane *)((char *)monitor + cacheLineAlign(sizeof(Monitor)));
+    monitor->account_mutexes = (LockStripe *)(monitor->lanes + monitor->lock_stripes);
+
+    monitor->next_ticket = 0;
+    for (int i = 0; i < MAX_QUEUED_PROCESSES; i++) {
+        monitor->process_queue[i].ticket = -1;
+        monitor->process_queue[i].pid = 0;
     }
 
     monitor->shm_ptr = shm_ptr;
+    monitor->storage_backend = STORAGE_FILES;
+    monitor->account_store.header = NULL;
+    monitor->account_store.slots = NULL;
+    monitor->wal = NULL;
+    monitor->cache = NULL;
+    monitor->directory = NULL;
+    monitor->metrics = NULL;
+    monitor->output = NULL;
+    monitor->snapshot = NULL;
+    monitor->combiner = NULL;
+    monitor->optimistic_reads = false;
+    monitor->async_io = false;
+    monitor->flock_compat = false;
 }
 
 /**
@@ -49,29 +166,375 @@ void initializeMonitor(Monitor *monitor, SharedMemorySegment *shm_ptr) {
  * @param monitor Pointer to the monitor structure to destroy.
  */
 void destroyMonitor(Monitor *monitor) {
-    pthread_mutex_destroy(&(monitor->mutex));
-    pthread_cond_destroy(&(monitor->cond));
-    for (int i = 0; i < MAX_ACCOUNTS; i++) {
-        pthread_mutex_destroy(&(monitor->account_mutexes[i]));
+    pthread_mutex_destroy(&(monitor->admission_mutex));
+    for (int i = 0; i < monitor->lock_stripes; i++) {
+        pthread_mutex_destroy(&(monitor->account_mutexes[i].lock));
     }
 }
 
 /**
- * @brief Enters the monitor by adding the process to the queue.
+ * @brief Tickets pre-assigned to this process by a dispatcher (count 0 if enterMonitor should draw them).
+ */
+static MonitorTicket assigned_ticket = {0, {0, 0}, {0, 0}};
+
+/**
+ * @brief Tickets this process is being served on (count 0 outside the monitor).
+ */
+static MonitorTicket held_ticket = {0, {0, 0}, {0, 0}};
+
+/**
+ * @brief process_queue entry registered by this process while it is in the monitor.
+ */
+static long held_registration = -1;
+
+/**
+ * @brief Whether this process holds its lane shared (entered with enterMonitorShared).
+ */
+static bool held_shared = false;
+
+/**
+ * @brief Snapshot epoch this process was admitted into as a writer, or -1.
+ */
+static long held_epoch = -1;
+
+/**
+ * @brief Set when a change this process applied made a checkpoint due; run once it holds no lock stripe.
+ */
+static bool checkpoint_due = false;
+
+/**
+ * @brief Draws a ticket on every admission lane a transaction touches.
+ *
+ * Lanes are the account mutex indexes of the accounts involved. Draws that
+ * span two lanes are serialized so every pair of transactions is ordered the
+ * same way on all lanes they share, which keeps admission deadlock-free.
+ * Callers that draw in input order (the worker pool's parser) therefore
+ * preserve the per-account order of the input.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account the transaction touches.
+ * @param otherAccountId A second account (TRANSFER recipient), or NULL.
+ * @param ticket Receives the lanes and tickets.
+ */
+void reserveMonitorTicket(Monitor *monitor, const char *accountId, const char *otherAccountId, MonitorTicket *ticket) {
+    int lane = getAccountMutexIndex(monitor, accountId);
+    int otherLane = (otherAccountId != NULL) ? getAccountMutexIndex(monitor, otherAccountId) : lane;
+
+    if (lane == otherLane) {
+        ticket->count = 1;
+        ticket->lanes[0] = lane;
+        ticket->tickets[0] = __atomic_fetch_add(&(monitor->lanes[lane].next_ticket), 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    ticket->count = 2;
+    ticket->lanes[0] = lane < otherLane ? lane : otherLane;
+    ticket->lanes[1] = lane < otherLane ? otherLane : lane;
+
+    lockSharedMutex(&(monitor->admission_mutex));
+    for (int i = 0; i < 2; i++) {
+        ticket->tickets[i] = __atomic_fetch_add(&(monitor->lanes[ticket->lanes[i]].next_ticket), 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&(monitor->admission_mutex));
+}
+
+/**
+ * @brief Assigns the tickets used by this process's next call to enterMonitor.
+ *
+ * The worker pool reserves tickets in input-file order so transactions on
+ * the same account are admitted in that order no matter which worker picked
+ * them up.
  *
- * The process will block until it is the first in the queue.
+ * @param ticket Tickets from reserveMonitorTicket for the same accounts.
+ */
+void assignMonitorTicket(const MonitorTicket *ticket) {
+    assigned_ticket = *ticket;
+}
+
+/**
+ * @brief Checks whether a lane admits a ticket.
+ *
+ * A shared holder is admitted as soon as its ticket is served; an exclusive
+ * one also waits for the shared holders admitted before it to exit.
+ */
+static bool laneAdmits(AdmissionLane *lane, long ticket, bool shared) {
+    if (__atomic_load_n(&(lane->now_serving), __ATOMIC_SEQ_CST) != ticket) {
+        return false;
+    }
+    return shared || __atomic_load_n(&(lane->readers), __ATOMIC_SEQ_CST) == 0;
+}
+
+/**
+ * @brief Hands a lane on for its exclusive holder if that process died inside the monitor.
+ *
+ * Without this, every later ticket on the lane would wait forever. The
+ * account stripes the holder had locked are robust mutexes, so they are
+ * recovered by the next process to lock them.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param index The lane index.
+ */
+static void takeOverLane(Monitor *monitor, int index) {
+    AdmissionLane *lane = &(monitor->lanes[index]);
+    long serving = __atomic_load_n(&(lane->now_serving), __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&(lane->holder_ticket), __ATOMIC_ACQUIRE) != serving) {
+        return; // The current ticket is not held exclusively (yet)
+    }
+    pid_t holder = __atomic_load_n(&(lane->holder_pid), __ATOMIC_RELAXED);
+    long next = __atomic_load_n(&(lane->holder_next), __ATOMIC_RELAXED);
+    if (holder == 0 || !processExited(holder)) {
+        return;
+    }
+    if (__atomic_compare_exchange_n(&(lane->now_serving), &serving, next, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        fprintf(stderr, "Process %d exited inside the monitor; its tickets were released.\n", (int)holder);
+        // A change it left half done must not keep optimistic readers waiting
+        long *version = &(monitor->account_mutexes[index].version);
+        if (__atomic_load_n(version, __ATOMIC_ACQUIRE) & 1) {
+            __atomic_add_fetch(version, 1, __ATOMIC_RELEASE);
+        }
+        __atomic_add_fetch(&(lane->wake), 1, __ATOMIC_SEQ_CST);
+        futexWakeAll(&(lane->wake));
+    }
+}
+
+/**
+ * @brief Records the process just admitted exclusively on a lane, so takeOverLane can release it.
+ *
+ * @param lane The lane.
+ * @param pid The admitted process.
+ * @param ticket The ticket it was admitted with.
+ * @param nextTicket The ticket the lane goes to when it exits.
+ */
+static void claimLane(AdmissionLane *lane, pid_t pid, long ticket, long nextTicket) {
+    __atomic_store_n(&(lane->holder_pid), pid, __ATOMIC_RELAXED);
+    __atomic_store_n(&(lane->holder_next), nextTicket, __ATOMIC_RELAXED);
+    __atomic_store_n(&(lane->holder_ticket), ticket, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Blocks until a lane admits the given ticket.
+ *
+ * A wait is timed and added to the lane's lock stripe statistics, counted as
+ * a collision when the lane is held on behalf of a different account.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param index The lane index.
+ * @param ticket The ticket to wait for.
+ * @param hash Hash of the account being admitted.
+ * @param shared Whether the ticket's holder only reads (see enterMonitorShared).
+ */
+static void waitForLane(Monitor *monitor, int index, long ticket, uint64_t hash, bool shared = false) {
+    AdmissionLane *lane = &(monitor->lanes[index]);
+    if (laneAdmits(lane, ticket, shared)) {
+        __atomic_store_n(&(lane->holder_hash), hash, __ATOMIC_RELAXED);
+        return;
+    }
+
+    uint64_t holder = __atomic_load_n(&(lane->holder_hash), __ATOMIC_RELAXED);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    bool served = false;
+    for (int spin = 0; spin < MONITOR_SPIN_LIMIT && !served; spin++) {
+        served = laneAdmits(lane, ticket, shared);
+    }
+
+    while (!served) {
+        uint32_t wake = __atomic_load_n(&(lane->wake), __ATOMIC_ACQUIRE);
+        __atomic_add_fetch(&(lane->sleeping), 1, __ATOMIC_SEQ_CST);
+        if (laneAdmits(lane, ticket, shared)) {
+            __atomic_sub_fetch(&(lane->sleeping), 1, __ATOMIC_RELAXED);
+            break;
+        }
+        if (!futexWait(&(lane->wake), wake, MONITOR_LIVENESS_CHECK_MS)) {
+            takeOverLane(monitor, index);
+        }
+        __atomic_sub_fetch(&(lane->sleeping), 1, __ATOMIC_RELAXED);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    __atomic_store_n(&(lane->holder_hash), hash, __ATOMIC_RELAXED);
+    recordLockWait(monitor, index, holder != hash,
+                   (end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec));
+}
+
+/**
+ * @brief Adds this process to the monitor's process queue.
  *
  * @param monitor Pointer to the monitor structure.
+ * @return The registration number of the queue entry.
  */
-void enterMonitor(Monitor *monitor) {
-    pthread_mutex_lock(&(monitor->mutex));
+static long registerProcess(Monitor *monitor) {
     pid_t pid = getpid();
-    monitor->process_queue.push(pid);
-    cout << "Process " << pid << " added to queue.\n";
-    while (monitor->process_queue.front() != pid) {
-        pthread_cond_wait(&(monitor->cond), &(monitor->mutex));
+    long registration = __atomic_fetch_add(&(monitor->next_ticket), 1, __ATOMIC_RELAXED);
+    QueuedProcess *entry = &(monitor->process_queue[registration % MAX_QUEUED_PROCESSES]);
+    entry->pid = pid;
+    __atomic_store_n(&(entry->ticket), registration, __ATOMIC_RELEASE);
+    if (monitor->output != NULL) {
+        emitEvent(monitor->output, "Process %d added to queue.\n", (int)pid);
+    } else {
+        cout << "Process " << pid << " added to queue.\n"; // Not part of a server reply
+    }
+    return registration;
+}
+
+/**
+ * @brief Removes this process's entry from the monitor's process queue.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param registration The number returned by registerProcess.
+ */
+static void unregisterProcess(Monitor *monitor, long registration) {
+    QueuedProcess *entry = &(monitor->process_queue[registration % MAX_QUEUED_PROCESSES]);
+    long expected = registration;
+    __atomic_compare_exchange_n(&(entry->ticket), &expected, -1L, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Hands a lane to its next ticket and wakes its waiters if any went to sleep.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param index The lane index.
+ * @param nextTicket The ticket to serve next.
+ */
+static void releaseLane(Monitor *monitor, int index, long nextTicket) {
+    AdmissionLane *lane = &(monitor->lanes[index]);
+    __atomic_store_n(&(lane->now_serving), nextTicket, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&(lane->wake), 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&(lane->sleeping), __ATOMIC_SEQ_CST)) {
+        futexWakeAll(&(lane->wake));
+    }
+}
+
+/**
+ * @brief Lets a lane's waiters re-check it after its last shared holder exits.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param index The lane index.
+ */
+static void releaseLaneShared(Monitor *monitor, int index) {
+    AdmissionLane *lane = &(monitor->lanes[index]);
+    if (__atomic_sub_fetch(&(lane->readers), 1, __ATOMIC_SEQ_CST) != 0) {
+        return;
+    }
+    __atomic_add_fetch(&(lane->wake), 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&(lane->sleeping), __ATOMIC_SEQ_CST)) {
+        futexWakeAll(&(lane->wake));
+    }
+}
+
+/**
+ * @brief Enters the monitor by adding the process to the queue.
+ *
+ * Each lane is a ticket lock in shared memory, and a transaction is admitted
+ * once every lane it touches serves its ticket. Transactions on unrelated
+ * accounts use different lanes and run in parallel, while transactions on
+ * the same account are admitted one at a time in ticket order.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account the transaction touches.
+ * @param otherAccountId A second account (TRANSFER recipient), or NULL.
+ */
+void enterMonitor(Monitor *monitor, const char *accountId, const char *otherAccountId) {
+    metricsBeginTransaction(monitor->metrics);
+    long queueStart = metricsStart(monitor->metrics);
+
+    MonitorTicket ticket;
+    if (assigned_ticket.count > 0) {
+        ticket = assigned_ticket;
+        assigned_ticket.count = 0;
+    } else {
+        reserveMonitorTicket(monitor, accountId, otherAccountId, &ticket);
+    }
+
+    long registration = registerProcess(monitor);
+
+    // Lanes are waited on in ascending order
+    uint64_t hash = hashAccountId(accountId);
+    uint64_t otherHash = (otherAccountId != NULL) ? hashAccountId(otherAccountId) : hash;
+    pid_t pid = monitor->process_queue[registration % MAX_QUEUED_PROCESSES].pid;
+    for (int i = 0; i < ticket.count; i++) {
+        bool first = (ticket.lanes[i] == (int)(hash & (uint64_t)(monitor->lock_stripes - 1)));
+        waitForLane(monitor, ticket.lanes[i], ticket.tickets[i], first ? hash : otherHash);
+        claimLane(&(monitor->lanes[ticket.lanes[i]]), pid, ticket.tickets[i], ticket.tickets[i] + 1);
+    }
+
+    if (monitor->snapshot != NULL) {
+        held_epoch = snapshotEnterWriter(monitor->snapshot);
+    }
+    held_ticket = ticket;
+    held_registration = registration;
+    metricsAddPhase(monitor->metrics, PHASE_QUEUE_WAIT, queueStart);
+}
+
+/**
+ * @brief Enters the monitor for a transaction that only reads one account (INQUIRY).
+ *
+ * The ticket is drawn and served in order like enterMonitor's, but the
+ * lane is handed to the next ticket as soon as this one is admitted, so
+ * consecutive readers of an account run in parallel. A later exclusive
+ * ticket waits until every reader admitted before it has exited.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The account the transaction reads.
+ */
+void enterMonitorShared(Monitor *monitor, const char *accountId) {
+    metricsBeginTransaction(monitor->metrics);
+    long queueStart = metricsStart(monitor->metrics);
+
+    MonitorTicket ticket;
+    if (assigned_ticket.count > 0) {
+        ticket = assigned_ticket;
+        assigned_ticket.count = 0;
+    } else {
+        reserveMonitorTicket(monitor, accountId, NULL, &ticket);
+    }
+
+    long registration = registerProcess(monitor);
+
+    int index = ticket.lanes[0];
+    waitForLane(monitor, index, ticket.tickets[0], hashAccountId(accountId), true);
+    __atomic_add_fetch(&(monitor->lanes[index].readers), 1, __ATOMIC_SEQ_CST);
+    releaseLane(monitor, index, ticket.tickets[0] + 1);
+
+    held_ticket = ticket;
+    held_registration = registration;
+    held_shared = true;
+    metricsAddPhase(monitor->metrics, PHASE_QUEUE_WAIT, queueStart);
+}
+
+/**
+ * @brief Finds this process's ticket on one of the lanes it holds.
+ *
+ * @param lane The lane index.
+ * @return The ticket, or -1 if the process does not hold the lane.
+ */
+long heldLaneTicket(int lane) {
+    for (int i = 0; i < held_ticket.count; i++) {
+        if (held_ticket.lanes[i] == lane) {
+            return held_ticket.tickets[i];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Hands one lane the process holds exclusively to its next ticket before the process exits the monitor.
+ *
+ * Used once the process has published a combined update for the lane's
+ * account (see monitorCombineDelta): every later ticket applies pending
+ * updates before touching the account, so the lane's order is kept.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param lane The lane index.
+ */
+void handOnLane(Monitor *monitor, int lane) {
+    for (int i = 0; i < held_ticket.count; i++) {
+        if (held_ticket.lanes[i] == lane) {
+            releaseLane(monitor, lane, held_ticket.tickets[i] + 1);
+            held_ticket.lanes[i] = -1;
+        }
     }
-    pthread_mutex_unlock(&(monitor->mutex));
 }
 
 /**
@@ -80,13 +543,101 @@ void enterMonitor(Monitor *monitor) {
  * @param monitor Pointer to the monitor structure.
  */
 void exitMonitor(Monitor *monitor) {
-    pthread_mutex_lock(&(monitor->mutex));
-    pid_t pid = getpid();
-    if (!monitor->process_queue.empty() && monitor->process_queue.front() == pid) {
-        monitor->process_queue.pop();
-        pthread_cond_broadcast(&(monitor->cond));
+    if (held_ticket.count == 0) {
+        return;
+    }
+
+    if (held_epoch != -1) {
+        snapshotExitWriter(monitor->snapshot, held_epoch);
+        held_epoch = -1;
+    }
+    unregisterProcess(monitor, held_registration);
+    if (held_shared) {
+        releaseLaneShared(monitor, held_ticket.lanes[0]); // The lane itself was handed on at entry
+    } else {
+        for (int i = 0; i < held_ticket.count; i++) {
+            if (held_ticket.lanes[i] >= 0) { // Not already handed on by handOnLane
+                releaseLane(monitor, held_ticket.lanes[i], held_ticket.tickets[i] + 1);
+            }
+        }
+    }
+
+    held_ticket.count = 0;
+    held_registration = -1;
+    held_shared = false;
+    if (checkpoint_due) {
+        monitorCheckpoint(monitor, false);
+    }
+}
+
+/**
+ * @brief Draws one ticket on every lane of a batch.
+ *
+ * Like reserveMonitorTicket, draws that span several lanes are serialized
+ * so every pair of callers is ordered the same way on all lanes they share.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param ticket The batch's lanes, in ascending order; receives one ticket per lane.
+ */
+void reserveBatchTicket(Monitor *monitor, BatchTicket *ticket) {
+    bool serialize = (ticket->count > 1);
+    if (serialize) {
+        lockSharedMutex(&(monitor->admission_mutex));
+    }
+    for (int i = 0; i < ticket->count; i++) {
+        ticket->first[i] = __atomic_fetch_add(&(monitor->lanes[ticket->lanes[i]].next_ticket), 1, __ATOMIC_RELAXED);
+        ticket->last[i] = ticket->first[i];
+    }
+    if (serialize) {
+        pthread_mutex_unlock(&(monitor->admission_mutex));
+    }
+}
+
+/**
+ * @brief Enters the monitor once for a whole batch.
+ *
+ * The batch is admitted once every lane it touches serves the first ticket
+ * of the batch's run on that lane; lanes are waited on in ascending order,
+ * as in enterMonitor.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param ticket The batch's lanes and ticket runs.
+ */
+void enterMonitorBatch(Monitor *monitor, const BatchTicket *ticket) {
+    metricsBeginTransaction(monitor->metrics);
+    long queueStart = metricsStart(monitor->metrics);
+
+    held_registration = registerProcess(monitor);
+    pid_t pid = monitor->process_queue[held_registration % MAX_QUEUED_PROCESSES].pid;
+    for (int i = 0; i < ticket->count; i++) {
+        waitForLane(monitor, ticket->lanes[i], ticket->first[i], hashAccountId(ticket->accounts[i]));
+        claimLane(&(monitor->lanes[ticket->lanes[i]]), pid, ticket->first[i], ticket->last[i] + 1);
+    }
+    if (monitor->snapshot != NULL) {
+        held_epoch = snapshotEnterWriter(monitor->snapshot);
+    }
+    metricsAddPhase(monitor->metrics, PHASE_QUEUE_WAIT, queueStart);
+}
+
+/**
+ * @brief Exits the monitor after a batch, handing each lane to the ticket after the batch's run.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param ticket The ticket passed to enterMonitorBatch.
+ */
+void exitMonitorBatch(Monitor *monitor, const BatchTicket *ticket) {
+    if (held_epoch != -1) {
+        snapshotExitWriter(monitor->snapshot, held_epoch);
+        held_epoch = -1;
+    }
+    unregisterProcess(monitor, held_registration);
+    for (int i = 0; i < ticket->count; i++) {
+        releaseLane(monitor, ticket->lanes[i], ticket->last[i] + 1);
+    }
+    held_registration = -1;
+    if (checkpoint_due) {
+        monitorCheckpoint(monitor, false);
     }
-    pthread_mutex_unlock(&(monitor->mutex));
 }
 
 /**
@@ -95,13 +646,14 @@ void exitMonitor(Monitor *monitor) {
  * @param monitor Pointer to the monitor structure.
  */
 void displayProcessQueue(Monitor *monitor) {
-    pthread_mutex_lock(&(monitor->mutex));
-    queue<pid_t> tempQueue = monitor->process_queue;
+    long last = __atomic_load_n(&(monitor->next_ticket), __ATOMIC_ACQUIRE);
+    long first = last > MAX_QUEUED_PROCESSES ? last - MAX_QUEUED_PROCESSES : 0;
     cout << "Processes in queue: ";
-    while (!tempQueue.empty()) {
-        cout << tempQueue.front() << " ";
-        tempQueue.pop();
+    for (long registration = first; registration < last; registration++) {
+        QueuedProcess &entry = monitor->process_queue[registration % MAX_QUEUED_PROCESSES];
+        if (__atomic_load_n(&(entry.ticket), __ATOMIC_ACQUIRE) == registration) {
+            cout << entry.pid << " ";
+        }
     }
     cout << endl;
-    pthread_mutex_unlock(&(monitor->mutex));
 }
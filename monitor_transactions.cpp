@@ -9,6 +9,7 @@
 #include <iostream>
 #include <unistd.h>
 #include <string.h>
+#include <stdlib.h>
 
 using namespace std;
 
@@ -20,51 +21,51 @@ using namespace std;
  * @param name The name of the account holder.
  * @param initialBalance The initial balance for the account.
  */
-void createAccount(Monitor *monitor, const char *accountId, const char *name, double initialBalance) {
-    enterMonitor(monitor);
+void createAccount(Monitor *monitor, const char *accountId, const char *name, Money initialBalance) {
+    enterMonitor(monitor, accountId);
 
-    int accountIndex = getAccountMutexIndex(accountId);
-    pthread_mutex_lock(&(monitor->account_mutexes[accountIndex]));
+    int accountIndex = getAccountMutexIndex(monitor, accountId);
+    lockAccountMutex(monitor, accountIndex, accountId);
+
+    createAccountLocked(monitor, accountId, name, initialBalance);
+
+    unlockAccountMutex(monitor, accountIndex);
+    exitMonitor(monitor);
+}
+
+/**
+ * @brief Creates an account; the caller holds the account's lock stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account to create.
+ * @param name The name of the account holder.
+ * @param initialBalance The initial balance for the account.
+ */
+void createAccountLocked(Monitor *monitor, const char *accountId, const char *name, Money initialBalance) {
+    monitorSettleHotAccount(monitor, accountId);
 
     // Check if account already exists
-    double existingBalance = monitorGetBalance(monitor, accountId);
+    Money existingBalance = monitorGetBalance(monitor, accountId);
 
     if (existingBalance >= 0) {
         // Account already exists
-        printf("Error: Account %s already exists.\n", accountId);
-        monitorRecordTransaction(monitor, "CREATE", accountId, initialBalance, "FAILED", "Account already exists", NULL);
-        pthread_mutex_unlock(&(monitor->account_mutexes[accountIndex]));
-        exitMonitor(monitor);
+        emitEvent(monitor->output, "Error: Account %s already exists.\n", accountId);
+        monitorRecordTransaction(monitor, TXN_CREATE, accountId, initialBalance, TXN_FAILED, REASON_ACCOUNT_EXISTS, NULL);
         return;
     }
 
-    // Create account file
-    char filename[30];
-    snprintf(filename, sizeof(filename), "%s.txt", accountId);
-
-    int fd = open(filename, O_WRONLY | O_CREAT, 0666);
-
-    if (fd == -1) {
-        printf("Error creating account file: %s\n", filename);
-        monitorRecordTransaction(monitor, "CREATE", accountId, initialBalance, "FAILED", "File creation error", NULL);
-        pthread_mutex_unlock(&(monitor->account_mutexes[accountIndex]));
-        exitMonitor(monitor);
+    // Create account storage
+    if (monitorCreateAccount(monitor, accountId, name, initialBalance) == -1) {
+        monitorRecordTransaction(monitor, TXN_CREATE, accountId, initialBalance, TXN_FAILED, REASON_FILE_CREATION, NULL);
         return;
     }
 
-    // Write initial balance
-    char buffer[50];
-    snprintf(buffer, sizeof(buffer), "%.2lf", initialBalance);
-    write(fd, buffer, strlen(buffer));
-    close(fd);
-
-    printf("User %s created with account ID %s and initial balance %.2lf.\n", name, accountId, initialBalance);
+    char text[MONEY_TEXT_LENGTH];
+    formatMoney(initialBalance, text);
+    emitEvent(monitor->output, "User %s created with account ID %s and initial balance %s.\n", name, accountId, text);
 
     // Record success in shared memory
-    monitorRecordTransaction(monitor, "CREATE", accountId, initialBalance, "SUCCESS", "N/A", NULL);
-
-    pthread_mutex_unlock(&(monitor->account_mutexes[accountIndex]));
-    exitMonitor(monitor);
+    monitorRecordTransaction(monitor, TXN_CREATE, accountId, initialBalance, TXN_SUCCESS, REASON_NONE, NULL);
 }
 
 
@@ -76,27 +77,61 @@ void createAccount(Monitor *monitor, const char *accountId, const char *name, do
  * @param amount The amount to deposit.
  */
 
-void deposit(Monitor *monitor, const char *accountId, double amount) {
-    enterMonitor(monitor);
+void deposit(Monitor *monitor, const char *accountId, Money amount) {
+    enterMonitor(monitor, accountId);
+
+    // A hot account's deposits are combined: this one is queued for whoever
+    // locks the account's stripe next and the lane moves on meanwhile
+    HotAccount *hot = monitorHotAccount(monitor, accountId);
+    CombineRequest *request = (hot != NULL) ? claimCombineRequest(hot) : NULL;
+    if (request != NULL) {
+        monitorCombineDelta(monitor, hot, request, amount);
+        if (request->reason == REASON_ACCOUNT_NOT_FOUND) {
+            emitEvent(monitor->output, "Error: Account %s not found.\n", accountId);
+            monitorRecordTransaction(monitor, TXN_DEPOSIT, accountId, amount, TXN_FAILED, REASON_ACCOUNT_NOT_FOUND, NULL);
+        } else {
+            char text[MONEY_TEXT_LENGTH];
+            formatMoney(request->balance, text);
+            emitEvent(monitor->output, "Deposit successful. New balance: %s\n", text);
+            monitorRecordTransaction(monitor, TXN_DEPOSIT, accountId, amount, TXN_SUCCESS, REASON_NONE, NULL);
+        }
+        releaseCombineRequest(request);
+        exitMonitor(monitor);
+        return;
+    }
+
+    int accountIndex = getAccountMutexIndex(monitor, accountId);
+    lockAccountMutex(monitor, accountIndex, accountId);
+
+    depositLocked(monitor, accountId, amount);
 
-    int accountIndex = getAccountMutexIndex(accountId);
-    pthread_mutex_lock(&(monitor->account_mutexes[accountIndex]));
+    unlockAccountMutex(monitor, accountIndex);
+    exitMonitor(monitor);
+}
 
-    double balance = monitorGetBalance(monitor, accountId);
+/**
+ * @brief Deposits into an account; the caller holds the account's lock stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account to deposit into.
+ * @param amount The amount to deposit.
+ */
+void depositLocked(Monitor *monitor, const char *accountId, Money amount) {
+    monitorSettleHotAccount(monitor, accountId);
+    Money balance = monitorGetBalance(monitor, accountId);
 
     if (balance < 0) {
         // Account does not exist
-        printf("Error: Account %s not found.\n", accountId);
-        monitorRecordTransaction(monitor, "DEPOSIT", accountId, amount, "FAILED", "Account not found", NULL);
+        emitEvent(monitor->output, "Error: Account %s not found.\n", accountId);
+        monitorRecordTransaction(monitor, TXN_DEPOSIT, accountId, amount, TXN_FAILED, REASON_ACCOUNT_NOT_FOUND, NULL);
     } else {
         balance += amount;
         monitorUpdateBalance(monitor, accountId, balance);
-        printf("Deposit successful. New balance: %.2lf\n", balance);
-        monitorRecordTransaction(monitor, "DEPOSIT", accountId, amount, "SUCCESS", "N/A", NULL);
+        char text[MONEY_TEXT_LENGTH];
+        formatMoney(balance, text);
+        emitEvent(monitor->output, "Deposit successful. New balance: %s\n", text);
+        monitorRecordTransaction(monitor, TXN_DEPOSIT, accountId, amount, TXN_SUCCESS, REASON_NONE, NULL);
     }
-
-    pthread_mutex_unlock(&(monitor->account_mutexes[accountIndex]));
-    exitMonitor(monitor);
 }
 
 
@@ -108,31 +143,47 @@ void deposit(Monitor *monitor, const char *accountId, double amount) {
  * @param accountId The ID of the account to withdraw from.
  * @param amount The amount to withdraw.
  */
-void withdraw(Monitor *monitor, const char *accountId, double amount) {
-    enterMonitor(monitor);
+void withdraw(Monitor *monitor, const char *accountId, Money amount) {
+    enterMonitor(monitor, accountId);
+
+    int accountIndex = getAccountMutexIndex(monitor, accountId);
+    lockAccountMutex(monitor, accountIndex, accountId);
 
-    int accountIndex = getAccountMutexIndex(accountId);
-    pthread_mutex_lock(&(monitor->account_mutexes[accountIndex]));
+    withdrawLocked(monitor, accountId, amount);
+
+    unlockAccountMutex(monitor, accountIndex);
+    exitMonitor(monitor);
+}
 
-    double balance = monitorGetBalance(monitor, accountId);
+/**
+ * @brief Withdraws from an account; the caller holds the account's lock stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account to withdraw from.
+ * @param amount The amount to withdraw.
+ */
+void withdrawLocked(Monitor *monitor, const char *accountId, Money amount) {
+    monitorSettleHotAccount(monitor, accountId);
+    Money balance = monitorGetBalance(monitor, accountId);
 
     if (balance < 0) {
         // Account does not exist
-        printf("Error: Account %s not found.\n", accountId);
-        monitorRecordTransaction(monitor, "WITHDRAW", accountId, amount, "FAILED", "Account not found", NULL);
+        emitEvent(monitor->output, "Error: Account %s not found.\n", accountId);
+        monitorRecordTransaction(monitor, TXN_WITHDRAW, accountId, amount, TXN_FAILED, REASON_ACCOUNT_NOT_FOUND, NULL);
     } else if (amount > balance) {
         // Insufficient funds
-        printf("Insufficient funds in account %s. Current balance: %.2lf\n", accountId, balance);
-        monitorRecordTransaction(monitor, "WITHDRAW", accountId, amount, "FAILED", "Insufficient funds", NULL);
+        char text[MONEY_TEXT_LENGTH];
+        formatMoney(balance, text);
+        emitEvent(monitor->output, "Insufficient funds in account %s. Current balance: %s\n", accountId, text);
+        monitorRecordTransaction(monitor, TXN_WITHDRAW, accountId, amount, TXN_FAILED, REASON_INSUFFICIENT_FUNDS, NULL);
     } else {
         balance -= amount;
         monitorUpdateBalance(monitor, accountId, balance);
-        printf("Withdrawal successful. New balance: %.2lf\n", balance);
-        monitorRecordTransaction(monitor, "WITHDRAW", accountId, amount, "SUCCESS", "N/A", NULL);
+        char text[MONEY_TEXT_LENGTH];
+        formatMoney(balance, text);
+        emitEvent(monitor->output, "Withdrawal successful. New balance: %s\n", text);
+        monitorRecordTransaction(monitor, TXN_WITHDRAW, accountId, amount, TXN_SUCCESS, REASON_NONE, NULL);
     }
-
-    pthread_mutex_unlock(&(monitor->account_mutexes[accountIndex]));
-    exitMonitor(monitor);
 }
 
 
@@ -146,117 +197,439 @@ void withdraw(Monitor *monitor, const char *accountId, double amount) {
  * @param toAccountId The ID of the account to transfer to.
  */
 void inquiry(Monitor *monitor, const char *accountId) {
-    enterMonitor(monitor);
+    if (monitor->optimistic_reads) {
+        // Never waits for the lane: inquiryLocked reads the balance optimistically
+        metricsBeginTransaction(monitor->metrics);
+        inquiryLocked(monitor, accountId);
+        return;
+    }
 
-    int accountIndex = getAccountMutexIndex(accountId);
-    pthread_mutex_lock(&(monitor->account_mutexes[accountIndex]));
+    // Holding the lane shared is enough: it keeps out every update of the
+    // account, and a write-back only copies the cached balance to its file
+    enterMonitorShared(monitor, accountId);
+    inquiryLocked(monitor, accountId);
+    exitMonitor(monitor);
+}
 
-    double balance = monitorGetBalance(monitor, accountId);
+/**
+ * @brief Prints an account's balance; the caller holds the account's lane (shared or exclusive).
+ *
+ * With optimistic reads the caller need not hold the lane.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account to inquire about.
+ */
+void inquiryLocked(Monitor *monitor, const char *accountId) {
+    Money balance;
+    if (monitor->optimistic_reads) {
+        balance = monitorReadBalanceOptimistic(monitor, accountId);
+    } else {
+        monitorSettleHotAccount(monitor, accountId);
+        balance = monitorGetBalance(monitor, accountId);
+    }
 
     if (balance < 0) {
         // Account does not exist
-        printf("Error: Account %s not found.\n", accountId);
-        monitorRecordTransaction(monitor, "INQUIRY", accountId, 0.0, "FAILED", "Account not found", NULL);
+        emitEvent(monitor->output, "Error: Account %s not found.\n", accountId);
+        monitorRecordTransaction(monitor, TXN_INQUIRY, accountId, 0, TXN_FAILED, REASON_ACCOUNT_NOT_FOUND, NULL);
     } else {
-        printf("Account %s balance: %.2lf\n", accountId, balance);
-        monitorRecordTransaction(monitor, "INQUIRY", accountId, 0.0, "SUCCESS", "N/A", NULL);
+        char text[MONEY_TEXT_LENGTH];
+        formatMoney(balance, text);
+        emitEvent(monitor->output, "Account %s balance: %s\n", accountId, text);
+        monitorRecordTransaction(monitor, TXN_INQUIRY, accountId, 0, TXN_SUCCESS, REASON_NONE, NULL);
     }
+}
 
-    pthread_mutex_unlock(&(monitor->account_mutexes[accountIndex]));
+/**
+ * @brief Prints an account's recent transactions.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account.
+ * @param query Which of the account's transactions to print.
+ */
+void statement(Monitor *monitor, const char *accountId, const StatementQuery *query) {
+    // Exclusive, unlike an inquiry: shared holders admitted before it (an
+    // INQUIRY on the same account) may not have recorded themselves yet, and
+    // the statement must list them
+    enterMonitor(monitor, accountId);
+    statementLocked(monitor, accountId, query);
     exitMonitor(monitor);
 }
 
+/**
+ * @brief Prints an account's transactions from the log; the caller holds the account's lane.
+ *
+ * The records are found through the log's per-account history, so this
+ * does not scan the log. A statement is not itself recorded.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account.
+ * @param query Which of the account's transactions to print.
+ */
+void statementLocked(Monitor *monitor, const char *accountId, const StatementQuery *query) {
+    monitorSettleHotAccount(monitor, accountId); // Combined deposits admitted earlier must be recorded first
+    TransactionRecord *records = new TransactionRecord[query->limit];
+    long count = accountHistory(monitor->shm_ptr, accountId, query, records);
+    printStatement(monitor, accountId, records, count);
+    delete[] records;
+}
+
+/**
+ * @brief Prints a statement from an account's records, given newest first, oldest first.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account.
+ * @param records The account's records, newest first.
+ * @param count Number of records.
+ */
+void printStatement(Monitor *monitor, const char *accountId, const TransactionRecord *records, long count) {
+    Money balance = monitorGetBalance(monitor, accountId);
+    if (balance < 0 && count == 0) {
+        emitEvent(monitor->output, "Error: Account %s not found.\n", accountId);
+        return;
+    }
+
+    if (balance < 0) {
+        emitEvent(monitor->output, "Statement for account %s (closed): %ld transactions\n", accountId, count);
+    } else {
+        char text[MONEY_TEXT_LENGTH];
+        formatMoney(balance, text);
+        emitEvent(monitor->output, "Statement for account %s (balance %s): %ld transactions\n", accountId, text, count);
+    }
+    for (long i = count - 1; i >= 0; i--) {
+        const TransactionRecord *record = &(records[i]);
+        char timestamp[TIMESTAMP_LENGTH];
+        char amount[MONEY_TEXT_LENGTH];
+        formatTimestamp(record->timestamp_ns, timestamp);
+        formatMoney(record->amount, amount);
+
+        char counterpart[ACCOUNT_ID_LENGTH + 8] = "";
+        if (record->transaction_type == TXN_TRANSFER) {
+            bool outgoing = strncmp(record->account_id, accountId, ACCOUNT_ID_LENGTH) == 0;
+            snprintf(counterpart, sizeof(counterpart), outgoing ? " to %.*s" : " from %.*s", ACCOUNT_ID_LENGTH,
+                     outgoing ? record->recipient_account_id : record->account_id);
+        }
+        if (record->status == TXN_SUCCESS) {
+            emitEvent(monitor->output, "  %s %s %s%s %s\n", timestamp, transactionTypeName(record->transaction_type),
+                      amount, counterpart, transactionStatusName(record->status));
+        } else {
+            emitEvent(monitor->output, "  %s %s %s%s %s (%s)\n", timestamp, transactionTypeName(record->transaction_type),
+                      amount, counterpart, transactionStatusName(record->status), transactionReasonName(record->reason));
+        }
+    }
+}
+
+// Accounts gathered for a report
+struct ReportAccounts {
+    Monitor *monitor;
+    char (*ids)[ACCOUNT_ID_LENGTH];
+    Money *balances;
+    long count;
+    long capacity;
+};
+
+/**
+ * @brief Adds an account and its balance to a report.
+ */
+static void addReportAccount(ReportAccounts *accounts, const char *accountId, Money balance) {
+    if (accounts->count == accounts->capacity) {
+        long capacity = (accounts->capacity > 0) ? accounts->capacity * 2 : 1024;
+        char (*ids)[ACCOUNT_ID_LENGTH] = new char[capacity][ACCOUNT_ID_LENGTH];
+        Money *balances = new Money[capacity];
+        memcpy(ids, accounts->ids, accounts->count * sizeof(ids[0]));
+        memcpy(balances, accounts->balances, accounts->count * sizeof(Money));
+        delete[] accounts->ids;
+        delete[] accounts->balances;
+        accounts->ids = ids;
+        accounts->balances = balances;
+        accounts->capacity = capacity;
+    }
+    strncpy(accounts->ids[accounts->count], accountId, ACCOUNT_ID_LENGTH - 1);
+    accounts->ids[accounts->count][ACCOUNT_ID_LENGTH - 1] = '\0';
+    accounts->balances[accounts->count] = balance;
+    accounts->count++;
+}
+
+/**
+ * @brief Visitor that reads each listed account's balance as of the report's cut.
+ */
+static void visitReportAccount(const char *accountId, void *context) {
+    ReportAccounts *accounts = (ReportAccounts *)context;
+    Money balance = monitorSnapshotBalance(accounts->monitor, accountId);
+    if (balance >= 0) {
+        addReportAccount(accounts, accountId, balance);
+    }
+}
+
+// Accounts whose indices compareReportAccounts is sorting
+static const ReportAccounts *sorting_accounts = NULL;
+
+/**
+ * @brief Orders report accounts by ID (qsort helper over indices into sorting_accounts).
+ */
+static int compareReportAccounts(const void *a, const void *b) {
+    return strncmp(sorting_accounts->ids[*(const long *)a], sorting_accounts->ids[*(const long *)b], ACCOUNT_ID_LENGTH);
+}
+
+/**
+ * @brief Prints every account's balance and their total as of one point in time.
+ *
+ * Writers keep running while the report reads: it takes a cut (see
+ * beginSnapshot), and the accounts changed after the cut are reported with
+ * the balance they had at it. Accounts closed after the cut are taken from
+ * their before-images, as they are no longer listed. A report is not
+ * recorded in the log and must not be run while this process is in the
+ * monitor.
+ *
+ * @param monitor Pointer to the monitor structure.
+ */
+void report(Monitor *monitor) {
+    if (monitor->snapshot == NULL) {
+        emitEvent(monitor->output, "Error: Reports are not available in this mode.\n");
+        return;
+    }
+
+    ReportAccounts accounts = {monitor, NULL, NULL, 0, 0};
+    beginSnapshot(monitor->snapshot);
+    monitorForEachAccount(monitor, visitReportAccount, &accounts);
+
+    long listed = accounts.count;
+    long *order = new long[listed > 0 ? listed : 1];
+    for (long i = 0; i < listed; i++) {
+        order[i] = i;
+    }
+    sorting_accounts = &accounts;
+    qsort(order, listed, sizeof(long), compareReportAccounts);
+
+    AccountSnapshot *snapshot = monitor->snapshot;
+    for (uint64_t i = 0; i < snapshot->capacity; i++) {
+        SnapshotEntry *entry = &(snapshot->entries[i]);
+        if (__atomic_load_n(&(entry->state), __ATOMIC_ACQUIRE) != SNAPSHOT_READY || entry->balance < 0) {
+            continue;
+        }
+        // Closed after the cut, unless the listing still found the account
+        long low = 0, high = listed;
+        while (low < high) {
+            long middle = (low + high) / 2;
+            if (strncmp(accounts.ids[order[middle]], entry->id, ACCOUNT_ID_LENGTH) < 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low == listed || strncmp(accounts.ids[order[low]], entry->id, ACCOUNT_ID_LENGTH) != 0) {
+            addReportAccount(&accounts, entry->id, entry->balance);
+        }
+    }
+    endSnapshot(snapshot);
+
+    delete[] order;
+    order = new long[accounts.count > 0 ? accounts.count : 1];
+    for (long i = 0; i < accounts.count; i++) {
+        order[i] = i;
+    }
+    sorting_accounts = &accounts;
+    qsort(order, accounts.count, sizeof(long), compareReportAccounts);
+
+    Money total = 0;
+    for (long i = 0; i < accounts.count; i++) {
+        total += accounts.balances[i];
+    }
+    char text[MONEY_TEXT_LENGTH];
+    formatMoney(total, text);
+    emitEvent(monitor->output, "Report: %ld accounts, total %s\n", accounts.count, text);
+    for (long i = 0; i < accounts.count; i++) {
+        formatMoney(accounts.balances[order[i]], text);
+        emitEvent(monitor->output, "  %s %s\n", accounts.ids[order[i]], text);
+    }
+
+    delete[] order;
+    delete[] accounts.ids;
+    delete[] accounts.balances;
+}
+
+/**
+ * @brief Transfers to a hot account, combining the credit; the caller holds both lanes and the sender's stripe.
+ *
+ * The recipient's stripe is not locked: it is only checked to exist, which
+ * nothing but a later ticket on its lane could change.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param fromAccountId The ID of the account to transfer from.
+ * @param amount The amount to transfer.
+ * @param toAccountId The ID of the hot account to transfer to.
+ * @param hot The recipient's hot account entry.
+ * @param request A request claimed for the credit; freed before returning.
+ */
+static void transferCombined(Monitor *monitor, const char *fromAccountId, Money amount, const char *toAccountId,
+                             HotAccount *hot, CombineRequest *request) {
+    monitorSettleHotAccount(monitor, fromAccountId);
+    Money fromBalance = monitorGetBalance(monitor, fromAccountId);
+    char amountText[MONEY_TEXT_LENGTH];
+    formatMoney(amount, amountText);
+
+    if (fromBalance < 0) {
+        releaseCombineRequest(request);
+        emitEvent(monitor->output, "Error: From account %s not found.\n", fromAccountId);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_FAILED, REASON_FROM_NOT_FOUND, toAccountId);
+    } else if (monitorReadBalanceOptimistic(monitor, toAccountId) < 0) {
+        releaseCombineRequest(request);
+        emitEvent(monitor->output, "Error: To account %s not found.\n", toAccountId);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_FAILED, REASON_TO_NOT_FOUND, toAccountId);
+    } else if (amount > fromBalance) {
+        releaseCombineRequest(request);
+        emitEvent(monitor->output, "Insufficient funds in account %s to transfer %s\n", fromAccountId, amountText);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_FAILED, REASON_INSUFFICIENT_FUNDS, toAccountId);
+    } else {
+        fromBalance -= amount;
+        monitorUpdateBalance(monitor, fromAccountId, fromBalance);
+        monitorCombineDelta(monitor, hot, request, amount);
+
+        char fromText[MONEY_TEXT_LENGTH], toText[MONEY_TEXT_LENGTH];
+        formatMoney(fromBalance, fromText);
+        formatMoney(request->balance, toText);
+        emitEvent(monitor->output, "Transfer successful. %s transferred from %s to %s\n", amountText, fromAccountId, toAccountId);
+        emitEvent(monitor->output, "New balance for %s: %s\n", fromAccountId, fromText);
+        emitEvent(monitor->output, "New balance for %s: %s\n", toAccountId, toText);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_SUCCESS, REASON_NONE, toAccountId);
+        releaseCombineRequest(request);
+    }
+}
+
 /**
  * @brief Closes the specified account if its balance is zero.
  *
  * @param monitor Pointer to the monitor structure.
  * @param accountId The ID of the account to close.
  */
-void transfer(Monitor *monitor, const char *fromAccountId, double amount, const char *toAccountId) {
-    enterMonitor(monitor);
-
-    int fromIndex = getAccountMutexIndex(fromAccountId);
-    int toIndex = getAccountMutexIndex(toAccountId);
+void transfer(Monitor *monitor, const char *fromAccountId, Money amount, const char *toAccountId) {
+    enterMonitor(monitor, fromAccountId, toAccountId);
+
+    int fromIndex = getAccountMutexIndex(monitor, fromAccountId);
+    int toIndex = getAccountMutexIndex(monitor, toAccountId);
+
+    // The credit to a hot account is combined like a deposit. Not with the
+    // WAL, which must log both balances of a transfer in one record
+    HotAccount *hot = (monitor->wal == NULL && fromIndex != toIndex) ? monitorHotAccount(monitor, toAccountId) : NULL;
+    CombineRequest *request = (hot != NULL) ? claimCombineRequest(hot) : NULL;
+    if (request != NULL) {
+        lockAccountMutex(monitor, fromIndex, fromAccountId);
+        transferCombined(monitor, fromAccountId, amount, toAccountId, hot, request);
+        unlockAccountMutex(monitor, fromIndex);
+        exitMonitor(monitor);
+        return;
+    }
 
     // Ensure locks are always acquired in the same order
     if (fromIndex < toIndex) {
-        pthread_mutex_lock(&(monitor->account_mutexes[fromIndex]));
-        pthread_mutex_lock(&(monitor->account_mutexes[toIndex]));
+        lockAccountMutex(monitor, fromIndex, fromAccountId);
+        lockAccountMutex(monitor, toIndex, toAccountId);
     } else if (fromIndex > toIndex) {
-        pthread_mutex_lock(&(monitor->account_mutexes[toIndex]));
-        pthread_mutex_lock(&(monitor->account_mutexes[fromIndex]));
+        lockAccountMutex(monitor, toIndex, toAccountId);
+        lockAccountMutex(monitor, fromIndex, fromAccountId);
     } else {
         // Same account
-        pthread_mutex_lock(&(monitor->account_mutexes[fromIndex]));
+        lockAccountMutex(monitor, fromIndex, fromAccountId);
     }
 
+    transferLocked(monitor, fromAccountId, amount, toAccountId);
+
+    // Release locks in reverse order
+    unlockAccountMutex(monitor, fromIndex);
+    if (fromIndex != toIndex) {
+        unlockAccountMutex(monitor, toIndex);
+    }
+
+    exitMonitor(monitor);
+}
+
+/**
+ * @brief Transfers between two accounts; the caller holds both accounts' lock stripes.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param fromAccountId The ID of the account to transfer from.
+ * @param amount The amount to transfer.
+ * @param toAccountId The ID of the account to transfer to.
+ */
+void transferLocked(Monitor *monitor, const char *fromAccountId, Money amount, const char *toAccountId) {
+    // Combined deposits admitted earlier are recorded before this transfer
+    monitorSettleHotAccount(monitor, fromAccountId);
+    monitorSettleHotAccount(monitor, toAccountId);
+
     // Perform transfer operation
-    double fromBalance = monitorGetBalance(monitor, fromAccountId);
-    double toBalance = monitorGetBalance(monitor, toAccountId);
+    Money fromBalance = monitorGetBalance(monitor, fromAccountId);
+    Money toBalance = monitorGetBalance(monitor, toAccountId);
+    char amountText[MONEY_TEXT_LENGTH];
+    formatMoney(amount, amountText);
 
     if (fromBalance < 0) {
-        printf("Error: From account %s not found.\n", fromAccountId);
-        monitorRecordTransaction(monitor, "TRANSFER", fromAccountId, amount, "FAILED", "From account not found", toAccountId);
+        emitEvent(monitor->output, "Error: From account %s not found.\n", fromAccountId);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_FAILED, REASON_FROM_NOT_FOUND, toAccountId);
     } else if (toBalance < 0) {
-        printf("Error: To account %s not found.\n", toAccountId);
-        monitorRecordTransaction(monitor, "TRANSFER", fromAccountId, amount, "FAILED", "To account not found", toAccountId);
+        emitEvent(monitor->output, "Error: To account %s not found.\n", toAccountId);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_FAILED, REASON_TO_NOT_FOUND, toAccountId);
     } else if (amount > fromBalance) {
-        printf("Insufficient funds in account %s to transfer %.2lf\n", fromAccountId, amount);
-        monitorRecordTransaction(monitor, "TRANSFER", fromAccountId, amount, "FAILED", "Insufficient funds", toAccountId);
+        emitEvent(monitor->output, "Insufficient funds in account %s to transfer %s\n", fromAccountId, amountText);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_FAILED, REASON_INSUFFICIENT_FUNDS, toAccountId);
     } else {
         fromBalance -= amount;
         toBalance += amount;
 
-        monitorUpdateBalance(monitor, fromAccountId, fromBalance);
-        monitorUpdateBalance(monitor, toAccountId, toBalance);
+        // Both balances go into one redo record, so a crash cannot apply only one of them
+        monitorUpdateBalances(monitor, fromAccountId, fromBalance, toAccountId, toBalance);
 
-        printf("Transfer successful. %.2lf transferred from %s to %s\n", amount, fromAccountId, toAccountId);
-        printf("New balance for %s: %.2lf\n", fromAccountId, fromBalance);
-        printf("New balance for %s: %.2lf\n", toAccountId, toBalance);
+        char fromText[MONEY_TEXT_LENGTH], toText[MONEY_TEXT_LENGTH];
+        formatMoney(fromBalance, fromText);
+        formatMoney(toBalance, toText);
+        emitEvent(monitor->output, "Transfer successful. %s transferred from %s to %s\n", amountText, fromAccountId, toAccountId);
+        emitEvent(monitor->output, "New balance for %s: %s\n", fromAccountId, fromText);
+        emitEvent(monitor->output, "New balance for %s: %s\n", toAccountId, toText);
 
         // Record success in shared memory
-        monitorRecordTransaction(monitor, "TRANSFER", fromAccountId, amount, "SUCCESS", "N/A", toAccountId);
+        monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount, TXN_SUCCESS, REASON_NONE, toAccountId);
     }
-
-    // Release locks in reverse order
-    pthread_mutex_unlock(&(monitor->account_mutexes[fromIndex]));
-    if (fromIndex != toIndex) {
-        pthread_mutex_unlock(&(monitor->account_mutexes[toIndex]));
-    }
-
-    exitMonitor(monitor);
 }
 
 void closeAccount(Monitor *monitor, const char *accountId) {
-    enterMonitor(monitor);
+    enterMonitor(monitor, accountId);
+
+    int accountIndex = getAccountMutexIndex(monitor, accountId);
+    lockAccountMutex(monitor, accountIndex, accountId);
 
-    int accountIndex = getAccountMutexIndex(accountId);
-    pthread_mutex_lock(&(monitor->account_mutexes[accountIndex]));
+    closeAccountLocked(monitor, accountId);
 
-    double balance = monitorGetBalance(monitor, accountId);
+    unlockAccountMutex(monitor, accountIndex);
+    exitMonitor(monitor);
+}
+
+/**
+ * @brief Closes an account if its balance is zero; the caller holds the account's lock stripe.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param accountId The ID of the account to close.
+ */
+void closeAccountLocked(Monitor *monitor, const char *accountId) {
+    monitorSettleHotAccount(monitor, accountId);
+    Money balance = monitorGetBalance(monitor, accountId);
 
     if (balance < 0) {
         // Account does not exist
-        printf("Error: Account %s not found.\n", accountId);
-        monitorRecordTransaction(monitor, "CLOSE", accountId, 0.0, "FAILED", "Account not found", NULL);
-    } else if (balance != 0.0) {
+        emitEvent(monitor->output, "Error: Account %s not found.\n", accountId);
+        monitorRecordTransaction(monitor, TXN_CLOSE, accountId, 0, TXN_FAILED, REASON_ACCOUNT_NOT_FOUND, NULL);
+    } else if (balance != 0) {
         // Account balance is not zero
-        printf("Cannot close account %s. Balance is not zero: %.2lf\n", accountId, balance);
-        monitorRecordTransaction(monitor, "CLOSE", accountId, 0.0, "FAILED", "Balance not zero", NULL);
+        char text[MONEY_TEXT_LENGTH];
+        formatMoney(balance, text);
+        emitEvent(monitor->output, "Cannot close account %s. Balance is not zero: %s\n", accountId, text);
+        monitorRecordTransaction(monitor, TXN_CLOSE, accountId, 0, TXN_FAILED, REASON_BALANCE_NOT_ZERO, NULL);
     } else {
-        // Delete the account file
-        char filename[30];
-        snprintf(filename, sizeof(filename), "%s.txt", accountId);
-
-        if (remove(filename) == 0) {
-            printf("Account %s closed successfully.\n", accountId);
-            monitorRecordTransaction(monitor, "CLOSE", accountId, 0.0, "SUCCESS", "N/A", NULL);
+        // Delete the account storage
+        if (monitorDeleteAccount(monitor, accountId) == 0) {
+            emitEvent(monitor->output, "Account %s closed successfully.\n", accountId);
+            monitorRecordTransaction(monitor, TXN_CLOSE, accountId, 0, TXN_SUCCESS, REASON_NONE, NULL);
         } else {
-            printf("Error closing account %s.\n", accountId);
-            monitorRecordTransaction(monitor, "CLOSE", accountId, 0.0, "FAILED", "Error deleting file", NULL);
+            emitEvent(monitor->output, "Error closing account %s.\n", accountId);
+            monitorRecordTransaction(monitor, TXN_CLOSE, accountId, 0, TXN_FAILED, REASON_DELETE_ERROR, NULL);
         }
     }
-
-    pthread_mutex_unlock(&(monitor->account_mutexes[accountIndex]));
-    exitMonitor(monitor);
 }
@@ -0,0 +1,304 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "server.h"
+#include "worker_pool.h"
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+/**
+ * @brief Set by SIGINT or SIGTERM; the server and its workers stop once it is set.
+ */
+static volatile sig_atomic_t server_stopping = 0;
+
+/**
+ * @brief Signal handler that asks the server to stop.
+ */
+static void stopServer(int) {
+    server_stopping = 1;
+}
+
+// A client connection served by a worker process
+struct ServerConnection {
+    int fd;
+    size_t buffered;                 // Bytes of an unfinished request line kept from earlier reads
+    char input[SERVER_BUFFER_SIZE];
+};
+
+// Where a worker's transaction messages are collected instead of being printed
+struct ReplyCapture {
+    FILE *stream;    // Installed as stdout
+    char *text;      // Written so far (owned by the stream)
+    size_t length;
+};
+
+/**
+ * @brief Runs one request line and appends its reply line.
+ *
+ * The reply is what the batch driver prints for the same line ("Deposit
+ * successful. New balance: 12.00", "Error: Account A1 not found.", ...),
+ * joined into one line, or "Error: <reason>" if the line does not parse.
+ * Blank lines get no reply, as they are skipped in an input file.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param capture The worker's captured stdout.
+ * @param line The request, without its newline.
+ * @param replies Receives the reply line.
+ */
+static void serveRequest(Monitor *monitor, ReplyCapture *capture, string_view line, string *replies) {
+    Transaction transaction;
+    string_view command;
+    ParseStatus status = parseTransaction(line, &transaction, &command);
+    if (status == PARSE_BLANK) {
+        return;
+    }
+    if (status == PARSE_UNKNOWN_COMMAND) {
+        replies->append("Error: Unknown command: ").append(command).push_back('\n');
+        return;
+    }
+    if (status != PARSE_OK) {
+        replies->append("Error: ").append(parseStatusMessage(status)).push_back('\n');
+        return;
+    }
+
+    fseeko(capture->stream, 0, SEEK_SET);
+    executeTransaction(monitor, &transaction);
+    fflush(capture->stream);
+
+    size_t length = capture->length;
+    while (length > 0 && capture->text[length - 1] == '\n') {
+        length--;
+    }
+    if (length == 0) {
+        replies->append("OK\n");
+        return;
+    }
+    size_t start = replies->size();
+    replies->append(capture->text, length);
+    replace(replies->begin() + start, replies->end(), '\n', ' ');
+    replies->push_back('\n');
+}
+
+/**
+ * @brief Runs every complete request line read from a connection and sends the replies.
+ *
+ * All the lines of one read are answered with a single write, so a client
+ * that pipelines requests pays one round of system calls per read rather
+ * than per request.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param capture The worker's captured stdout.
+ * @param connection The connection, with newly read bytes in its buffer.
+ * @param atEnd Whether the client has finished sending (an unterminated last line is still served).
+ * @return false if the replies could not be sent.
+ */
+static bool serveConnection(Monitor *monitor, ReplyCapture *capture, ServerConnection *connection, bool atEnd) {
+    string replies;
+    size_t start = 0;
+    for (size_t i = 0; i < connection->buffered; i++) {
+        if (connection->input[i] == '\n') {
+            serveRequest(monitor, capture, string_view(connection->input + start, i - start), &replies);
+            start = i + 1;
+        }
+    }
+    if (atEnd && start < connection->buffered) {
+        serveRequest(monitor, capture, string_view(connection->input + start, connection->buffered - start), &replies);
+        start = connection->buffered;
+    }
+
+    connection->buffered -= start;
+    memmove(connection->input, connection->input + start, connection->buffered);
+    if (connection->buffered == sizeof(connection->input)) {
+        replies.append("Error: Request line too long\n");
+        connection->buffered = 0;
+    }
+    return replies.empty() || writeFully(connection->fd, replies.data(), replies.size()) == 0;
+}
+
+/**
+ * @brief Main loop of a server worker: accepts connections and serves their requests until stopped.
+ *
+ * Every worker polls the shared listening socket and its own connections;
+ * a connection stays with the worker that accepted it, so its requests are
+ * run one after another in the order they were sent.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param listenFd The listening socket (non-blocking).
+ */
+static void serverWorkerLoop(Monitor *monitor, int listenFd) {
+    ReplyCapture capture;
+    capture.text = NULL;
+    capture.length = 0;
+    capture.stream = open_memstream(&(capture.text), &(capture.length));
+    if (capture.stream == NULL) {
+        perror("Reply buffer");
+        return;
+    }
+    // Transaction messages become replies; the queue messages still go to the server's output
+    cout.flush();
+    stdout = capture.stream;
+
+    pollfd fds[1 + SERVER_MAX_CONNECTIONS];
+    ServerConnection *connections[1 + SERVER_MAX_CONNECTIONS];
+    int count = 1;
+    fds[0].fd = listenFd;
+    fds[0].events = POLLIN;
+
+    while (!server_stopping) {
+        if (poll(fds, count, -1) == -1) {
+            continue; // Interrupted, possibly by the stop signal
+        }
+
+        for (int i = count - 1; i >= 1; i--) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            ServerConnection *connection = connections[i];
+            ssize_t bytesRead = read(connection->fd, connection->input + connection->buffered,
+                                     sizeof(connection->input) - connection->buffered);
+            if (bytesRead == -1 && errno == EINTR) {
+                continue;
+            }
+            bool open = (bytesRead > 0);
+            connection->buffered += (bytesRead > 0) ? bytesRead : 0;
+            if (!serveConnection(monitor, &capture, connection, !open) || !open) {
+                close(connection->fd);
+                free(connection);
+                count--;
+                fds[i] = fds[count];
+                connections[i] = connections[count];
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+            if (fd == -1) {
+                continue; // Another worker took it
+            }
+            ServerConnection *connection = (count < 1 + SERVER_MAX_CONNECTIONS)
+                                               ? (ServerConnection *)malloc(sizeof(ServerConnection)) : NULL;
+            if (connection == NULL) {
+                close(fd);
+                continue;
+            }
+            connection->fd = fd;
+            connection->buffered = 0;
+            fds[count].fd = fd;
+            fds[count].events = POLLIN;
+            connections[count] = connection;
+            count++;
+        }
+    }
+
+    for (int i = 1; i < count; i++) {
+        close(connections[i]->fd);
+        free(connections[i]);
+    }
+    fclose(capture.stream);
+    free(capture.text);
+}
+
+/**
+ * @brief Serves transactions over a Unix domain socket until SIGINT or SIGTERM.
+ *
+ * Clients send transactions in the input file syntax, one per line, and
+ * may pipeline any number of them; each gets one reply line, in order (see
+ * serveRequest). The monitor, account cache and transaction log stay
+ * resident between requests. workerCount pre-forked worker processes
+ * share the listening socket and serve up to SERVER_MAX_CONNECTIONS
+ * connections each. On return every worker has exited, so the caller
+ * can write the cache back and dump the log as after a batch run.
+ *
+ * @param monitor Pointer to the monitor structure (must be in shared memory).
+ * @param socketPath Path of the socket; an existing file there is replaced.
+ * @param workerCount The number of worker processes to fork.
+ * @return 0 after a clean shutdown, or 1 if the socket or the workers could not be set up.
+ */
+int runServer(Monitor *monitor, const char *socketPath, int workerCount) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        cerr << "Error: Socket path too long: " << socketPath << endl;
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (listenFd == -1) {
+        perror("Server socket");
+        return 1;
+    }
+    unlink(socketPath);
+    if (bind(listenFd, (sockaddr *)&address, sizeof(address)) == -1 || listen(listenFd, SOMAXCONN) == -1) {
+        perror("Server socket");
+        close(listenFd);
+        return 1;
+    }
+
+    // Block the stop signals until the parent waits for them, so none is missed
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stopServer;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN); // A client that disconnects early only loses its replies
+    sigset_t stopSignals, previousMask;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &stopSignals, &previousMask);
+
+    cout.flush();
+    fflush(stdout);
+
+    pid_t workers[MAX_WORKERS];
+    int started = 0;
+    for (int i = 0; i < workerCount; i++) {
+        pid_t pid = fork();
+        if (pid == 0) { // Worker process
+            sigprocmask(SIG_SETMASK, &previousMask, NULL);
+            serverWorkerLoop(monitor, listenFd);
+            exit(0);
+        } else if (pid > 0) {
+            workers[started++] = pid;
+        } else {
+            perror("Fork failed");
+            break;
+        }
+    }
+
+    if (started > 0) {
+        cerr << "Serving on " << socketPath << " with " << started << " workers" << endl;
+        while (!server_stopping) {
+            sigsuspend(&previousMask);
+        }
+        for (int i = 0; i < started; i++) {
+            kill(workers[i], SIGTERM);
+        }
+        for (int i = 0; i < started; i++) {
+            waitpid(workers[i], NULL, 0);
+        }
+    }
+
+    sigprocmask(SIG_SETMASK, &previousMask, NULL);
+    close(listenFd);
+    unlink(socketPath);
+    return (started > 0) ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "monitor.h"
+
+#define DEFAULT_SERVER_SOCKET "bank.sock"
+#define DEFAULT_SERVER_WORKERS 4
+#define SERVER_MAX_CONNECTIONS 256   // Connections one worker process serves at once
+#define SERVER_BUFFER_SIZE 65536     // Bytes of requests read from a connection at a time
+
+int runServer(Monitor *monitor, const char *socketPath, int workerCount);
+
+#endif // SERVER_H
@@ -0,0 +1,467 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "shard_engine.h"
+#include <iostream>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+#define SHARD_SPIN_LIMIT 64        // Empty or full checks before a waiting shard yields
+#define SHARD_YIELD_LIMIT 1000     // Yields before it starts sleeping between checks
+#define SHARD_SLEEP_NS 20000L
+
+/**
+ * @brief Returns the shard that owns an account.
+ *
+ * Uses the high half of the account hash, so the accounts of one shard still
+ * spread over every slot of the shard's cache and lock table.
+ */
+int shardOf(const char *accountId, int shards) {
+    return (int)((hashAccountId(accountId) >> 32) % (uint64_t)shards);
+}
+
+/**
+ * @brief Waits a little longer each time a queue is found empty or full.
+ *
+ * @param waits Checks made so far; reset to 0 once the wait is over.
+ */
+static void shardBackOff(long *waits) {
+    (*waits)++;
+    if (*waits < SHARD_SPIN_LIMIT) {
+        return;
+    }
+    if (*waits < SHARD_SPIN_LIMIT + SHARD_YIELD_LIMIT) {
+        sched_yield();
+        return;
+    }
+    timespec pause = {0, SHARD_SLEEP_NS};
+    nanosleep(&pause, NULL);
+}
+
+/**
+ * @brief Routes a transaction to a shard, waiting while its queue is full.
+ */
+static void pushShardJob(ShardQueue *queue, const Transaction *transaction) {
+    long tail = queue->tail;
+    long waits = 0;
+    while (tail - __atomic_load_n(&(queue->head), __ATOMIC_ACQUIRE) == SHARD_QUEUE_CAPACITY) {
+        shardBackOff(&waits);
+    }
+    queue->jobs[tail % SHARD_QUEUE_CAPACITY] = *transaction;
+    __atomic_store_n(&(queue->tail), tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Sends a transfer message to another shard.
+ */
+static void sendTransferMessage(PeerQueue *queue, const TransferMessage *message) {
+    long tail = queue->tail;
+    long waits = 0;
+    while (tail - __atomic_load_n(&(queue->head), __ATOMIC_ACQUIRE) == SHARD_PEER_CAPACITY) {
+        shardBackOff(&waits);
+    }
+    queue->messages[tail % SHARD_PEER_CAPACITY] = *message;
+    __atomic_store_n(&(queue->tail), tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Waits for the next transfer message from another shard.
+ */
+static void receiveTransferMessage(PeerQueue *queue, TransferMessage *message) {
+    long head = queue->head;
+    long waits = 0;
+    while (__atomic_load_n(&(queue->tail), __ATOMIC_ACQUIRE) == head) {
+        shardBackOff(&waits);
+    }
+    *message = queue->messages[head % SHARD_PEER_CAPACITY];
+    __atomic_store_n(&(queue->head), head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Debit side of a transfer to an account of another shard.
+ *
+ * Phase one sends the sender's state (missing, short of funds, or able to
+ * pay) to the recipient's shard and waits for the outcome; phase two debits
+ * the sender if the recipient was credited. The sender cannot change in
+ * between, since only this shard's worker touches it and it waits here.
+ * Prints and records what transferLocked does for the same accounts, then
+ * tells the recipient's shard the transfer is recorded.
+ *
+ * @param engine Pointer to the shard engine.
+ * @param shard This shard.
+ * @param monitor This shard's monitor.
+ * @param transaction The transfer.
+ * @param toShard The recipient's shard.
+ */
+static void transferOut(ShardEngine *engine, int shard, Monitor *monitor, const Transaction *transaction, int toShard) {
+    const char *fromAccountId = transaction->account_id;
+    const char *toAccountId = transaction->recipient_account_id;
+    Money amount = transaction->amount;
+    Money fromBalance = monitorGetBalance(monitor, fromAccountId);
+
+    TransferMessage request;
+    request.amount = amount;
+    request.balance = 0;
+    request.reason = (fromBalance < 0) ? REASON_FROM_NOT_FOUND
+                   : (amount > fromBalance) ? REASON_INSUFFICIENT_FUNDS : REASON_NONE;
+    sendTransferMessage(&(engine->peers[shard][toShard]), &request);
+    TransferMessage reply;
+    receiveTransferMessage(&(engine->peers[toShard][shard]), &reply);
+
+    char amountText[MONEY_TEXT_LENGTH];
+    formatMoney(amount, amountText);
+    if (reply.reason == REASON_FROM_NOT_FOUND) {
+        emitEvent(monitor->output, "Error: From account %s not found.\n", fromAccountId);
+    } else if (reply.reason == REASON_TO_NOT_FOUND) {
+        emitEvent(monitor->output, "Error: To account %s not found.\n", toAccountId);
+    } else if (reply.reason == REASON_INSUFFICIENT_FUNDS) {
+        emitEvent(monitor->output, "Insufficient funds in account %s to transfer %s\n", fromAccountId, amountText);
+    } else {
+        fromBalance -= amount;
+        monitorUpdateBalance(monitor, fromAccountId, fromBalance);
+
+        char fromText[MONEY_TEXT_LENGTH], toText[MONEY_TEXT_LENGTH];
+        formatMoney(fromBalance, fromText);
+        formatMoney(reply.balance, toText);
+        emitEvent(monitor->output, "Transfer successful. %s transferred from %s to %s\n", amountText, fromAccountId, toAccountId);
+        emitEvent(monitor->output, "New balance for %s: %s\n", fromAccountId, fromText);
+        emitEvent(monitor->output, "New balance for %s: %s\n", toAccountId, toText);
+    }
+    monitorRecordTransaction(monitor, TXN_TRANSFER, fromAccountId, amount,
+                             (reply.reason == REASON_NONE) ? TXN_SUCCESS : TXN_FAILED, reply.reason, toAccountId);
+    sendTransferMessage(&(engine->peers[shard][toShard]), &reply);
+}
+
+/**
+ * @brief Credit side of a transfer from an account of another shard.
+ *
+ * Waits for the debit side's request, credits the recipient if the sender
+ * can pay and the recipient exists, and replies with the outcome. The
+ * failure reasons are checked in transferLocked's order. Returns once the
+ * debit side has recorded the transfer in its log, so a statement this
+ * shard runs next finds it.
+ *
+ * @param engine Pointer to the shard engine.
+ * @param shard This shard.
+ * @param monitor This shard's monitor.
+ * @param transaction The transfer.
+ * @param fromShard The sender's shard.
+ */
+static void transferIn(ShardEngine *engine, int shard, Monitor *monitor, const Transaction *transaction, int fromShard) {
+    TransferMessage request;
+    receiveTransferMessage(&(engine->peers[fromShard][shard]), &request);
+
+    TransferMessage reply = request;
+    if (request.reason != REASON_FROM_NOT_FOUND) {
+        Money toBalance = monitorGetBalance(monitor, transaction->recipient_account_id);
+        if (toBalance < 0) {
+            reply.reason = REASON_TO_NOT_FOUND;
+        } else if (request.reason == REASON_NONE) {
+            toBalance += request.amount;
+            monitorUpdateBalance(monitor, transaction->recipient_account_id, toBalance);
+            reply.balance = toBalance;
+        }
+    }
+    sendTransferMessage(&(engine->peers[shard][fromShard]), &reply);
+    TransferMessage recorded;
+    receiveTransferMessage(&(engine->peers[fromShard][shard]), &recorded);
+}
+
+/**
+ * @brief Prints a statement of one of this shard's accounts.
+ *
+ * Transfers from other shards' accounts are recorded in the senders'
+ * logs, so the account's history is read from every shard's log and the
+ * newest records of all of them are kept.
+ *
+ * @param engine Pointer to the shard engine.
+ * @param monitor This shard's monitor.
+ * @param transaction The statement.
+ */
+static void shardStatement(ShardEngine *engine, Monitor *monitor, const Transaction *transaction) {
+    const StatementQuery *query = &(transaction->statement);
+    TransactionRecord *records = new TransactionRecord[query->limit];
+    TransactionRecord *found = new TransactionRecord[query->limit];
+    TransactionRecord *merged = new TransactionRecord[query->limit];
+    long count = 0;
+    for (int s = 0; s < engine->shards; s++) {
+        long foundCount = accountHistory(engine->logs[s], transaction->account_id, query, found);
+        // Merge two newest-first lists, keeping at most limit records
+        long i = 0, j = 0, m = 0;
+        while (m < query->limit && (i < count || j < foundCount)) {
+            if (j == foundCount || (i < count && records[i].timestamp_ns >= found[j].timestamp_ns)) {
+                merged[m++] = records[i++];
+            } else {
+                merged[m++] = found[j++];
+            }
+        }
+        TransactionRecord *swap = records;
+        records = merged;
+        merged = swap;
+        count = m;
+    }
+    printStatement(monitor, transaction->account_id, records, count);
+    delete[] records;
+    delete[] found;
+    delete[] merged;
+}
+
+/**
+ * @brief Main loop of a shard worker: runs the transactions routed to it until the router closes its queue.
+ *
+ * The worker owns its shard's accounts outright, so it runs transactions
+ * on them without entering any monitor or taking any lock.
+ *
+ * @param engine Pointer to the shard engine.
+ * @param shard This shard.
+ * @param monitor This shard's monitor (own log, cache and lock table).
+ */
+static void shardWorkerLoop(ShardEngine *engine, int shard, Monitor *monitor) {
+    ShardQueue *queue = &(engine->queues[shard]);
+    long waits = 0;
+    while (true) {
+        long head = queue->head;
+        if (__atomic_load_n(&(queue->tail), __ATOMIC_ACQUIRE) == head) {
+            // The router closes the queue after its last transaction, so check the tail once more
+            if (__atomic_load_n(&(queue->closed), __ATOMIC_ACQUIRE) &&
+                __atomic_load_n(&(queue->tail), __ATOMIC_ACQUIRE) == head) {
+                break;
+            }
+            shardBackOff(&waits);
+            continue;
+        }
+        waits = 0;
+
+        const Transaction *transaction = &(queue->jobs[head % SHARD_QUEUE_CAPACITY]);
+        metricsBeginTransaction(monitor->metrics);
+        if (transaction->command == CMD_STATEMENT) {
+            shardStatement(engine, monitor, transaction);
+        } else if (transaction->command == CMD_REPORT) {
+            report(monitor); // Shard monitors keep no snapshot table, so this reports the error
+        } else if (transaction->command != CMD_TRANSFER) {
+            executeTransactionLocked(monitor, transaction);
+        } else {
+            int fromShard = shardOf(transaction->account_id, engine->shards);
+            int toShard = shardOf(transaction->recipient_account_id, engine->shards);
+            if (fromShard == toShard) {
+                executeTransactionLocked(monitor, transaction);
+            } else if (fromShard == shard) {
+                transferOut(engine, shard, monitor, transaction, toShard);
+            } else {
+                transferIn(engine, shard, monitor, transaction, fromShard);
+            }
+        }
+        __atomic_store_n(&(queue->head), head + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * @brief Runs one shard in a forked worker process.
+ *
+ * Pins the worker to a CPU and gives it a monitor of its own over the
+ * shard's log, with its own account cache sized like the global one; the
+ * account directory, metrics and event output are shared.
+ *
+ * @param engine Pointer to the shard engine.
+ * @param shard This shard.
+ * @param global The driver's monitor, whose settings the shard copies.
+ * @return 0 on success, or 1 if the shard could not be set up.
+ */
+static int runShard(ShardEngine *engine, int shard, const Monitor *global) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(shard % ((cpus > 0) ? cpus : 1), &cpuSet);
+    sched_setaffinity(0, sizeof(cpuSet), &cpuSet); // Best effort
+
+    size_t monitor_size = monitorSize(SHARD_LOCK_STRIPES);
+    Monitor *monitor = (Monitor *)mmap(NULL, monitor_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (monitor == MAP_FAILED) {
+        perror("Shard monitor mmap");
+        return 1;
+    }
+    initializeMonitor(monitor, engine->logs[shard], SHARD_LOCK_STRIPES);
+    monitor->directory = global->directory;
+    monitor->metrics = global->metrics;
+    monitor->output = global->output;
+    monitor->async_io = global->async_io;
+    monitor->flock_compat = global->flock_compat;
+
+    AccountCache *cache = NULL;
+    size_t cache_size = 0;
+    if (global->cache != NULL) {
+        cache_size = accountCacheSize(global->cache->capacity);
+        cache = (AccountCache *)mmap(NULL, cache_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (cache == MAP_FAILED) {
+            perror("Shard cache mmap");
+            return 1;
+        }
+        initializeAccountCache(cache, global->cache->capacity, global->cache->flush_threshold);
+        monitor->cache = cache;
+    }
+
+    selectEventProducer(shard + 1);
+    shardWorkerLoop(engine, shard, monitor);
+
+    if (cache != NULL) {
+        monitorFlushCache(monitor);
+        monitor->cache = NULL;
+        munmap(cache, cache_size);
+    }
+    fflush(stdout);
+    destroyMonitor(monitor);
+    munmap(monitor, monitor_size);
+    return 0;
+}
+
+/**
+ * @brief Appends every shard's records to the shared log, oldest first.
+ *
+ * Each shard's log is already in time order, so this is a merge by timestamp
+ * (ties go to the lower shard).
+ *
+ * @param engine Pointer to the shard engine.
+ * @param shm_ptr The shared log.
+ */
+static void mergeShardLogs(ShardEngine *engine, SharedMemorySegment *shm_ptr) {
+    TransactionLogReader readers[MAX_EXEC_SHARDS];
+    TransactionRecord heads[MAX_EXEC_SHARDS];
+    bool present[MAX_EXEC_SHARDS];
+    for (int s = 0; s < engine->shards; s++) {
+        openTransactionLogReader(&(readers[s]), engine->logs[s]);
+        present[s] = nextTransaction(&(readers[s]), &(heads[s]));
+    }
+    while (true) {
+        int oldest = -1;
+        for (int s = 0; s < engine->shards; s++) {
+            if (present[s] && (oldest == -1 || heads[s].timestamp_ns < heads[oldest].timestamp_ns)) {
+                oldest = s;
+            }
+        }
+        if (oldest == -1) {
+            break;
+        }
+        appendTransaction(shm_ptr, &(heads[oldest]));
+        present[oldest] = nextTransaction(&(readers[oldest]), &(heads[oldest]));
+    }
+    for (int s = 0; s < engine->shards; s++) {
+        closeTransactionLogReader(&(readers[s]));
+    }
+}
+
+/**
+ * @brief Releases the shards' logs and removes their spill files.
+ */
+static void destroyShardLogs(ShardEngine *engine, int count) {
+    for (int s = 0; s < count; s++) {
+        unlink(engine->logs[s]->spill_path);
+        destroyTransactionLog(engine->logs[s]);
+        munmap(engine->logs[s], engine->log_size);
+    }
+}
+
+/**
+ * @brief Runs every transaction in the input on shared-nothing shards.
+ *
+ * Accounts are partitioned by hash over shards worker processes, each
+ * pinned to a CPU and owning its accounts' storage, cache and log outright,
+ * so workers share no locks and no monitor state. The parent parses the
+ * input and routes each transaction, in input order, to the shard that
+ * owns its account over a lock-free single-producer, single-consumer queue.
+ * A transfer between two shards is routed to both: the sender's shard asks
+ * the recipient's shard to credit over a queue between the two, and debits
+ * once the credit is confirmed (see transferOut and transferIn). Since every
+ * shard runs its queue in input order, each account sees its transactions
+ * in input order, with the same outcomes as a serial run. At the end the
+ * shards' logs are merged into the shared log by timestamp.
+ *
+ * @param monitor The driver's monitor: its log receives the records, and
+ *        its cache size, account directory, metrics and output are used by every shard.
+ * @param input Reader over the transaction input.
+ * @param shards Number of shards (1 to MAX_EXEC_SHARDS).
+ * @return 0 on success, or 1 if the shards could not be set up.
+ */
+int runShardEngine(Monitor *monitor, InputReader *input, int shards) {
+    ShardEngine *engine = (ShardEngine *)mmap(NULL, sizeof(ShardEngine), PROT_READ | PROT_WRITE,
+                                              MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (engine == MAP_FAILED) {
+        perror("Shard engine mmap");
+        return 1;
+    }
+    engine->shards = shards;
+    engine->log_size = transactionLogSize(monitor->shm_ptr->capacity);
+    for (int s = 0; s < shards; s++) {
+        engine->logs[s] = (SharedMemorySegment *)mmap(NULL, engine->log_size, PROT_READ | PROT_WRITE,
+                                                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (engine->logs[s] == MAP_FAILED) {
+            perror("Shard log mmap");
+            destroyShardLogs(engine, s);
+            munmap(engine, sizeof(ShardEngine));
+            return 1;
+        }
+        char spillPath[SPILL_PATH_LENGTH];
+        snprintf(spillPath, sizeof(spillPath), "%.240s.shard%d", monitor->shm_ptr->spill_path, s);
+        initializeTransactionLog(engine->logs[s], monitor->shm_ptr->capacity, spillPath);
+    }
+
+    // Flush before forking so buffered output is not duplicated in every worker
+    cout.flush();
+    fflush(stdout);
+
+    int started = 0;
+    for (int s = 0; s < shards; s++) {
+        pid_t pid = fork();
+        if (pid == 0) { // Shard worker
+            exit(runShard(engine, s, monitor));
+        } else if (pid > 0) {
+            started++;
+        } else {
+            perror("Fork failed");
+            break;
+        }
+    }
+
+    // Every shard must run, or transfers into a missing one would wait forever
+    bool running = (started == shards);
+    string_view line;
+    while (running && nextInputLine(input, &line)) {
+        Transaction transaction;
+        string_view command;
+        ParseStatus status = parseTransaction(line, &transaction, &command);
+        if (status != PARSE_OK) {
+            if (status != PARSE_BLANK) {
+                reportParseError(input, status, command);
+            }
+            continue;
+        }
+        int owner = shardOf(transaction.account_id, shards);
+        pushShardJob(&(engine->queues[owner]), &transaction);
+        if (transaction.command == CMD_TRANSFER) {
+            int recipientOwner = shardOf(transaction.recipient_account_id, shards);
+            if (recipientOwner != owner) {
+                pushShardJob(&(engine->queues[recipientOwner]), &transaction);
+            }
+        }
+    }
+    for (int s = 0; s < shards; s++) {
+        __atomic_store_n(&(engine->queues[s].closed), 1, __ATOMIC_RELEASE);
+    }
+    for (int s = 0; s < started; s++) {
+        wait(NULL);
+    }
+
+    mergeShardLogs(engine, monitor->shm_ptr);
+    destroyShardLogs(engine, shards);
+    munmap(engine, sizeof(ShardEngine));
+    return running ? 0 : 1;
+}
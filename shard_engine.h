@@ -0,0 +1,52 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef SHARD_ENGINE_H
+#define SHARD_ENGINE_H
+
+#include "monitor.h"
+#include "input_parser.h"
+
+#define MAX_EXEC_SHARDS 64
+#define SHARD_QUEUE_CAPACITY 1024  // Transactions routed to a shard and not yet taken
+#define SHARD_PEER_CAPACITY 16     // Messages between two shards (each has at most one transfer in flight)
+#define SHARD_LOCK_STRIPES 64      // Lock table of a shard's own monitor, which only its worker uses
+
+// Transactions routed to one shard: a single-producer (the router),
+// single-consumer (the shard's worker) ring
+struct ShardQueue {
+    alignas(64) long head;   // Next transaction the worker takes (written by the worker)
+    alignas(64) long tail;   // Transactions routed so far (written by the router)
+    int closed;              // Set by the router after the last transaction
+    Transaction jobs[SHARD_QUEUE_CAPACITY];
+};
+
+// One step of a transfer between accounts of two shards
+struct TransferMessage {
+    Money amount;
+    Money balance;              // Reply: the recipient's new balance
+    TransactionReason reason;   // Request: what the debit side found; reply: the outcome
+};
+
+// Messages from one shard to another (single producer, single consumer)
+struct PeerQueue {
+    alignas(64) long head;
+    alignas(64) long tail;
+    TransferMessage messages[SHARD_PEER_CAPACITY];
+};
+
+// Everything the router and the shard workers share (must live in shared memory)
+struct ShardEngine {
+    int shards;
+    ShardQueue queues[MAX_EXEC_SHARDS];
+    PeerQueue peers[MAX_EXEC_SHARDS][MAX_EXEC_SHARDS];  // peers[from][to]
+    SharedMemorySegment *logs[MAX_EXEC_SHARDS];         // Each shard's own log (mapped before the workers fork)
+    size_t log_size;
+};
+
+int shardOf(const char *accountId, int shards);
+int runShardEngine(Monitor *monitor, InputReader *input, int shards);
+
+#endif // SHARD_ENGINE_H
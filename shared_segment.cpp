@@ -0,0 +1,165 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "shared_segment.h"
+#include <iostream>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/shm.h>
+
+using namespace std;
+
+/**
+ * @brief Computes the size of the shared segment for a lock table and log size.
+ *
+ * @param lockStripes Number of lock stripes (already a power of two).
+ * @param logCapacity Number of records in the transaction log's ring.
+ * @return Size in bytes of the header, the monitor with its lock table and the log.
+ */
+size_t sharedSegmentSize(int lockStripes, long logCapacity) {
+    return cacheLineAlign(sizeof(SegmentHeader)) + cacheLineAlign(monitorSize(lockStripes)) +
+           transactionLogSize(logCapacity);
+}
+
+/**
+ * @brief Fills in the header a segment must have to be reused with these settings.
+ */
+static void describeSegment(SegmentHeader *header, int lockStripes, long logCapacity) {
+    memset(header, 0, sizeof(*header));
+    header->magic = SEGMENT_MAGIC;
+    header->version = SEGMENT_VERSION;
+    header->lock_stripes = lockStripes;
+    header->log_capacity = logCapacity;
+    header->segment_size = sharedSegmentSize(lockStripes, logCapacity);
+    header->monitor_bytes = sizeof(Monitor);
+    header->lane_bytes = sizeof(AdmissionLane);
+    header->stripe_bytes = sizeof(LockStripe);
+    header->record_bytes = sizeof(TransactionRecord);
+}
+
+/**
+ * @brief Checks whether a segment's header describes the expected layout.
+ */
+static bool segmentMatches(const SegmentHeader *header, const SegmentHeader *expected) {
+    return header->magic == expected->magic && header->version == expected->version &&
+           header->lock_stripes == expected->lock_stripes && header->log_capacity == expected->log_capacity &&
+           header->segment_size == expected->segment_size && header->monitor_bytes == expected->monitor_bytes &&
+           header->lane_bytes == expected->lane_bytes && header->stripe_bytes == expected->stripe_bytes &&
+           header->record_bytes == expected->record_bytes;
+}
+
+/**
+ * @brief Creates or attaches the System V segment holding the monitor and the transaction log.
+ *
+ * A segment a previous run detached from with closeSharedSegment(keep) is
+ * reused in constant time when its header matches this build and these
+ * settings: none of the lock table's mutexes are initialized again and the
+ * log just starts a new run. A segment of another size or layout, or one
+ * whose last owner died without detaching, is initialized from scratch.
+ *
+ * @param segment Receives the attached segment.
+ * @param key System V IPC key of the segment.
+ * @param lockStripes Number of lock stripes (already a power of two).
+ * @param logCapacity Number of records in the transaction log's ring.
+ * @param spillPath Path of the file older log records are spilled to.
+ * @return 0 on success, or -1 if the segment could not be attached or another run is using it.
+ */
+int openSharedSegment(SharedSegment *segment, key_t key, int lockStripes, long logCapacity, const char *spillPath) {
+    size_t size = sharedSegmentSize(lockStripes, logCapacity);
+    int id = shmget(key, size, IPC_CREAT | 0666);
+    if (id < 0 && errno == EINVAL) {
+        // A segment of a different size was left behind by an earlier run
+        int stale_id = shmget(key, 0, 0);
+        if (stale_id >= 0) {
+            shmctl(stale_id, IPC_RMID, NULL);
+        }
+        id = shmget(key, size, IPC_CREAT | 0666);
+    }
+    if (id < 0) {
+        perror("Parent shmget");
+        return -1;
+    }
+
+    char *base = (char *)shmat(id, NULL, 0);
+    if (base == (char *)-1) {
+        perror("Parent shmat");
+        return -1;
+    }
+    SegmentHeader *header = (SegmentHeader *)base;
+
+    // Claim the segment; its owner is either nobody or a run that died without detaching
+    pid_t self = getpid();
+    pid_t owner = __atomic_load_n(&(header->owner), __ATOMIC_ACQUIRE);
+    if ((owner != 0 && !processExited(owner)) ||
+        !__atomic_compare_exchange_n(&(header->owner), &owner, self, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        cerr << "Error: Shared memory is in use by process " << owner << endl;
+        shmdt(base);
+        return -1;
+    }
+
+    segment->id = id;
+    segment->header = header;
+    segment->monitor = (Monitor *)(base + cacheLineAlign(sizeof(SegmentHeader)));
+    segment->log = (SharedMemorySegment *)((char *)segment->monitor + cacheLineAlign(monitorSize(lockStripes)));
+
+    SegmentHeader expected;
+    describeSegment(&expected, lockStripes, logCapacity);
+    segment->reused = (owner == 0 && __atomic_load_n(&(header->ready), __ATOMIC_ACQUIRE) &&
+                       segmentMatches(header, &expected));
+    if (segment->reused) {
+        reopenTransactionLog(segment->log, spillPath);
+        attachMonitor(segment->monitor, segment->log);
+        return 0;
+    }
+
+    __atomic_store_n(&(header->ready), 0, __ATOMIC_RELEASE);
+    initializeTransactionLog(segment->log, logCapacity, spillPath);
+    initializeMonitor(segment->monitor, segment->log, lockStripes);
+    expected.owner = self;
+    *header = expected;
+    __atomic_store_n(&(header->ready), 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/**
+ * @brief Checks that no process is inside the monitor or waiting on it.
+ *
+ * Only then can a later run reuse the lock table as it is.
+ */
+static bool monitorQuiescent(Monitor *monitor) {
+    for (int i = 0; i < monitor->lock_stripes; i++) {
+        AdmissionLane *lane = &(monitor->lanes[i]);
+        if (lane->now_serving != lane->next_ticket || lane->readers != 0 || monitor->account_mutexes[i].fill != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Detaches from the shared segment once every other process of the run has exited.
+ *
+ * @param segment The segment from openSharedSegment.
+ * @param keep Leave the segment initialized for the next run instead of removing it.
+ *             It is only kept if the lock table is idle (a process that died
+ *             inside the monitor leaves it for the next run to initialize).
+ */
+void closeSharedSegment(SharedSegment *segment, bool keep) {
+    if (keep && monitorQuiescent(segment->monitor)) {
+        __atomic_store_n(&(segment->header->owner), 0, __ATOMIC_RELEASE);
+        shmdt(segment->header);
+        return;
+    }
+
+    __atomic_store_n(&(segment->header->ready), 0, __ATOMIC_RELEASE);
+    destroyMonitor(segment->monitor);
+    destroyTransactionLog(segment->log);
+    shmdt(segment->header);
+    if (!keep) {
+        shmctl(segment->id, IPC_RMID, NULL);
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef SHARED_SEGMENT_H
+#define SHARED_SEGMENT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include "monitor.h"
+#include "sharedmemory.h"
+
+#define SEGMENT_MAGIC 0x314d48534b4e4142ULL  // "BANKSHM1"
+#define SEGMENT_VERSION 4                    // Bump whenever a structure kept in the segment changes
+
+// Header at the start of the System V segment. A later run reuses the
+// monitor and transaction log behind it as they are when every field
+// matches its own build and settings and the last run detached cleanly.
+struct SegmentHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t ready;          // Set once everything after the header is initialized
+    pid_t owner;             // Process of the run using the segment, or 0 after a clean detach
+    int lock_stripes;
+    long log_capacity;
+    uint64_t segment_size;
+    uint32_t monitor_bytes;  // sizeof(Monitor) when the segment was initialized
+    uint32_t lane_bytes;     // sizeof(AdmissionLane)
+    uint32_t stripe_bytes;   // sizeof(LockStripe)
+    uint32_t record_bytes;   // sizeof(TransactionRecord)
+};
+
+// A run's view of the segment: header, then the monitor with its lock table, then the transaction log
+struct SharedSegment {
+    int id;
+    SegmentHeader *header;
+    Monitor *monitor;
+    SharedMemorySegment *log;
+    bool reused;             // The monitor and log were left initialized by an earlier run
+};
+
+size_t sharedSegmentSize(int lockStripes, long logCapacity);
+int openSharedSegment(SharedSegment *segment, key_t key, int lockStripes, long logCapacity, const char *spillPath);
+void closeSharedSegment(SharedSegment *segment, bool keep);
+
+#endif // SHARED_SEGMENT_H
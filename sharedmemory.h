@@ -10,27 +10,147 @@
 
 #include <pthread.h>
 #include <time.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "money.h"
 
-#define MAX_TRANSACTIONS 100
+#define DEFAULT_LOG_CAPACITY 65536  // Records held in shared memory before older ones are spilled
+#define DEFAULT_SPILL_PATH "transactions.log"
+#define SPILL_PATH_LENGTH 256
 #define ACCOUNT_ID_LENGTH 20
-#define STATUS_LENGTH 10
-#define TRANSACTION_TYPE_LENGTH 10
-#define REASON_LENGTH 100
+#define TIMESTAMP_LENGTH 30
+#define RECORD_TEXT_LENGTH 256  // Enough for one formatted record
+#define MIN_HISTORY_SLOTS 1024  // Smallest per-account history table (it is sized like the ring)
+#define DEFAULT_STATEMENT_RECORDS 10  // Records a STATEMENT without a count or range returns
+#define MAX_STATEMENT_RECORDS 1000    // Most records one STATEMENT returns
 
+// Called with each account ID by the account listing functions
+typedef void (*AccountVisitor)(const char *accountId, void *context);
+
+// Transaction types (names via transactionTypeName)
+enum TransactionType : uint8_t {
+    TXN_CREATE,
+    TXN_DEPOSIT,
+    TXN_WITHDRAW,
+    TXN_INQUIRY,
+    TXN_TRANSFER,
+    TXN_CLOSE,
+    TXN_TYPE_COUNT
+};
+
+// Transaction outcomes (names via transactionStatusName)
+enum TransactionStatus : uint8_t {
+    TXN_SUCCESS,
+    TXN_FAILED,
+    TXN_STATUS_COUNT
+};
+
+// Reasons recorded with a transaction (text via transactionReasonName)
+enum TransactionReason : uint16_t {
+    REASON_NONE,                // "N/A"
+    REASON_ACCOUNT_EXISTS,      // "Account already exists"
+    REASON_FILE_CREATION,       // "File creation error"
+    REASON_ACCOUNT_NOT_FOUND,   // "Account not found"
+    REASON_INSUFFICIENT_FUNDS,  // "Insufficient funds"
+    REASON_FROM_NOT_FOUND,      // "From account not found"
+    REASON_TO_NOT_FOUND,        // "To account not found"
+    REASON_BALANCE_NOT_ZERO,    // "Balance not zero"
+    REASON_DELETE_ERROR,        // "Error deleting file"
+    REASON_COUNT
+};
+
+// Compact log record; text is only produced by formatTransaction when the log is dumped
 struct TransactionRecord {
-    char transaction_type[TRANSACTION_TYPE_LENGTH]; // CREATE, DEPOSIT, etc.
+    long sequence; // Log position + 1 once the record is fully written (0 while being filled)
+    int64_t timestamp_ns; // Wall-clock time of the transaction in nanoseconds since the epoch
+    Money amount; // Transaction amount
+    TransactionType transaction_type;
+    TransactionStatus status;
+    TransactionReason reason; // Reason for failure, if any
     char account_id[ACCOUNT_ID_LENGTH];
     char recipient_account_id[ACCOUNT_ID_LENGTH]; // For TRANSFER transactions
-    double amount; // Transaction amount
-    char status[STATUS_LENGTH]; // SUCCESS or FAILED
-    char reason[REASON_LENGTH]; // Reason for failure, if any
-    char timestamp[30]; // Date and time of the transaction
+    long previous;           // Position of account_id's previous record, or -1 (set when appended)
+    long recipient_previous; // Position of recipient_account_id's previous record, or -1
+};
+
+// Newest log position of one account; the account's records are chained
+// backwards from it through previous / recipient_previous
+struct HistoryHead {
+    uint32_t state;   // HistoryHeadState, updated atomically
+    uint32_t hash;    // Low bits of the id hash, checked before comparing ids
+    long last;        // Position of the account's newest record (atomic), or -1
+    char id[ACCOUNT_ID_LENGTH];
+};
+
+// History head states
+enum HistoryHeadState {
+    HISTORY_EMPTY = 0,
+    HISTORY_BUSY = 1,   // Being claimed; the id is not written yet
+    HISTORY_READY = 2
+};
+
+// Which of an account's records a statement returns
+struct StatementQuery {
+    long limit;        // Most records, newest first
+    int64_t from_ns;   // Oldest timestamp included
+    int64_t to_ns;     // Newest timestamp included
+};
+
+// How writers append to the transaction log
+enum LogAppendMode {
+    LOG_APPEND_LOCKFREE, // Reserve a position with an atomic fetch-add, publish with the record's sequence
+    LOG_APPEND_MUTEX     // Same protocol, serialized by shm_ptr->mutex (for comparison)
 };
 
+// Transaction log: a ring of records in shared memory. Record n lives in
+// records[n % capacity]; once the ring is full the oldest records are
+// appended to the spill file before their slots are reused. Positions keep
+// counting up when a run reuses the segment, so the current run's records
+// are [base, transaction_count) and slots left by earlier runs never look
+// published. A table of per-account history heads follows the ring.
 struct SharedMemorySegment {
-    TransactionRecord records[MAX_TRANSACTIONS];
-    int transaction_count;
-    pthread_mutex_t mutex; // Mutex for synchronization
+    long capacity;          // Number of records in the ring
+    long base;              // First position of the current run
+    long transaction_count; // Positions reserved by writers (writer cursor)
+    long spill_count;       // Records [base, spill_count) are in the spill file
+    LogAppendMode append_mode;
+    char spill_path[SPILL_PATH_LENGTH];
+    pthread_mutex_t mutex;       // Serializes writers in LOG_APPEND_MUTEX mode
+    pthread_mutex_t spill_mutex; // Held by the process spilling the ring
+    long history_slots;          // Entries in the history table (power of two)
+    int history_full;            // Set once an account found no free history entry
+    TransactionRecord records[]; // capacity entries follow the header
 };
 
+// Sequential reader over the spill file followed by the ring
+struct TransactionLogReader {
+    SharedMemorySegment *shm_ptr;
+    int spill_fd;
+    long position;
+};
+
+const char *transactionTypeName(TransactionType type);
+const char *transactionStatusName(TransactionStatus status);
+const char *transactionReasonName(TransactionReason reason);
+int formatTransaction(const TransactionRecord *record, char *buffer, size_t size);
+
+// Process-shared robust mutexes: when a holder dies, the next locker gets the mutex
+void initializeSharedMutex(pthread_mutex_t *mutex);
+bool lockSharedMutex(pthread_mutex_t *mutex);
+bool tryLockSharedMutex(pthread_mutex_t *mutex);
+int waitSharedCondition(pthread_cond_t *condition, pthread_mutex_t *mutex, const struct timespec *deadline = NULL);
+
+size_t transactionLogSize(long capacity);
+void initializeTransactionLog(SharedMemorySegment *shm_ptr, long capacity, const char *spillPath);
+void reopenTransactionLog(SharedMemorySegment *shm_ptr, const char *spillPath);
+void destroyTransactionLog(SharedMemorySegment *shm_ptr);
+void spillTransactions(SharedMemorySegment *shm_ptr);
+void appendTransaction(SharedMemorySegment *shm_ptr, const TransactionRecord *record);
+void appendTransactions(SharedMemorySegment *shm_ptr, const TransactionRecord *records, long count);
+void openTransactionLogReader(TransactionLogReader *reader, SharedMemorySegment *shm_ptr);
+bool nextTransaction(TransactionLogReader *reader, TransactionRecord *record);
+void closeTransactionLogReader(TransactionLogReader *reader);
+bool readTransactionAt(SharedMemorySegment *shm_ptr, long position, TransactionRecord *record, int *spillFd);
+long accountHistory(SharedMemorySegment *shm_ptr, const char *accountId, const StatementQuery *query, TransactionRecord *records);
+
 #endif // SHAREDMEMORY_H
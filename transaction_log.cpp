@@ -0,0 +1,735 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "sharedmemory.h"
+#include "account_store.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sched.h>
+
+static const char *const TRANSACTION_TYPE_NAMES[TXN_TYPE_COUNT] = {
+    "CREATE", "DEPOSIT", "WITHDRAW", "INQUIRY", "TRANSFER", "CLOSE"
+};
+
+static const char *const TRANSACTION_STATUS_NAMES[TXN_STATUS_COUNT] = {
+    "SUCCESS", "FAILED"
+};
+
+static const char *const TRANSACTION_REASON_NAMES[REASON_COUNT] = {
+    "N/A",
+    "Account already exists",
+    "File creation error",
+    "Account not found",
+    "Insufficient funds",
+    "From account not found",
+    "To account not found",
+    "Balance not zero",
+    "Error deleting file"
+};
+
+/**
+ * @brief Returns the name of a transaction type (e.g., "DEPOSIT").
+ */
+const char *transactionTypeName(TransactionType type) {
+    return type < TXN_TYPE_COUNT ? TRANSACTION_TYPE_NAMES[type] : "UNKNOWN";
+}
+
+/**
+ * @brief Returns the name of a transaction status ("SUCCESS" or "FAILED").
+ */
+const char *transactionStatusName(TransactionStatus status) {
+    return status < TXN_STATUS_COUNT ? TRANSACTION_STATUS_NAMES[status] : "UNKNOWN";
+}
+
+/**
+ * @brief Returns the descriptive text of a transaction reason (e.g., "Insufficient funds").
+ */
+const char *transactionReasonName(TransactionReason reason) {
+    return reason < REASON_COUNT ? TRANSACTION_REASON_NAMES[reason] : "Unknown reason";
+}
+
+/**
+ * @brief Renders a record's time as the log dump shows it ("2026-10-17 14:03:22", local time).
+ *
+ * @param timestampNs Wall-clock time in nanoseconds since the epoch.
+ * @param timestamp Receives the text (TIMESTAMP_LENGTH bytes).
+ */
+static void formatTimestamp(int64_t timestampNs, char *timestamp) {
+    time_t seconds = (time_t)(timestampNs / 1000000000LL);
+    struct tm local;
+    localtime_r(&seconds, &local);
+    strftime(timestamp, TIMESTAMP_LENGTH, "%Y-%m-%d %H:%M:%S", &local);
+}
+
+/**
+ * @brief Renders a record with an already formatted timestamp (see formatTransaction).
+ */
+static int formatTransactionAt(const TransactionRecord *record, const char *timestamp, char *buffer, size_t size) {
+    char amount[MONEY_TEXT_LENGTH];
+    formatMoneyShort(record->amount, amount);
+
+    return snprintf(buffer, size,
+                    "Transaction Type: %s, Account ID: %.*s, Amount: %s, Status: %s, Reason: %s, Timestamp: %s",
+                    transactionTypeName(record->transaction_type), ACCOUNT_ID_LENGTH, record->account_id,
+                    amount, transactionStatusName(record->status),
+                    transactionReasonName(record->reason), timestamp);
+}
+
+/**
+ * @brief Renders a record as the human-readable line printed by the log dump.
+ *
+ * @param record The record to format.
+ * @param buffer Receives the text (without a trailing newline).
+ * @param size Size of the buffer; RECORD_TEXT_LENGTH always suffices.
+ * @return The number of characters written, as returned by snprintf.
+ */
+int formatTransaction(const TransactionRecord *record, char *buffer, size_t size) {
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(record->timestamp_ns, timestamp);
+    return formatTransactionAt(record, timestamp, buffer, size);
+}
+
+/**
+ * @brief Initializes a mutex that processes share, made robust so a holder that dies cannot wedge the others.
+ *
+ * @param mutex The mutex, in memory shared by every process that locks it.
+ */
+void initializeSharedMutex(pthread_mutex_t *mutex) {
+    pthread_mutexattr_t mutexAttr;
+    pthread_mutexattr_init(&mutexAttr);
+    pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutexAttr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(mutex, &mutexAttr);
+    pthread_mutexattr_destroy(&mutexAttr);
+}
+
+/**
+ * @brief Takes over a robust mutex whose previous holder died.
+ *
+ * Whatever the holder was protecting may be half updated; the structures
+ * behind these mutexes are counters and cursors that stay usable, so the
+ * mutex is simply marked consistent again.
+ */
+static void recoverSharedMutex(pthread_mutex_t *mutex) {
+    fprintf(stderr, "Recovered a lock held by a process that exited.\n");
+    pthread_mutex_consistent(mutex);
+}
+
+/**
+ * @brief Locks a mutex initialized by initializeSharedMutex.
+ *
+ * @param mutex The mutex.
+ * @return true if its previous holder had died while holding it.
+ */
+bool lockSharedMutex(pthread_mutex_t *mutex) {
+    if (pthread_mutex_lock(mutex) == EOWNERDEAD) {
+        recoverSharedMutex(mutex);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Tries to lock a mutex initialized by initializeSharedMutex without blocking.
+ *
+ * @param mutex The mutex.
+ * @return true if the mutex is now held.
+ */
+bool tryLockSharedMutex(pthread_mutex_t *mutex) {
+    int result = pthread_mutex_trylock(mutex);
+    if (result == EOWNERDEAD) {
+        recoverSharedMutex(mutex);
+        return true;
+    }
+    return result == 0;
+}
+
+/**
+ * @brief Waits on a process-shared condition variable paired with a robust mutex.
+ *
+ * @param condition The condition variable.
+ * @param mutex The mutex, held by the caller (and again on return).
+ * @param deadline CLOCK_MONOTONIC time to give up at, or NULL to wait until signaled.
+ * @return 0, or ETIMEDOUT if the deadline passed.
+ */
+int waitSharedCondition(pthread_cond_t *condition, pthread_mutex_t *mutex, const struct timespec *deadline) {
+    int result = (deadline != NULL) ? pthread_cond_timedwait(condition, mutex, deadline)
+                                    : pthread_cond_wait(condition, mutex);
+    if (result == EOWNERDEAD) {
+        recoverSharedMutex(mutex);
+        result = 0;
+    }
+    return result;
+}
+
+/**
+ * @brief Returns the number of history heads kept for a ring: its capacity rounded up to a power of two.
+ */
+static long historySlots(long capacity) {
+    long slots = MIN_HISTORY_SLOTS;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+/**
+ * @brief Returns the history table, which follows the ring.
+ */
+static HistoryHead *historyTable(SharedMemorySegment *shm_ptr) {
+    return (HistoryHead *)(shm_ptr->records + shm_ptr->capacity);
+}
+
+/**
+ * @brief Computes the size of a shared memory segment holding a log of the given capacity.
+ *
+ * @param capacity Number of records in the ring.
+ * @return The segment size in bytes.
+ */
+size_t transactionLogSize(long capacity) {
+    return sizeof(SharedMemorySegment) + (size_t)capacity * sizeof(TransactionRecord) +
+           (size_t)historySlots(capacity) * sizeof(HistoryHead);
+}
+
+/**
+ * @brief Initializes an empty transaction log and discards any stale spill file.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param capacity Number of records in the ring.
+ * @param spillPath Path of the file older records are spilled to.
+ */
+void initializeTransactionLog(SharedMemorySegment *shm_ptr, long capacity, const char *spillPath) {
+    shm_ptr->capacity = capacity;
+    shm_ptr->transaction_count = 0;
+    initializeSharedMutex(&(shm_ptr->mutex));
+    initializeSharedMutex(&(shm_ptr->spill_mutex));
+
+    for (long i = 0; i < capacity; i++) {
+        shm_ptr->records[i].sequence = 0;
+    }
+    shm_ptr->history_slots = historySlots(capacity);
+    shm_ptr->history_full = 0;
+    HistoryHead *table = historyTable(shm_ptr);
+    for (long i = 0; i < shm_ptr->history_slots; i++) {
+        table[i].state = HISTORY_EMPTY;
+    }
+    reopenTransactionLog(shm_ptr, spillPath);
+}
+
+/**
+ * @brief Starts a new, empty log in a segment an earlier run left initialized.
+ *
+ * Takes constant time: the ring and the history table are not cleared, the
+ * new run's positions just start after the last one reserved before (so
+ * history heads left by earlier runs point before base and read as empty).
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param spillPath Path of the file older records are spilled to (any existing file is discarded).
+ */
+void reopenTransactionLog(SharedMemorySegment *shm_ptr, const char *spillPath) {
+    shm_ptr->base = shm_ptr->transaction_count;
+    shm_ptr->spill_count = shm_ptr->base;
+    shm_ptr->append_mode = LOG_APPEND_LOCKFREE;
+    snprintf(shm_ptr->spill_path, sizeof(shm_ptr->spill_path), "%s", spillPath);
+    unlink(shm_ptr->spill_path);
+}
+
+/**
+ * @brief Destroys the transaction log's synchronization primitives.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ */
+void destroyTransactionLog(SharedMemorySegment *shm_ptr) {
+    pthread_mutex_destroy(&(shm_ptr->mutex));
+    pthread_mutex_destroy(&(shm_ptr->spill_mutex));
+}
+
+/**
+ * @brief Writes a buffer fully, retrying on short writes.
+ *
+ * @return 0 on success, or -1 on failure.
+ */
+static int writeFully(int fd, const char *buffer, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, buffer, length);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buffer += written;
+        length -= written;
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes a whole buffer at an offset, retrying short and interrupted writes.
+ *
+ * @return 0 on success, or -1 on error.
+ */
+static int pwriteFully(int fd, const char *buffer, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t written = pwrite(fd, buffer, length, offset);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        buffer += written;
+        length -= written;
+        offset += written;
+    }
+    return 0;
+}
+
+/**
+ * @brief Checks whether the record at a log position has been published.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param position The log position.
+ * @return true once the writer of that position has committed its record.
+ */
+static bool isCommitted(SharedMemorySegment *shm_ptr, long position) {
+    TransactionRecord *slot = &(shm_ptr->records[position % shm_ptr->capacity]);
+    return __atomic_load_n(&(slot->sequence), __ATOMIC_ACQUIRE) == position + 1;
+}
+
+/**
+ * @brief Appends the committed prefix of the unspilled records to the spill file.
+ *
+ * The caller holds shm_ptr->spill_mutex. Spilling stops at the first record
+ * still being written; its slot is freed by a later spill. Each record is
+ * written at its own offset, (position - base) records into the file, so
+ * records lost to a write error leave a hole and every later record still
+ * sits where readers look for it.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ */
+static void spillTransactionsLocked(SharedMemorySegment *shm_ptr) {
+    long first = __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE);
+    long reserved = __atomic_load_n(&(shm_ptr->transaction_count), __ATOMIC_ACQUIRE);
+    long last = first;
+    while (last < reserved && last - first < shm_ptr->capacity && isCommitted(shm_ptr, last)) {
+        last++;
+    }
+    if (first == last) {
+        return;
+    }
+
+    int fd = open(shm_ptr->spill_path, O_WRONLY | O_CREAT, 0666);
+    if (fd == -1) {
+        printf("Error opening transaction spill file: %s\n", shm_ptr->spill_path);
+    }
+
+    // The records to spill occupy at most two contiguous runs of the ring
+    long position = first;
+    while (fd != -1 && position < last) {
+        long slot = position % shm_ptr->capacity;
+        long run = shm_ptr->capacity - slot;
+        if (run > last - position) {
+            run = last - position;
+        }
+        off_t offset = (off_t)(position - shm_ptr->base) * sizeof(TransactionRecord);
+        if (pwriteFully(fd, (const char *)&(shm_ptr->records[slot]), run * sizeof(TransactionRecord), offset) == -1) {
+            printf("Error writing transaction spill file: %s\n", shm_ptr->spill_path);
+            break;
+        }
+        position += run;
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+
+    if (position != last) {
+        // Free the slots anyway so writers cannot wedge on a broken spill file
+        printf("%ld transaction records lost.\n", last - position);
+    }
+    __atomic_store_n(&(shm_ptr->spill_count), last, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Spills every committed record not yet on disk, so the spill file holds the complete log.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ */
+void spillTransactions(SharedMemorySegment *shm_ptr) {
+    lockSharedMutex(&(shm_ptr->spill_mutex));
+    spillTransactionsLocked(shm_ptr);
+    pthread_mutex_unlock(&(shm_ptr->spill_mutex));
+}
+
+/**
+ * @brief Finds an account's history head, optionally claiming a free entry for it.
+ *
+ * Open addressing over the history table; entries are never freed. If the
+ * table is full, history_full is set and the account goes unindexed.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param accountId The account.
+ * @param create Whether to claim an entry if the account has none.
+ * @return The head, or NULL if there is none (and none could be claimed).
+ */
+static HistoryHead *findHistoryHead(SharedMemorySegment *shm_ptr, const char *accountId, bool create) {
+    HistoryHead *table = historyTable(shm_ptr);
+    uint64_t hash = hashAccountId(accountId);
+    uint32_t tag = (uint32_t)hash;
+    long mask = shm_ptr->history_slots - 1;
+    for (long probe = 0; probe < shm_ptr->history_slots; probe++) {
+        HistoryHead *head = &(table[(hash + probe) & mask]);
+        uint32_t state = __atomic_load_n(&(head->state), __ATOMIC_ACQUIRE);
+        if (state == HISTORY_EMPTY) {
+            if (!create) {
+                return NULL;
+            }
+            if (!__atomic_compare_exchange_n(&(head->state), &state, (uint32_t)HISTORY_BUSY, false,
+                                             __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+                probe--; // Someone else claimed it first; look at it again
+                continue;
+            }
+            head->hash = tag;
+            head->last = -1;
+            strncpy(head->id, accountId, ACCOUNT_ID_LENGTH - 1);
+            head->id[ACCOUNT_ID_LENGTH - 1] = '\0';
+            __atomic_store_n(&(head->state), (uint32_t)HISTORY_READY, __ATOMIC_RELEASE);
+            return head;
+        }
+        while (state == HISTORY_BUSY) {
+            sched_yield();
+            state = __atomic_load_n(&(head->state), __ATOMIC_ACQUIRE);
+        }
+        if (head->hash == tag && strncmp(head->id, accountId, ACCOUNT_ID_LENGTH) == 0) {
+            return head;
+        }
+    }
+    if (create) {
+        __atomic_store_n(&(shm_ptr->history_full), 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Makes a record its account's newest, returning the position of the one before.
+ *
+ * @return The previous newest position, or -1 if there is none or the account is unindexed.
+ */
+static long pushHistory(SharedMemorySegment *shm_ptr, const char *accountId, long position) {
+    HistoryHead *head = findHistoryHead(shm_ptr, accountId, true);
+    if (head == NULL) {
+        return -1;
+    }
+    long previous = __atomic_exchange_n(&(head->last), position, __ATOMIC_ACQ_REL);
+    return (previous >= shm_ptr->base) ? previous : -1;
+}
+
+/**
+ * @brief Chains a record being appended onto its accounts' histories.
+ *
+ * Called before the record is published. Updates of one account are
+ * serialized by the monitor, so its chain is in log order; only inquiries,
+ * which share an account or (when optimistic) hold no lane at all, can be
+ * chained in either order.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param record The record, already in its slot.
+ * @param position The record's log position.
+ */
+static void linkHistory(SharedMemorySegment *shm_ptr, TransactionRecord *record, long position) {
+    record->previous = pushHistory(shm_ptr, record->account_id, position);
+    record->recipient_previous = -1;
+    if (record->recipient_account_id[0] != '\0' &&
+        strncmp(record->recipient_account_id, record->account_id, ACCOUNT_ID_LENGTH) != 0) {
+        record->recipient_previous = pushHistory(shm_ptr, record->recipient_account_id, position);
+    }
+}
+
+/**
+ * @brief Appends consecutive records to the log.
+ *
+ * A writer reserves its positions with one atomic fetch-add, waits until
+ * each position's slot has been spilled (helping to spill if nobody else
+ * is), copies the record in, chains it onto its accounts' histories and
+ * publishes it by storing its sequence last.
+ * Once the ring is half full, the writer also spills if no one else is
+ * spilling.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param records The records to append.
+ * @param count Number of records.
+ */
+static void appendTransactionsLockFree(SharedMemorySegment *shm_ptr, const TransactionRecord *records, long count) {
+    long first = __atomic_fetch_add(&(shm_ptr->transaction_count), count, __ATOMIC_ACQ_REL);
+
+    for (long i = 0; i < count; i++) {
+        long position = first + i;
+        while (position - __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE) >= shm_ptr->capacity) {
+            if (tryLockSharedMutex(&(shm_ptr->spill_mutex))) {
+                spillTransactionsLocked(shm_ptr);
+                pthread_mutex_unlock(&(shm_ptr->spill_mutex));
+            }
+            if (position - __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE) >= shm_ptr->capacity) {
+                sched_yield(); // Let the writers ahead of us publish
+            }
+        }
+
+        // Copy everything after the sequence field, then publish
+        TransactionRecord *slot = &(shm_ptr->records[position % shm_ptr->capacity]);
+        memcpy((char *)slot + sizeof(slot->sequence), (const char *)&(records[i]) + sizeof(records[i].sequence),
+               sizeof(TransactionRecord) - sizeof(slot->sequence));
+        linkHistory(shm_ptr, slot, position);
+        __atomic_store_n(&(slot->sequence), position + 1, __ATOMIC_RELEASE);
+    }
+
+    // Drain early once the ring is half full so writers rarely have to wait for a slot
+    if (first + count - 1 - __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE) >= shm_ptr->capacity / 2 &&
+        tryLockSharedMutex(&(shm_ptr->spill_mutex))) {
+        spillTransactionsLocked(shm_ptr);
+        pthread_mutex_unlock(&(shm_ptr->spill_mutex));
+    }
+}
+
+/**
+ * @brief Appends consecutive records to the log using the segment's append mode.
+ *
+ * The records get adjacent log positions, reserved in one step.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param records The records to append.
+ * @param count Number of records.
+ */
+void appendTransactions(SharedMemorySegment *shm_ptr, const TransactionRecord *records, long count) {
+    if (count <= 0) {
+        return;
+    }
+    if (shm_ptr->append_mode == LOG_APPEND_MUTEX) {
+        // Critical Section Start
+        lockSharedMutex(&(shm_ptr->mutex));
+        appendTransactionsLockFree(shm_ptr, records, count);
+        pthread_mutex_unlock(&(shm_ptr->mutex));
+        // Critical Section End
+    } else {
+        appendTransactionsLockFree(shm_ptr, records, count);
+    }
+}
+
+/**
+ * @brief Appends a record to the log using the segment's append mode.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param record The record to append.
+ */
+void appendTransaction(SharedMemorySegment *shm_ptr, const TransactionRecord *record) {
+    appendTransactions(shm_ptr, record, 1);
+}
+
+/**
+ * @brief Starts a sequential read of the whole log, oldest record first.
+ *
+ * @param reader Receives the reader state.
+ * @param shm_ptr Pointer to the shared memory segment.
+ */
+void openTransactionLogReader(TransactionLogReader *reader, SharedMemorySegment *shm_ptr) {
+    reader->shm_ptr = shm_ptr;
+    reader->spill_fd = -1;
+    reader->position = shm_ptr->base;
+}
+
+/**
+ * @brief Reads one record from the spill file.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param fd The spill file.
+ * @param position The record's log position.
+ * @param record Receives the record.
+ * @return false if the record is missing (lost to a spill write error, see spillTransactionsLocked).
+ */
+static bool readSpilledRecord(SharedMemorySegment *shm_ptr, int fd, long position, TransactionRecord *record) {
+    off_t offset = (off_t)(position - shm_ptr->base) * sizeof(TransactionRecord);
+    ssize_t length = pread(fd, record, sizeof(TransactionRecord), offset);
+    if (length == -1) {
+        printf("Error reading transaction spill file: %s\n", shm_ptr->spill_path);
+    }
+    // A hole reads as zeros, or short at the end of the file
+    return length == (ssize_t)sizeof(TransactionRecord) && record->sequence == position + 1;
+}
+
+/**
+ * @brief Reads the next record, from the spill file while it is older than the ring.
+ *
+ * Waits for records in the ring that have been reserved but not yet published.
+ * Records lost from the spill file are skipped.
+ *
+ * @param reader Pointer to the reader state.
+ * @param record Receives the record.
+ * @return true if a record was read, false at the end of the log.
+ */
+bool nextTransaction(TransactionLogReader *reader, TransactionRecord *record) {
+    SharedMemorySegment *shm_ptr = reader->shm_ptr;
+    if (reader->position >= shm_ptr->transaction_count) {
+        return false;
+    }
+
+    if (reader->position >= __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE)) {
+        while (!isCommitted(shm_ptr, reader->position)) {
+            sched_yield();
+        }
+        *record = shm_ptr->records[reader->position % shm_ptr->capacity];
+        reader->position++;
+        return true;
+    }
+
+    if (reader->spill_fd == -1) {
+        reader->spill_fd = open(shm_ptr->spill_path, O_RDONLY);
+        if (reader->spill_fd == -1) {
+            printf("Error opening transaction spill file: %s\n", shm_ptr->spill_path);
+            return false;
+        }
+    }
+    while (!readSpilledRecord(shm_ptr, reader->spill_fd, reader->position, record)) {
+        reader->position++;
+        if (reader->position >= __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE)) {
+            return nextTransaction(reader, record); // The rest is in the ring
+        }
+    }
+    reader->position++;
+    return true;
+}
+
+/**
+ * @brief Releases the reader's resources.
+ *
+ * @param reader Pointer to the reader state.
+ */
+void closeTransactionLogReader(TransactionLogReader *reader) {
+    if (reader->spill_fd != -1) {
+        close(reader->spill_fd);
+        reader->spill_fd = -1;
+    }
+}
+
+/**
+ * @brief Reads the record at one log position, from the ring or, once spilled, from the spill file.
+ *
+ * Waits for a record that has been reserved but not yet published.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param position The log position (in [base, transaction_count)).
+ * @param record Receives the record.
+ * @param spillFd The caller's spill file descriptor, opened on first use (start with -1, close when done).
+ * @return true if the record was read, false if it is outside the log or was lost from the spill file.
+ */
+bool readTransactionAt(SharedMemorySegment *shm_ptr, long position, TransactionRecord *record, int *spillFd) {
+    if (position < shm_ptr->base || position >= __atomic_load_n(&(shm_ptr->transaction_count), __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    while (position >= __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE)) {
+        if (!isCommitted(shm_ptr, position)) {
+            sched_yield();
+            continue;
+        }
+        *record = shm_ptr->records[position % shm_ptr->capacity];
+        // The slot cannot be reused before the record is spilled, so the copy is whole if it still is not
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (position >= __atomic_load_n(&(shm_ptr->spill_count), __ATOMIC_ACQUIRE)) {
+            return true;
+        }
+    }
+
+    if (*spillFd == -1) {
+        *spillFd = open(shm_ptr->spill_path, O_RDONLY);
+        if (*spillFd == -1) {
+            printf("Error opening transaction spill file: %s\n", shm_ptr->spill_path);
+            return false;
+        }
+    }
+    return readSpilledRecord(shm_ptr, *spillFd, position, record);
+}
+
+/**
+ * @brief Checks whether a record belongs to an account and falls in a statement's time range.
+ */
+static bool matchesStatement(const TransactionRecord *record, const char *accountId, const StatementQuery *query) {
+    return record->timestamp_ns >= query->from_ns && record->timestamp_ns <= query->to_ns &&
+           (strncmp(record->account_id, accountId, ACCOUNT_ID_LENGTH) == 0 ||
+            strncmp(record->recipient_account_id, accountId, ACCOUNT_ID_LENGTH) == 0);
+}
+
+/**
+ * @brief Finds an unindexed account's records by reading the whole log (the history table was full).
+ */
+static long scanAccountHistory(SharedMemorySegment *shm_ptr, const char *accountId, const StatementQuery *query,
+                               TransactionRecord *records) {
+    // Keep the newest limit matches in a ring, then hand them out newest first
+    TransactionRecord *newest = new TransactionRecord[query->limit];
+    long matches = 0;
+    TransactionLogReader reader;
+    TransactionRecord record;
+    openTransactionLogReader(&reader, shm_ptr);
+    while (nextTransaction(&reader, &record)) {
+        if (matchesStatement(&record, accountId, query)) {
+            newest[matches % query->limit] = record;
+            matches++;
+        }
+    }
+    closeTransactionLogReader(&reader);
+
+    long count = (matches < query->limit) ? matches : query->limit;
+    for (long i = 0; i < count; i++) {
+        records[i] = newest[(matches - 1 - i) % query->limit];
+    }
+    delete[] newest;
+    return count;
+}
+
+/**
+ * @brief Finds an account's records in a time range, newest first.
+ *
+ * Follows the account's chain back from its newest record, so the work is
+ * proportional to the records returned plus the account's records newer
+ * than the range, not to the size of the log. Records still in the ring
+ * are read from shared memory, older ones from the spill file. Transfers
+ * are found for both the sender and the recipient.
+ *
+ * @param shm_ptr Pointer to the shared memory segment.
+ * @param accountId The account.
+ * @param query The time range and the most records to return.
+ * @param records Receives up to query->limit records.
+ * @return Number of records returned.
+ */
+long accountHistory(SharedMemorySegment *shm_ptr, const char *accountId, const StatementQuery *query,
+                    TransactionRecord *records) {
+    if (query->limit <= 0) {
+        return 0;
+    }
+    HistoryHead *head = findHistoryHead(shm_ptr, accountId, false);
+    if (head == NULL) {
+        return __atomic_load_n(&(shm_ptr->history_full), __ATOMIC_RELAXED)
+                   ? scanAccountHistory(shm_ptr, accountId, query, records) : 0;
+    }
+
+    long count = 0;
+    int spillFd = -1;
+    long position = __atomic_load_n(&(head->last), __ATOMIC_ACQUIRE);
+    TransactionRecord record;
+    while (count < query->limit && position >= shm_ptr->base && readTransactionAt(shm_ptr, position, &record, &spillFd)) {
+        if (record.timestamp_ns < query->from_ns) {
+            break;
+        }
+        if (record.timestamp_ns <= query->to_ns) {
+            records[count++] = record;
+        }
+        position = (strncmp(record.account_id, accountId, ACCOUNT_ID_LENGTH) == 0) ? record.previous
+                                                                                    : record.recipient_previous;
+    }
+    if (spillFd != -1) {
+        close(spillFd);
+    }
+    return count;
+}
@@ -0,0 +1,446 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "worker_pool.h"
+#include <iostream>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Runs a parsed transaction against the monitor.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param transaction The transaction to run.
+ */
+void executeTransaction(Monitor *monitor, const Transaction *transaction) {
+    const char *accountId = transaction->account_id;
+
+    switch (transaction->command) {
+        case CMD_WITHDRAW:
+            withdraw(monitor, accountId, transaction->amount);
+            break;
+        case CMD_CREATE: {
+            char name[ACCOUNT_ID_LENGTH + 5];
+            snprintf(name, sizeof(name), "User_%s", accountId);
+            createAccount(monitor, accountId, name, transaction->amount);
+            break;
+        }
+        case CMD_INQUIRY:
+            inquiry(monitor, accountId);
+            break;
+        case CMD_DEPOSIT:
+            deposit(monitor, accountId, transaction->amount);
+            break;
+        case CMD_TRANSFER:
+            transfer(monitor, accountId, transaction->amount, transaction->recipient_account_id);
+            break;
+        case CMD_CLOSE:
+            closeAccount(monitor, accountId);
+            break;
+        case CMD_STATEMENT:
+            statement(monitor, accountId, &(transaction->statement));
+            break;
+        case CMD_REPORT:
+            report(monitor);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Runs a parsed transaction whose accounts' lock stripes the caller already holds.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param transaction The transaction to run.
+ */
+static void executeTransactionLocked(Monitor *monitor, const Transaction *transaction) {
+    const char *accountId = transaction->account_id;
+
+    switch (transaction->command) {
+        case CMD_WITHDRAW:
+            withdrawLocked(monitor, accountId, transaction->amount);
+            break;
+        case CMD_CREATE: {
+            char name[ACCOUNT_ID_LENGTH + 5];
+            snprintf(name, sizeof(name), "User_%s", accountId);
+            createAccountLocked(monitor, accountId, name, transaction->amount);
+            break;
+        }
+        case CMD_INQUIRY:
+            inquiryLocked(monitor, accountId);
+            break;
+        case CMD_DEPOSIT:
+            depositLocked(monitor, accountId, transaction->amount);
+            break;
+        case CMD_TRANSFER:
+            transferLocked(monitor, accountId, transaction->amount, transaction->recipient_account_id);
+            break;
+        case CMD_CLOSE:
+            closeAccountLocked(monitor, accountId);
+            break;
+        case CMD_STATEMENT:
+            statementLocked(monitor, accountId, &(transaction->statement));
+            break;
+        case CMD_REPORT:
+            // Never reaches here from a batch (see applyBatch), which would be in the monitor
+            emitEvent(monitor->output, "Error: Reports cannot run inside a batch.\n");
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Checks whether a transaction runs without admission to its account's lane.
+ *
+ * A REPORT reads every account through a snapshot, and an optimistic
+ * INQUIRY reads without waiting for writers; neither takes tickets.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param transaction The transaction.
+ * @return true if the transaction takes no lane.
+ */
+bool takesNoLane(const Monitor *monitor, const Transaction *transaction) {
+    return transaction->command == CMD_REPORT ||
+           (transaction->command == CMD_INQUIRY && monitor->optimistic_reads);
+}
+
+// A lane a batch touches, with the ticket one of its transactions holds there
+struct LaneTicket {
+    int lane;
+    long ticket;
+    const char *account;
+};
+
+/**
+ * @brief Adds a lane of one transaction to a batch's list of lanes.
+ */
+static void addLaneTicket(LaneTicket *entries, int *count, int lane, long ticket, const char *account) {
+    entries[*count].lane = lane;
+    entries[*count].ticket = ticket;
+    entries[*count].account = account;
+    (*count)++;
+}
+
+/**
+ * @brief Applies up to MAX_BATCH_SIZE transactions under one monitor entry.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param transactions The transactions, in the order they are applied.
+ * @param count Number of transactions (at most MAX_BATCH_SIZE).
+ * @param ticketsReserved Whether the transactions' tickets were reserved in input order.
+ */
+static void applyBatchChunk(Monitor *monitor, const Transaction *transactions, int count, bool ticketsReserved) {
+    LaneTicket entries[MAX_BATCH_LANES];
+    int entryCount = 0;
+    for (int i = 0; i < count; i++) {
+        const Transaction *transaction = &(transactions[i]);
+        if (takesNoLane(monitor, transaction)) {
+            continue;
+        }
+        const char *accountId = transaction->account_id;
+        const char *otherAccountId = (transaction->command == CMD_TRANSFER) ? transaction->recipient_account_id : NULL;
+        int lane = getAccountMutexIndex(monitor, accountId);
+
+        if (ticketsReserved) {
+            for (int j = 0; j < transaction->ticket.count; j++) {
+                int ticketLane = transaction->ticket.lanes[j];
+                addLaneTicket(entries, &entryCount, ticketLane, transaction->ticket.tickets[j],
+                              (ticketLane == lane) ? accountId : otherAccountId);
+            }
+        } else {
+            addLaneTicket(entries, &entryCount, lane, 0, accountId);
+            if (otherAccountId != NULL) {
+                addLaneTicket(entries, &entryCount, getAccountMutexIndex(monitor, otherAccountId), 0, otherAccountId);
+            }
+        }
+    }
+
+    // One run of tickets per distinct lane, in lane order
+    sort(entries, entries + entryCount, [](const LaneTicket &a, const LaneTicket &b) {
+        return (a.lane != b.lane) ? a.lane < b.lane : a.ticket < b.ticket;
+    });
+    BatchTicket ticket;
+    ticket.count = 0;
+    for (int i = 0; i < entryCount; i++) {
+        if (ticket.count > 0 && ticket.lanes[ticket.count - 1] == entries[i].lane) {
+            ticket.last[ticket.count - 1] = entries[i].ticket;
+            continue;
+        }
+        ticket.lanes[ticket.count] = entries[i].lane;
+        ticket.first[ticket.count] = entries[i].ticket;
+        ticket.last[ticket.count] = entries[i].ticket;
+        ticket.accounts[ticket.count] = entries[i].account;
+        ticket.count++;
+    }
+    if (!ticketsReserved) {
+        reserveBatchTicket(monitor, &ticket);
+    }
+
+    enterMonitorBatch(monitor, &ticket);
+    for (int i = 0; i < ticket.count; i++) {
+        lockAccountMutex(monitor, ticket.lanes[i], ticket.accounts[i]);
+    }
+
+    // Read the batch's uncached account files together before running it
+    const char *accountIds[2 * MAX_BATCH_SIZE];
+    int accountCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (takesNoLane(monitor, &(transactions[i]))) {
+            continue; // Its account may be changing under another process
+        }
+        accountIds[accountCount++] = transactions[i].account_id;
+        if (transactions[i].command == CMD_TRANSFER) {
+            accountIds[accountCount++] = transactions[i].recipient_account_id;
+        }
+    }
+    monitorPrefetchBalances(monitor, accountIds, accountCount);
+
+    TransactionRecord records[MAX_BATCH_SIZE];
+    monitorBeginRecordBatch(records);
+    for (int i = 0; i < count; i++) {
+        executeTransactionLocked(monitor, &(transactions[i]));
+    }
+    monitorEndRecordBatch(monitor);
+
+    for (int i = ticket.count - 1; i >= 0; i--) {
+        unlockAccountMutex(monitor, ticket.lanes[i]);
+    }
+    exitMonitorBatch(monitor, &ticket);
+}
+
+/**
+ * @brief Applies a batch of transactions, entering the monitor once per MAX_BATCH_SIZE transactions.
+ *
+ * Each lock stripe the batch touches is locked once, in ascending order, so
+ * batches cannot deadlock with each other or with single transactions. The
+ * transactions run in order with the same checks, messages and outcomes as
+ * when they run one by one, and their records are appended to the log in
+ * one step. A REPORT ends the chunk before it and runs on its own, outside
+ * the monitor. A STATEMENT starts a new chunk, so the records of the
+ * transactions before it are in the log when it reads its account's history.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param transactions The transactions, in the order they are applied.
+ * @param count Number of transactions.
+ * @param ticketsReserved Whether each transaction's tickets were reserved by
+ *        reserveMonitorTicket in input order, with the transactions being
+ *        consecutive lines of that input (as in the worker pool). Otherwise
+ *        the batch draws its own tickets.
+ */
+void applyBatch(Monitor *monitor, const Transaction *transactions, int count, bool ticketsReserved) {
+    int start = 0;
+    while (start < count) {
+        if (transactions[start].command == CMD_REPORT) {
+            executeTransaction(monitor, &(transactions[start]));
+            start++;
+            continue;
+        }
+        int size = 1;
+        while (size < MAX_BATCH_SIZE && start + size < count && transactions[start + size].command != CMD_REPORT &&
+               transactions[start + size].command != CMD_STATEMENT) {
+            size++;
+        }
+        applyBatchChunk(monitor, transactions + start, size, ticketsReserved);
+        start += size;
+    }
+}
+
+/**
+ * @brief Initializes an empty job queue with process-shared synchronization.
+ *
+ * @param queue Pointer to the queue, which must live in shared memory.
+ */
+static void initializeJobQueue(JobQueue *queue) {
+    initializeSharedMutex(&(queue->mutex));
+
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&(queue->not_empty), &condAttr);
+    pthread_cond_init(&(queue->not_full), &condAttr);
+
+    queue->head = 0;
+    queue->tail = 0;
+    queue->closed = 0;
+}
+
+/**
+ * @brief Destroys the job queue's synchronization primitives.
+ *
+ * @param queue Pointer to the queue.
+ */
+static void destroyJobQueue(JobQueue *queue) {
+    pthread_mutex_destroy(&(queue->mutex));
+    pthread_cond_destroy(&(queue->not_empty));
+    pthread_cond_destroy(&(queue->not_full));
+}
+
+/**
+ * @brief Adds a transaction to the queue, blocking while the queue is full.
+ *
+ * @param queue Pointer to the job queue.
+ * @param transaction The transaction to add.
+ */
+static void pushJob(JobQueue *queue, const Transaction *transaction) {
+    lockSharedMutex(&(queue->mutex));
+    while (queue->tail - queue->head == JOB_QUEUE_CAPACITY) {
+        waitSharedCondition(&(queue->not_full), &(queue->mutex));
+    }
+    queue->jobs[queue->tail % JOB_QUEUE_CAPACITY] = *transaction;
+    queue->tail++;
+    pthread_cond_signal(&(queue->not_empty));
+    pthread_mutex_unlock(&(queue->mutex));
+}
+
+/**
+ * @brief Marks the end of the input and wakes every idle worker.
+ *
+ * @param queue Pointer to the job queue.
+ */
+static void closeJobQueue(JobQueue *queue) {
+    lockSharedMutex(&(queue->mutex));
+    queue->closed = 1;
+    pthread_cond_broadcast(&(queue->not_empty));
+    pthread_mutex_unlock(&(queue->mutex));
+}
+
+/**
+ * @brief Takes the next transactions from the queue, blocking while it is empty.
+ *
+ * @param queue Pointer to the job queue.
+ * @param transactions Receives consecutive transactions of the input.
+ * @param max Most transactions to take; fewer are taken if fewer are queued.
+ * @return Number of transactions taken, or 0 once the queue is closed and drained.
+ */
+static int popJobs(JobQueue *queue, Transaction *transactions, int max) {
+    lockSharedMutex(&(queue->mutex));
+    while (queue->head == queue->tail && !queue->closed) {
+        waitSharedCondition(&(queue->not_empty), &(queue->mutex));
+    }
+    int count = 0;
+    while (count < max && queue->head != queue->tail) {
+        transactions[count++] = queue->jobs[queue->head % JOB_QUEUE_CAPACITY];
+        queue->head++;
+    }
+    if (count > 1) {
+        pthread_cond_broadcast(&(queue->not_full));
+    } else if (count == 1) {
+        pthread_cond_signal(&(queue->not_full));
+    }
+    pthread_mutex_unlock(&(queue->mutex));
+    return count;
+}
+
+/**
+ * @brief Main loop of a worker process: runs transactions until the queue is drained.
+ *
+ * @param monitor Pointer to the monitor structure.
+ * @param queue Pointer to the job queue.
+ * @param batchSize Most transactions taken and applied under one monitor entry.
+ * @param index The worker's number, which picks its event buffer.
+ */
+static void workerLoop(Monitor *monitor, JobQueue *queue, int batchSize, int index) {
+    // Keep each result line together with the transaction that produced it
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    selectEventProducer(index + 1);
+
+    Transaction transactions[MAX_BATCH_SIZE];
+    int count;
+    while ((count = popJobs(queue, transactions, batchSize)) > 0) {
+        if (count == 1) {
+            assignMonitorTicket(&(transactions[0].ticket));
+            executeTransaction(monitor, &(transactions[0]));
+        } else {
+            applyBatch(monitor, transactions, count, true);
+        }
+    }
+}
+
+/**
+ * @brief Runs every transaction in the input on a pool of pre-forked worker processes.
+ *
+ * The parent parses the input and feeds a shared job queue. It reserves each
+ * transaction's monitor tickets in input order, so transactions on the same
+ * account are admitted in input order while unrelated ones run in parallel.
+ * Transactions that take no lane (see takesNoLane) are not ordered: a
+ * REPORT shows the accounts as of some point while it runs, and an
+ * optimistic INQUIRY may see a balance before or after updates near it.
+ *
+ * @param monitor Pointer to the monitor structure (must be in shared memory).
+ * @param input Reader over the transaction input.
+ * @param workerCount The number of worker processes to fork.
+ * @param batchSize Most consecutive transactions a worker applies under one monitor entry.
+ * @return 0 on success, or 1 if the pool could not be set up.
+ */
+int runWorkerPool(Monitor *monitor, InputReader *input, int workerCount, int batchSize) {
+    JobQueue *queue = (JobQueue *)mmap(NULL, sizeof(JobQueue), PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (queue == MAP_FAILED) {
+        perror("Job queue mmap");
+        return 1;
+    }
+    initializeJobQueue(queue);
+
+    // Flush before forking so buffered output is not duplicated in every worker
+    cout.flush();
+    fflush(stdout);
+
+    int started = 0;
+    for (int i = 0; i < workerCount; i++) {
+        pid_t pid = fork();
+        if (pid == 0) { // Worker process
+            workerLoop(monitor, queue, batchSize, i);
+            exit(0);
+        } else if (pid > 0) {
+            started++;
+        } else {
+            perror("Fork failed");
+            break;
+        }
+    }
+
+    if (started == 0) {
+        destroyJobQueue(queue);
+        munmap(queue, sizeof(JobQueue));
+        return 1;
+    }
+
+    string_view line;
+    while (nextInputLine(input, &line)) {
+        Transaction transaction;
+        string_view command;
+        ParseStatus status = parseTransaction(line, &transaction, &command);
+        if (status != PARSE_OK) {
+            if (status != PARSE_BLANK) {
+                reportParseError(input, status, command);
+            }
+            continue;
+        }
+        transaction.ticket.count = 0;
+        if (!takesNoLane(monitor, &transaction)) {
+            const char *otherAccountId = (transaction.command == CMD_TRANSFER) ? transaction.recipient_account_id : NULL;
+            reserveMonitorTicket(monitor, transaction.account_id, otherAccountId, &(transaction.ticket));
+        }
+        pushJob(queue, &transaction);
+    }
+    closeJobQueue(queue);
+
+    for (int i = 0; i < started; i++) {
+        wait(NULL);
+    }
+
+    destroyJobQueue(queue);
+    munmap(queue, sizeof(JobQueue));
+    return 0;
+}
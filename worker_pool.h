@@ -0,0 +1,35 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+#include "monitor.h"
+#include "input_parser.h"
+
+#define JOB_QUEUE_CAPACITY 1024  // Parsed transactions buffered between the parser and the workers
+#define MAX_WORKERS MAX_QUEUED_PROCESSES  // Every worker may be waiting on the monitor at once
+
+// Queue of parsed transactions shared between the parent and the worker processes
+struct JobQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    Transaction jobs[JOB_QUEUE_CAPACITY];
+    long head;   // Next job to hand to a worker
+    long tail;   // Next free slot for the parser
+    int closed;  // Set once the parser has reached the end of the input
+};
+
+// Execution
+void executeTransaction(Monitor *monitor, const Transaction *transaction);
+bool takesNoLane(const Monitor *monitor, const Transaction *transaction);
+void applyBatch(Monitor *monitor, const Transaction *transactions, int count, bool ticketsReserved = false);
+
+// Worker pool
+int runWorkerPool(Monitor *monitor, InputReader *input, int workerCount, int batchSize = 1);
+
+#endif // WORKER_POOL_H
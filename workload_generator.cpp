@@ -0,0 +1,215 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "workload_generator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+// Default weights: CREATE, DEPOSIT, WITHDRAW, INQUIRY, TRANSFER, CLOSE
+static const int DEFAULT_WORKLOAD_MIX[TXN_TYPE_COUNT] = {2, 30, 20, 30, 16, 2};
+
+/**
+ * @brief Fills in the default workload parameters.
+ *
+ * @param config Receives the defaults.
+ */
+void defaultWorkloadConfig(WorkloadConfig *config) {
+    config->accounts = DEFAULT_WORKLOAD_ACCOUNTS;
+    config->transactions = DEFAULT_WORKLOAD_TRANSACTIONS;
+    memcpy(config->mix, DEFAULT_WORKLOAD_MIX, sizeof(config->mix));
+    config->zipf = DEFAULT_WORKLOAD_ZIPF;
+    config->fail_percent = 0;
+    config->seed = DEFAULT_WORKLOAD_SEED;
+}
+
+/**
+ * @brief Parses an operation mix such as "2,30,20,30,16,2".
+ *
+ * @param text Weights for CREATE, DEPOSIT, WITHDRAW, INQUIRY, TRANSFER and CLOSE, comma-separated.
+ * @param config Receives the weights.
+ * @return false if the text does not hold six non-negative weights with a positive sum.
+ */
+bool parseWorkloadMix(const char *text, WorkloadConfig *config) {
+    int mix[TXN_TYPE_COUNT];
+    int total = 0;
+    const char *position = text;
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        char *end;
+        long weight = strtol(position, &end, 10);
+        if (end == position || weight < 0 || weight > 1000000) {
+            return false;
+        }
+        if (*end != ((type + 1 < TXN_TYPE_COUNT) ? ',' : '\0')) {
+            return false;
+        }
+        mix[type] = (int)weight;
+        total += mix[type];
+        position = end + 1;
+    }
+    if (total == 0) {
+        return false;
+    }
+    memcpy(config->mix, mix, sizeof(mix));
+    return true;
+}
+
+/**
+ * @brief Precomputes the cumulative distribution of a Zipf distribution.
+ *
+ * @param sampler Receives the distribution.
+ * @param n Number of ranks (at least 1).
+ * @param s Exponent; 0 gives a uniform distribution.
+ */
+void initializeZipfSampler(ZipfSampler *sampler, long n, double s) {
+    sampler->cdf.resize(n);
+    double sum = 0.0;
+    for (long rank = 0; rank < n; rank++) {
+        sum += 1.0 / pow((double)(rank + 1), s);
+        sampler->cdf[rank] = sum;
+    }
+    for (long rank = 0; rank < n; rank++) {
+        sampler->cdf[rank] /= sum;
+    }
+}
+
+/**
+ * @brief Draws one rank from a Zipf distribution.
+ *
+ * @param sampler The distribution.
+ * @param seed State of the random number generator.
+ * @return A rank between 0 (most likely) and n - 1.
+ */
+long zipfSample(const ZipfSampler *sampler, unsigned int *seed) {
+    double u = (rand_r(seed) + 0.5) / ((double)RAND_MAX + 1.0);
+    long rank = lower_bound(sampler->cdf.begin(), sampler->cdf.end(), u) - sampler->cdf.begin();
+    return (rank < (long)sampler->cdf.size()) ? rank : (long)sampler->cdf.size() - 1;
+}
+
+/**
+ * @brief Picks a transaction type according to the mix weights.
+ */
+static TransactionType pickTransactionType(const WorkloadConfig *config, int totalWeight, unsigned int *seed) {
+    int pick = rand_r(seed) % totalWeight;
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        if (pick < config->mix[type]) {
+            return (TransactionType)type;
+        }
+        pick -= config->mix[type];
+    }
+    return TXN_INQUIRY;
+}
+
+/**
+ * @brief Writes a random amount between 1.00 and 50.00.
+ */
+static void writeAmount(FILE *file, unsigned int *seed) {
+    long cents = 100 + rand_r(seed) % 4901;
+    fprintf(file, "%ld.%02ld", cents / 100, cents % 100);
+}
+
+/**
+ * @brief Writes a reproducible transaction file.
+ *
+ * The file starts with one Create line per account (Acct0, Acct1, ...), so
+ * every later line refers to an existing account. Each following line picks
+ * its type from the mix and its account from the Zipf distribution, with
+ * Acct0 the hottest. CREATE and CLOSE work on separate short-lived accounts
+ * (Temp0, Temp1, ...) that are created empty and closed oldest first, so
+ * both succeed; a CLOSE with no open Temp account becomes a CREATE.
+ *
+ * fail_percent of the lines are generated to fail: a duplicate CREATE, a
+ * DEPOSIT or INQUIRY on a missing account, an overdrawing WITHDRAW, a
+ * TRANSFER to a missing account, or a CLOSE of an account with a balance.
+ * Others can still fail when concurrent workers reorder them.
+ *
+ * @param config The workload parameters (accounts must be at least 1).
+ * @param path Path of the output file.
+ * @return Number of lines written, or -1 if the file could not be written.
+ */
+long generateWorkload(const WorkloadConfig *config, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return -1;
+    }
+
+    int totalWeight = 0;
+    for (int type = 0; type < TXN_TYPE_COUNT; type++) {
+        totalWeight += config->mix[type];
+    }
+    ZipfSampler sampler;
+    initializeZipfSampler(&sampler, config->accounts, config->zipf);
+    unsigned int seed = config->seed;
+
+    for (long a = 0; a < config->accounts; a++) {
+        fprintf(file, "Acct%ld Create %d\n", a, WORKLOAD_OPENING_BALANCE);
+    }
+
+    vector<long> openTemps;
+    size_t oldestTemp = 0;
+    long nextTemp = 0;
+    for (long t = 0; t < config->transactions; t++) {
+        TransactionType type = pickTransactionType(config, totalWeight, &seed);
+        long account = zipfSample(&sampler, &seed);
+        bool fail = (rand_r(&seed) % 100) < config->fail_percent;
+        if (type == TXN_CLOSE && !fail && oldestTemp == openTemps.size()) {
+            type = TXN_CREATE;
+        }
+
+        switch (type) {
+            case TXN_CREATE:
+                if (fail) {
+                    fprintf(file, "Acct%ld Create 100\n", account);
+                } else {
+                    fprintf(file, "Temp%ld Create 0\n", nextTemp);
+                    openTemps.push_back(nextTemp++);
+                }
+                break;
+            case TXN_DEPOSIT:
+                fprintf(file, "%s%ld Deposit ", fail ? "Missing" : "Acct", account);
+                writeAmount(file, &seed);
+                fputc('\n', file);
+                break;
+            case TXN_WITHDRAW:
+                if (fail) {
+                    fprintf(file, "Acct%ld Withdraw 1000000000\n", account);
+                } else {
+                    fprintf(file, "Acct%ld Withdraw ", account);
+                    writeAmount(file, &seed);
+                    fputc('\n', file);
+                }
+                break;
+            case TXN_INQUIRY:
+                fprintf(file, "%s%ld Inquiry\n", fail ? "Missing" : "Acct", account);
+                break;
+            case TXN_TRANSFER: {
+                long recipient = zipfSample(&sampler, &seed);
+                if (recipient == account && config->accounts > 1) {
+                    recipient = (account + 1) % config->accounts;
+                }
+                fprintf(file, "Acct%ld Transfer ", account);
+                writeAmount(file, &seed);
+                fprintf(file, " %s%ld\n", fail ? "Missing" : "Acct", recipient);
+                break;
+            }
+            default:
+                if (fail) {
+                    fprintf(file, "Acct%ld Close\n", account);
+                } else {
+                    fprintf(file, "Temp%ld Close\n", openTemps[oldestTemp++]);
+                }
+                break;
+        }
+    }
+
+    if (fclose(file) != 0) {
+        return -1;
+    }
+    return config->accounts + config->transactions;
+}
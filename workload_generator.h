@@ -0,0 +1,39 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <vector>
+#include "sharedmemory.h"
+
+#define DEFAULT_WORKLOAD_ACCOUNTS 1000
+#define DEFAULT_WORKLOAD_TRANSACTIONS 100000
+#define DEFAULT_WORKLOAD_ZIPF 0.99      // Zipf exponent of the account skew (0 = uniform)
+#define DEFAULT_WORKLOAD_SEED 42
+#define WORKLOAD_OPENING_BALANCE 1000000 // Whole units each account is created with
+
+// Parameters of a generated transaction file
+struct WorkloadConfig {
+    long accounts;                 // Accounts created before the measured transactions
+    long transactions;             // Transactions after the setup lines
+    int mix[TXN_TYPE_COUNT];       // Relative weight of each transaction type
+    double zipf;                   // Skew of the account chosen for each transaction
+    int fail_percent;              // Transactions that are generated to fail
+    unsigned int seed;             // Same seed and parameters give the same file
+};
+
+// Draws account ranks 0..n-1 with probability proportional to 1 / (rank + 1)^s
+struct ZipfSampler {
+    std::vector<double> cdf;
+};
+
+void defaultWorkloadConfig(WorkloadConfig *config);
+bool parseWorkloadMix(const char *text, WorkloadConfig *config);
+void initializeZipfSampler(ZipfSampler *sampler, long n, double s);
+long zipfSample(const ZipfSampler *sampler, unsigned int *seed);
+long generateWorkload(const WorkloadConfig *config, const char *path);
+
+#endif // WORKLOAD_GENERATOR_H
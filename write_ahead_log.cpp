@@ -0,0 +1,339 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#include "write_ahead_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+
+/**
+ * @brief Records copied out of the shared buffer by the process leading a group flush.
+ */
+static WalRecord flush_group[WAL_BUFFER_RECORDS];
+
+/**
+ * @brief Computes a record's checksum (32-bit FNV-1a over the record with its checksum field zeroed).
+ */
+static uint32_t walChecksum(const WalRecord *record) {
+    WalRecord copy = *record;
+    copy.checksum = 0;
+
+    const unsigned char *bytes = (const unsigned char *)&copy;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(copy); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Initializes the shared state of a write-ahead log and opens its file for appending.
+ *
+ * The file is opened before the workers are forked so every process shares
+ * one append-mode file description.
+ *
+ * @param wal Pointer to the log state, which must live in shared memory.
+ * @param path Path of the log file.
+ * @param batchSize A group flush starts as soon as this many records are buffered.
+ * @param maxLatencyUs How long a flush may wait for a smaller group to fill (0 never waits).
+ * @param checkpointInterval Records between checkpoints.
+ * @return 0 on success, or -1 if the log file could not be opened.
+ */
+int openWriteAheadLog(WriteAheadLog *wal, const char *path, int batchSize, long maxLatencyUs, long checkpointInterval) {
+    wal->fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0666);
+    if (wal->fd == -1) {
+        printf("Error opening write-ahead log: %s\n", path);
+        return -1;
+    }
+
+    initializeSharedMutex(&(wal->mutex));
+
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&(wal->batch_ready), &condAttr);
+    pthread_cond_init(&(wal->flushed), &condAttr);
+
+    snprintf(wal->path, sizeof(wal->path), "%s", path);
+    wal->batch_size = (batchSize < 1) ? 1 : (batchSize > WAL_BUFFER_RECORDS ? WAL_BUFFER_RECORDS : batchSize);
+    wal->max_latency_us = maxLatencyUs;
+    wal->checkpoint_interval = checkpointInterval;
+    wal->async_io = false;
+    wal->next_lsn = 1;
+    wal->flushed_lsn = 0;
+    wal->flushing = 0;
+    wal->applied_lsn = 0;
+    memset(wal->applied, 0, sizeof(wal->applied));
+    wal->checkpoint_lsn = 0;
+    wal->checkpoint_target = 0;
+    wal->checkpointing = 0;
+    wal->since_checkpoint = 0;
+    wal->flushes = 0;
+    wal->records = 0;
+    wal->buffered = 0;
+    return 0;
+}
+
+/**
+ * @brief Closes the log file and destroys the log's synchronization primitives.
+ *
+ * @param wal Pointer to the log state.
+ */
+void closeWriteAheadLog(WriteAheadLog *wal) {
+    close(wal->fd);
+    pthread_mutex_destroy(&(wal->mutex));
+    pthread_cond_destroy(&(wal->batch_ready));
+    pthread_cond_destroy(&(wal->flushed));
+}
+
+/**
+ * @brief Adds a redo record to the shared buffer.
+ *
+ * The record is not durable until walCommit returns for its LSN, and it
+ * stays in the log file until walApplied has been called for it and for
+ * every record before it. Appends wait while WAL_APPLY_WINDOW records are
+ * past the oldest one not yet applied.
+ *
+ * @param wal Pointer to the log state.
+ * @param record The record to append; its lsn and checksum are filled in.
+ * @return The record's LSN.
+ */
+uint64_t walAppend(WriteAheadLog *wal, WalRecord *record) {
+    lockSharedMutex(&(wal->mutex));
+    while (wal->buffered == WAL_BUFFER_RECORDS || wal->next_lsn - wal->applied_lsn > WAL_APPLY_WINDOW) {
+        waitSharedCondition(&(wal->flushed), &(wal->mutex));
+    }
+
+    record->lsn = wal->next_lsn++;
+    record->checksum = walChecksum(record);
+    wal->buffer[wal->buffered++] = *record;
+    wal->since_checkpoint++;
+    wal->records++;
+
+    if (wal->buffered >= wal->batch_size) {
+        pthread_cond_signal(&(wal->batch_ready));
+    }
+    pthread_mutex_unlock(&(wal->mutex));
+    return record->lsn;
+}
+
+/**
+ * @brief Blocks until the record with the given LSN is on disk (group commit).
+ *
+ * The first caller to find no flush in progress becomes the leader: it
+ * optionally waits up to max_latency_us for batch_size records, takes every
+ * buffered record, writes them with one write and one fdatasync, and wakes
+ * the others. Records appended while a flush is running form the next group.
+ *
+ * @param wal Pointer to the log state.
+ * @param lsn LSN returned by walAppend.
+ */
+void walCommit(WriteAheadLog *wal, uint64_t lsn) {
+    lockSharedMutex(&(wal->mutex));
+    while (wal->flushed_lsn < lsn) {
+        if (wal->flushing) {
+            waitSharedCondition(&(wal->flushed), &(wal->mutex));
+            continue;
+        }
+        wal->flushing = 1;
+
+        if (wal->max_latency_us > 0 && wal->buffered < wal->batch_size) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += (wal->max_latency_us % 1000000) * 1000;
+            deadline.tv_sec += wal->max_latency_us / 1000000 + deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            while (wal->buffered < wal->batch_size) {
+                if (waitSharedCondition(&(wal->batch_ready), &(wal->mutex), &deadline) == ETIMEDOUT) {
+                    break;
+                }
+            }
+        }
+
+        int count = wal->buffered;
+        uint64_t last = wal->next_lsn - 1;
+        memcpy(flush_group, wal->buffer, count * sizeof(WalRecord));
+        wal->buffered = 0;
+        pthread_cond_broadcast(&(wal->flushed)); // Buffer space is free again
+        pthread_mutex_unlock(&(wal->mutex));
+
+        int written = wal->async_io ? asyncWriteAndSync(wal->fd, (const char *)flush_group, count * sizeof(WalRecord)) : -2;
+        if (written == -2) {
+            written = (writeFully(wal->fd, (const char *)flush_group, count * sizeof(WalRecord)) == -1 ||
+                       fdatasync(wal->fd) == -1) ? -1 : 0;
+        }
+        if (written != 0) {
+            printf("Error writing write-ahead log: %s\n", wal->path);
+        }
+
+        lockSharedMutex(&(wal->mutex));
+        wal->flushed_lsn = last;
+        wal->flushing = 0;
+        wal->flushes++;
+        pthread_cond_broadcast(&(wal->flushed));
+    }
+    pthread_mutex_unlock(&(wal->mutex));
+}
+
+/**
+ * @brief Marks one committed record as applied to the account store.
+ *
+ * Records are applied out of order by concurrent processes; applied_lsn
+ * only moves past a record once every record before it is applied too.
+ *
+ * @param wal Pointer to the log state.
+ * @param lsn LSN returned by walAppend.
+ * @return true if a checkpoint is due.
+ */
+bool walApplied(WriteAheadLog *wal, uint64_t lsn) {
+    lockSharedMutex(&(wal->mutex));
+    bool windowFull = (wal->next_lsn - wal->applied_lsn > WAL_APPLY_WINDOW);
+    wal->applied[lsn % WAL_APPLY_WINDOW] = 1;
+    while (wal->applied[(wal->applied_lsn + 1) % WAL_APPLY_WINDOW]) {
+        wal->applied_lsn++;
+        wal->applied[wal->applied_lsn % WAL_APPLY_WINDOW] = 0;
+    }
+    if (windowFull) {
+        pthread_cond_broadcast(&(wal->flushed)); // Appends waiting for the window may go on
+    }
+    bool due = (wal->since_checkpoint >= wal->checkpoint_interval && !wal->checkpointing &&
+                wal->applied_lsn > wal->checkpoint_lsn);
+    pthread_mutex_unlock(&(wal->mutex));
+    return due;
+}
+
+/**
+ * @brief Starts a checkpoint of every record applied so far.
+ *
+ * Records keep being appended and applied meanwhile: the checkpoint only
+ * covers those up to the current applied_lsn, which the caller makes
+ * durable in the account store before calling walEndCheckpoint. Only one
+ * checkpoint runs at a time.
+ *
+ * @param wal Pointer to the log state.
+ * @param force Checkpoint even if fewer than checkpoint_interval records were logged.
+ * @return true if the checkpoint was started.
+ */
+bool walBeginCheckpoint(WriteAheadLog *wal, bool force) {
+    lockSharedMutex(&(wal->mutex));
+    if ((!force && wal->since_checkpoint < wal->checkpoint_interval) || wal->checkpointing ||
+        wal->applied_lsn == wal->checkpoint_lsn) {
+        pthread_mutex_unlock(&(wal->mutex));
+        return false;
+    }
+    wal->checkpointing = 1;
+    wal->checkpoint_target = wal->applied_lsn;
+    wal->since_checkpoint = (long)(wal->next_lsn - 1 - wal->applied_lsn);
+    pthread_mutex_unlock(&(wal->mutex));
+    return true;
+}
+
+/**
+ * @brief Builds the path of the file that holds a log's surviving records while it is compacted.
+ *
+ * @param path Path of the log file.
+ * @param buffer Receives the path.
+ * @param size Size of buffer.
+ */
+void walCompactionPath(const char *path, char *buffer, size_t size) {
+    snprintf(buffer, size, "%s.compact", path);
+}
+
+/**
+ * @brief Makes a newly created file's directory entry durable.
+ *
+ * @param path Path of the file.
+ */
+static void syncParentDirectory(const char *path) {
+    char directory[WAL_PATH_LENGTH + 16];
+    snprintf(directory, sizeof(directory), "%s", path);
+    char *slash = strrchr(directory, '/');
+    if (slash == NULL) {
+        snprintf(directory, sizeof(directory), ".");
+    } else if (slash == directory) {
+        slash[1] = '\0';
+    } else {
+        *slash = '\0';
+    }
+    int fd = open(directory, O_RDONLY);
+    if (fd != -1) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+/**
+ * @brief Finishes a checkpoint: the account store is durable up to its target, so those records leave the log.
+ *
+ * The log file holds the records after checkpoint_lsn in LSN order, so the
+ * checkpointed ones are a prefix. The records after it are first saved to
+ * the compaction file, then the log is rewritten with only them; recovery
+ * replays the compaction file after the log, so a crash at any point loses
+ * no record. Appends wait meanwhile.
+ *
+ * @param wal Pointer to the log state (walBeginCheckpoint returned true).
+ */
+void walEndCheckpoint(WriteAheadLog *wal) {
+    lockSharedMutex(&(wal->mutex));
+    while (wal->flushing) {
+        waitSharedCondition(&(wal->flushed), &(wal->mutex));
+    }
+
+    off_t size = lseek(wal->fd, 0, SEEK_END);
+    off_t keepFrom = (off_t)((wal->checkpoint_target - wal->checkpoint_lsn) * sizeof(WalRecord));
+    size_t keep = (size > keepFrom) ? (size_t)(size - keepFrom) : 0;
+    char *records = NULL;
+    char compactionPath[WAL_PATH_LENGTH + 16];
+    walCompactionPath(wal->path, compactionPath, sizeof(compactionPath));
+    bool failed = false;
+
+    if (keep > 0) {
+        records = new char[keep];
+        int compactionFd = open(compactionPath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        failed = (pread(wal->fd, records, keep, keepFrom) != (ssize_t)keep || compactionFd == -1 ||
+                  writeFully(compactionFd, records, keep) == -1 || fdatasync(compactionFd) == -1);
+        if (compactionFd != -1) {
+            close(compactionFd);
+        }
+        syncParentDirectory(compactionPath);
+    }
+    if (!failed) {
+        failed = (ftruncate(wal->fd, 0) == -1 || (keep > 0 && writeFully(wal->fd, records, keep) == -1) ||
+                  fdatasync(wal->fd) == -1);
+    }
+    if (failed) {
+        printf("Error truncating write-ahead log: %s\n", wal->path);
+    } else {
+        if (keep > 0) {
+            unlink(compactionPath);
+        }
+        wal->checkpoint_lsn = wal->checkpoint_target;
+    }
+    delete[] records;
+
+    wal->checkpointing = 0;
+    pthread_mutex_unlock(&(wal->mutex));
+}
+
+/**
+ * @brief Reads the next record from a log file during recovery.
+ *
+ * @param fd Log file opened for reading.
+ * @param record Receives the record.
+ * @return true if a complete record with a valid checksum was read, false at
+ *         the end of the log or at a record torn by a crash.
+ */
+bool walReadRecord(int fd, WalRecord *record) {
+    ssize_t bytesRead = read(fd, record, sizeof(*record));
+    if (bytesRead != (ssize_t)sizeof(*record)) {
+        return false;
+    }
+    return record->count >= 1 && record->count <= 2 && record->checksum == walChecksum(record);
+}
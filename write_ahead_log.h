@@ -0,0 +1,80 @@
+/**
+ * Group I
+ * 10/17/2026
+ */
+
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include "sharedmemory.h"
+#include "account_store.h"
+#include "async_io.h"
+
+#define WAL_BUFFER_RECORDS 1024          // Records buffered in shared memory between group flushes
+#define DEFAULT_WAL_BATCH_SIZE 64        // Flush as soon as this many records are waiting
+#define DEFAULT_WAL_MAX_LATENCY_US 0     // How long a flush may wait for the batch to fill
+#define DEFAULT_WAL_CHECKPOINT 10000     // Records between checkpoints
+#define WAL_PATH_LENGTH 256
+#define WAL_APPLY_WINDOW 4096            // Records that may be logged past the oldest one not yet applied
+
+// Redo operations; each entry holds the account's state after the transaction
+enum WalOperation : uint32_t {
+    WAL_SET_BALANCE,  // Account balance becomes balance_cents
+    WAL_CREATE,       // Account is created with balance_cents
+    WAL_DELETE        // Account is removed
+};
+
+struct WalEntry {
+    char account_id[ACCOUNT_ID_LENGTH];
+    WalOperation operation;
+    Money balance_cents;
+};
+
+// One redo record per transaction (a transfer carries both accounts)
+struct WalRecord {
+    uint64_t lsn;        // Log sequence number, assigned by walAppend
+    uint32_t count;      // Entries in use (1 or 2)
+    uint32_t checksum;   // Detects records torn by a crash
+    WalEntry entries[2];
+    char name[ACCOUNT_NAME_LENGTH]; // Holder name for WAL_CREATE
+};
+
+// Shared state of the write-ahead log (must live in memory shared by every process)
+struct WriteAheadLog {
+    pthread_mutex_t mutex;        // Guards everything below
+    pthread_cond_t batch_ready;   // Signalled when the buffer reaches batch_size
+    pthread_cond_t flushed;       // Broadcast after each group flush (and when buffer space frees up)
+    int fd;                       // Log file, opened before the workers are forked
+    bool async_io;                // Group flushes submit write + fdatasync to io_uring as one chain
+    char path[WAL_PATH_LENGTH];
+    int batch_size;
+    long max_latency_us;
+    long checkpoint_interval;
+    uint64_t next_lsn;            // LSN of the next appended record
+    uint64_t flushed_lsn;         // Every record up to this LSN is on disk
+    int flushing;                 // Set while a leader is writing a group
+    uint64_t applied_lsn;         // Every record up to this LSN has been applied to the account store
+    uint8_t applied[WAL_APPLY_WINDOW]; // Records past applied_lsn that are applied, by LSN modulo the window
+    uint64_t checkpoint_lsn;      // Records up to this LSN have been dropped from the log file
+    uint64_t checkpoint_target;   // Records up to this LSN are dropped by the running checkpoint
+    int checkpointing;            // Set while a checkpoint syncs the account store
+    long since_checkpoint;        // Records appended since the last checkpoint
+    long flushes;                 // Group flushes performed
+    long records;                 // Records appended
+    int buffered;
+    WalRecord buffer[WAL_BUFFER_RECORDS];
+};
+
+int openWriteAheadLog(WriteAheadLog *wal, const char *path, int batchSize, long maxLatencyUs, long checkpointInterval);
+void closeWriteAheadLog(WriteAheadLog *wal);
+uint64_t walAppend(WriteAheadLog *wal, WalRecord *record);
+void walCommit(WriteAheadLog *wal, uint64_t lsn);
+bool walApplied(WriteAheadLog *wal, uint64_t lsn);
+bool walBeginCheckpoint(WriteAheadLog *wal, bool force);
+void walEndCheckpoint(WriteAheadLog *wal);
+bool walReadRecord(int fd, WalRecord *record);
+void walCompactionPath(const char *path, char *buffer, size_t size);
+
+#endif // WRITE_AHEAD_LOG_H